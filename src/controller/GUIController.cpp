@@ -299,16 +299,16 @@ void GUIController::generateProbFunc() {
         try {
             if (dialogPlaceProb.checkConstRange()) {
                 model::Facade *f;
-                f = new model::Facade(modelCurFile,dialogPlaceProb.getPlaceName(),this);
-                if (f->showProbFunc(dialogPlaceProb.getConstStart(),dialogPlaceProb.getConstEnd(),dialogPlaceProb.getConstStep(),dialogPlaceProb.getTimeStep(),dialogPlaceProb.getMaxTime())) {
+                f = new model::Facade(modelCurFile, dialogPlaceProb.getPlaceName(), this, true);
+                if (f->showProbFunc(dialogPlaceProb.getConstStart(),dialogPlaceProb.getConstEnd(),dialogPlaceProb.getConstStep(),dialogPlaceProb.getTimeStep(),dialogPlaceProb.getMaxTime(),(model::TimeSampling)dialogPlaceProb.getTimeSampling())) {
                     this->addSuccess("Displaying Probability Distribution Pr-t plot...");
                 } else {
                     this->addError("The Probability Distribution Pr-t plot could not be displayed.");
                 }
             } if (dialogPlaceProb.checkSpecConst()) {
                 model::Facade *f;
-                f = new model::Facade(modelCurFile,dialogPlaceProb.getPlaceName(),this);
-                if (f->showProbFunc(dialogPlaceProb.getConst(),dialogPlaceProb.getTimeStep(),dialogPlaceProb.getMaxTime())) {
+                f = new model::Facade(modelCurFile, dialogPlaceProb.getPlaceName(), this, true);
+                if (f->showProbFunc(dialogPlaceProb.getConst(),dialogPlaceProb.getTimeStep(),dialogPlaceProb.getMaxTime(),(model::TimeSampling)dialogPlaceProb.getTimeSampling())) {
                     this->addSuccess("Displaying Probability Distribution Pr-t plot...");
                 } else {
                     this->addError("The Probability Distribution Pr-t plot could not be displayed.");
@@ -335,10 +335,27 @@ void GUIController::generateDESProbFunc() {
     } else if(dialogPlaceProb.exec() == QDialog::Accepted )
     {
         try {
+            model::SimulationOptions simulationOptions;
+            quint64 seed;
+            if (dialogPlaceProb.getDESSeed(seed)) {
+                simulationOptions.randomSeed = false;
+                simulationOptions.seed = seed;
+            }
+            simulationOptions.halfWidth = dialogPlaceProb.getDESHalfWidth();
+            simulationOptions.confidenceLevel = dialogPlaceProb.getDESConfidenceLevel();
+            simulationOptions.antithetic = dialogPlaceProb.getDESAntithetic();
+            simulationOptions.commonRandomNumbers = dialogPlaceProb.getDESCommonRandomNumbers();
+            simulationOptions.importanceExponent = dialogPlaceProb.getDESImportanceExponent();
+            simulationOptions.quasiMonteCarlo = dialogPlaceProb.getDESQuasiMonteCarlo();
+            simulationOptions.splittingLevels = dialogPlaceProb.getDESSplittingLevels();
+            simulationOptions.splittingEffort = dialogPlaceProb.getDESSplittingEffort();
+            simulationOptions.conditionalMonteCarlo = dialogPlaceProb.getDESConditional();
+
             if (dialogPlaceProb.checkConstRange()) {
                 model::Facade *f;
                 f = new model::Facade(modelCurFile, dialogPlaceProb.getPlaceName(), this, true);
-                if (f->showDESProbFunc(dialogPlaceProb.getConstStart(),dialogPlaceProb.getConstEnd(),dialogPlaceProb.getConstStep(),dialogPlaceProb.getDESRuns(),dialogPlaceProb.getTimeStep(),dialogPlaceProb.getMaxTime())) {
+                f->setSimulationOptions(simulationOptions);
+                if (f->showDESProbFunc(dialogPlaceProb.getConstStart(),dialogPlaceProb.getConstEnd(),dialogPlaceProb.getConstStep(),dialogPlaceProb.getDESRuns(),dialogPlaceProb.getTimeStep(),dialogPlaceProb.getMaxTime(),(model::TimeSampling)dialogPlaceProb.getTimeSampling())) {
                     this->addSuccess("Displaying DES Probability Distribution Pr-t plot...");
                 } else {
                     this->addError("The DES Probability Distribution Pr-t plot could not be displayed.");
@@ -347,7 +364,8 @@ void GUIController::generateDESProbFunc() {
             } if (dialogPlaceProb.checkSpecConst()) {
                 model::Facade *f;
                 f = new model::Facade(modelCurFile, dialogPlaceProb.getPlaceName(), this, true);
-                if (f->showDESProbFunc(dialogPlaceProb.getConst(), dialogPlaceProb.getDESRuns(), dialogPlaceProb.getTimeStep(), dialogPlaceProb.getMaxTime())) {
+                f->setSimulationOptions(simulationOptions);
+                if (f->showDESProbFunc(dialogPlaceProb.getConst(), dialogPlaceProb.getDESRuns(), dialogPlaceProb.getTimeStep(), dialogPlaceProb.getMaxTime(), (model::TimeSampling)dialogPlaceProb.getTimeSampling())) {
                     this->addSuccess("Displaying DES Probability Distribution Pr-t plot...");
                 } else {
                     this->addError("The DES Probability Distribution Pr-t plot could not be displayed.");
@@ -11,6 +11,25 @@ PlaceProbDialogController::PlaceProbDialogController(QWidget *parent, QString fi
     // DES specific tweaks
     ui->spinBoxDESRuns->setEnabled(isDES);
     ui->labelDESRuns->setEnabled(isDES);
+    ui->lineEditDESSeed->setEnabled(isDES);
+    ui->labelDESSeed->setEnabled(isDES);
+    ui->lineEditDESHalfWidth->setEnabled(isDES);
+    ui->labelDESHalfWidth->setEnabled(isDES);
+    ui->lineEditDESConfidence->setEnabled(isDES);
+    ui->labelDESConfidence->setEnabled(isDES);
+    ui->labelDESVarianceReduction->setEnabled(isDES);
+    ui->checkBoxDESAntithetic->setEnabled(isDES);
+    ui->checkBoxDESCommonRandomNumbers->setEnabled(isDES);
+    ui->lineEditDESImportanceExponent->setEnabled(isDES);
+    ui->labelDESImportanceExponent->setEnabled(isDES);
+    ui->checkBoxDESQuasiMonteCarlo->setEnabled(isDES);
+    ui->lineEditDESSplittingLevels->setEnabled(isDES);
+    ui->labelDESSplittingLevels->setEnabled(isDES);
+    ui->lineEditDESSplittingEffort->setEnabled(isDES);
+    ui->labelDESSplittingEffort->setEnabled(isDES);
+    ui->checkBoxDESConditional->setEnabled(isDES);
+    // A simulation has no exact piecewise curve
+    if(isDES) ui->comboBoxTimeSampling->removeItem(2);
     this->setWindowTitle(isDES ? "Cont. Place Prob. Plots (DES)" : "Cont. Place Prob. Plots");
     if(isDES) ui->radioSpecConst->setChecked(true);
 }
@@ -36,6 +55,54 @@ int PlaceProbDialogController::getDESRuns() {
     return ui->spinBoxDESRuns->value();
 }
 
+// Returns false if no valid seed is entered, i.e. the seed should be random.
+bool PlaceProbDialogController::getDESSeed(quint64 &seed) {
+    bool ok;
+    seed = ui->lineEditDESSeed->text().trimmed().toULongLong(&ok);
+    return ok;
+}
+
+// Returns 0 if no half-width is entered, i.e. a fixed number of runs is used.
+double PlaceProbDialogController::getDESHalfWidth() {
+    return ui->lineEditDESHalfWidth->text().toDouble();
+}
+
+double PlaceProbDialogController::getDESConfidenceLevel() {
+    return ui->lineEditDESConfidence->text().toDouble();
+}
+
+bool PlaceProbDialogController::getDESAntithetic() {
+    return ui->checkBoxDESAntithetic->isChecked();
+}
+
+bool PlaceProbDialogController::getDESCommonRandomNumbers() {
+    return ui->checkBoxDESCommonRandomNumbers->isChecked();
+}
+
+double PlaceProbDialogController::getDESImportanceExponent() {
+    return ui->lineEditDESImportanceExponent->text().toDouble();
+}
+
+bool PlaceProbDialogController::getDESQuasiMonteCarlo() {
+    return ui->checkBoxDESQuasiMonteCarlo->isChecked();
+}
+
+int PlaceProbDialogController::getDESSplittingLevels() {
+    return ui->lineEditDESSplittingLevels->text().toInt();
+}
+
+int PlaceProbDialogController::getDESSplittingEffort() {
+    return ui->lineEditDESSplittingEffort->text().toInt();
+}
+
+bool PlaceProbDialogController::getDESConditional() {
+    return ui->checkBoxDESConditional->isChecked();
+}
+
+int PlaceProbDialogController::getTimeSampling() {
+    return ui->comboBoxTimeSampling->currentIndex();
+}
+
 double PlaceProbDialogController::getConstStep() {
     return ui->lineEditConstStep->text().toDouble();
 }
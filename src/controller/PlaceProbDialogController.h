@@ -18,6 +18,17 @@ public:
     double getMaxTime();
     double getTimeStep();
     int getDESRuns();
+    bool getDESSeed(quint64 &seed);
+    double getDESHalfWidth();
+    double getDESConfidenceLevel();
+    bool getDESAntithetic();
+    bool getDESCommonRandomNumbers();
+    double getDESImportanceExponent();
+    bool getDESQuasiMonteCarlo();
+    int getDESSplittingLevels();
+    int getDESSplittingEffort();
+    bool getDESConditional();
+    int getTimeSampling();
     double getConstStep();
     double getConstStart();
     double getConstEnd();
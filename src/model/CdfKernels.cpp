@@ -0,0 +1,232 @@
+/**
+ * @file CdfKernels.cpp
+ * @brief The gamma cdf and quantile, the normal quantile and compensated summation used by the distributions in GeneralDistribution.h.
+ */
+
+#include "CdfKernels.h"
+
+#include <math.h>
+#include <float.h>
+#include <algorithm>
+
+namespace model {
+
+GammaCdf::GammaCdf() : shape(1), invScale(1), logGammaShape(0), erlangShape(1) {
+}
+
+bool GammaCdf::setParameters(double shape, double scale) {
+    if (!(shape > 0) || !(scale > 0) || shape == INFINITY || scale == INFINITY)
+        return false;
+
+    this->shape = shape;
+    this->invScale = 1 / scale;
+    this->logGammaShape = lgamma(shape);
+    this->erlangShape = (shape == floor(shape) && shape <= MAX_ERLANG_SHAPE) ? (int)shape : 0;
+    return true;
+}
+
+double GammaCdf::evaluate(double s) const {
+    if (!(s > 0))
+        return 0;
+    if (s == INFINITY)
+        return 1;
+
+    return lower(s * invScale);
+}
+
+void GammaCdf::evaluate(const double *s, double *res, int n) const {
+    for (int i = 0; i < n; i++)
+        res[i] = evaluate(s[i]);
+}
+
+/*
+ * Halley's method on P(a,x) - p, with the initial guess and the safeguard of Numerical Recipes 6.2.1: for a > 1 the
+ * Wilson-Hilferty approximation, otherwise the inverse of the two leading terms of the tails. Since the derivative of
+ * the density is known in closed form, Halley's step costs no more evaluations of P than Newton's.
+ */
+double GammaCdf::quantile(double p) const {
+    if (!(p > 0))
+        return 0;
+    if (p >= 1)
+        return INFINITY;
+
+    const double a = shape;
+    double x;
+    if (a > 1) {
+        double t = sqrt(-2 * log(p < .5 ? p : 1 - p));
+        x = (2.30753 + t * 0.27061) / (1 + t * (0.99229 + t * 0.04481)) - t;
+        if (p < .5) x = -x;
+        x = std::max(1e-3, a * pow(1 - 1 / (9 * a) - x / (3 * sqrt(a)), 3));
+    } else {
+        double t = 1 - a * (0.253 + a * 0.12);
+        x = (p < t) ? pow(p / t, 1 / a) : 1 - log(1 - (p - t) / (1 - t));
+    }
+
+    for (int i = 0; i < MAX_QUANTILE_ITERATIONS; i++) {
+        if (x <= 0)
+            return 0;
+        double density = exp((a - 1) * log(x) - x - logGammaShape);
+        if (!(density > 0))
+            break;
+        double u = (lower(x) - p) / density;
+        double step = u / (1 - .5 * std::min(1.0, u * ((a - 1) / x - 1)));
+        x -= step;
+        if (x <= 0)
+            x = .5 * (x + step);
+        if (fabs(step) < 1e-12 * x)
+            break;
+    }
+    return x / invScale;
+}
+
+/*
+ * P(a,x), by the series below x = a + 1 and by 1 - Q(a,x) above.
+ */
+double GammaCdf::lower(double x) const {
+    if (x < shape + 1)
+        return lowerSeries(x);
+    return 1 - (erlangShape > 0 ? upperErlang(x) : upperContinuedFraction(x));
+}
+
+/*
+ * P(a,x) = x^a e^-x / Gamma(a) * sum_n x^n / (a (a+1) ... (a+n)), all terms are positive.
+ */
+double GammaCdf::lowerSeries(double x) const {
+    double term = 1 / shape;
+    double sum = term;
+    double ap = shape;
+    for (int i = 0; i < MAX_ITERATIONS; i++) {
+        ap += 1;
+        term *= x / ap;
+        sum += term;
+        if (fabs(term) < fabs(sum) * DBL_EPSILON)
+            break;
+    }
+    return sum * exp(shape * log(x) - x - logGammaShape);
+}
+
+/*
+ * 1 - P(a,x) by the modified Lentz evaluation of its continued fraction, see Numerical Recipes 6.2.
+ */
+double GammaCdf::upperContinuedFraction(double x) const {
+    const double tiny = DBL_MIN / DBL_EPSILON;
+    double b = x + 1 - shape;
+    double c = 1 / tiny;
+    double d = 1 / b;
+    double h = d;
+    for (int i = 1; i <= MAX_ITERATIONS; i++) {
+        double an = -i * (i - shape);
+        b += 2;
+        d = an * d + b;
+        if (fabs(d) < tiny) d = tiny;
+        c = b + an / c;
+        if (fabs(c) < tiny) c = tiny;
+        d = 1 / d;
+        double delta = d * c;
+        h *= delta;
+        if (fabs(delta - 1) < DBL_EPSILON)
+            break;
+    }
+    return exp(shape * log(x) - x - logGammaShape) * h;
+}
+
+/*
+ * For an integer shape K, 1 - P(K,x) is the probability of less than K events of a Poisson process,
+ * sum_{i<K} x^i e^-x / i!. The terms are accumulated as Poisson probabilities, so they cannot overflow.
+ */
+double GammaCdf::upperErlang(double x) const {
+    double term = exp(-x);
+    double sum = term;
+    for (int i = 1; i < erlangShape; i++) {
+        term *= x / i;
+        sum += term;
+    }
+    return sum;
+}
+
+double neumaierSum(const double *x, int n) {
+    NeumaierSum sum;
+    for (int i = 0; i < n; i++)
+        sum.add(x[i]);
+    return sum.result();
+}
+
+double normalQuantile(double p) {
+    static const double a[] = { -3.969683028665376e+01, 2.209460984245205e+02, -2.759285104469687e+02,
+                                1.383577518672690e+02, -3.066479806614716e+01, 2.506628277459239e+00 };
+    static const double b[] = { -5.447609879822406e+01, 1.615858368580409e+02, -1.556989798598866e+02,
+                                6.680131188771972e+01, -1.328068155288572e+01 };
+    static const double c[] = { -7.784894002430293e-03, -3.223964580411365e-01, -2.400758277161838e+00,
+                                -2.549732539343734e+00, 4.374664141464968e+00, 2.938163982698783e+00 };
+    static const double d[] = { 7.784695709041462e-03, 3.224671290700398e-01, 2.445134137142996e+00,
+                                3.754408661907416e+00 };
+    const double pLow = 0.02425;
+
+    if (p <= 0)
+        return -INFINITY;
+    if (p >= 1)
+        return INFINITY;
+
+    // In the upper tail Phi(x) - p cancels in the Halley step, while 1 - p is exact for p >= 0.5.
+    if (p > 0.5)
+        return -normalQuantile(1 - p);
+
+    double x;
+    if (p < pLow) {
+        double q = sqrt(-2 * log(p));
+        x = (((((c[0]*q + c[1])*q + c[2])*q + c[3])*q + c[4])*q + c[5]) / ((((d[0]*q + d[1])*q + d[2])*q + d[3])*q + 1);
+    } else {
+        double q = p - 0.5;
+        double r = q * q;
+        x = (((((a[0]*r + a[1])*r + a[2])*r + a[3])*r + a[4])*r + a[5])*q / (((((b[0]*r + b[1])*r + b[2])*r + b[3])*r + b[4])*r + 1);
+    }
+
+    // One step of Halley's method on Phi(x) - p.
+    double e = 0.5 * erfc(-x / M_SQRT2) - p;
+    double u = e * sqrt(2 * M_PI) * exp(x * x / 2);
+    return x - u / (1 + x * u / 2);
+}
+
+/*
+ * P(|T| <= t) for t >= 0 is a finite sum in theta = atan(t / sqrt(nu)). Its derivative decreases for t > 0, so Newton's
+ * method from the normal quantile, which lies below the t quantile, increases monotonically to it.
+ */
+double studentQuantile(double p, int degrees) {
+    if (p <= 0)
+        return -INFINITY;
+    if (p >= 1)
+        return INFINITY;
+    if (p < 0.5)
+        return -studentQuantile(1 - p, degrees);
+
+    const double nu = degrees;
+    const double logDensityScale = lgamma((nu + 1) / 2) - lgamma(nu / 2) - 0.5 * log(nu * M_PI);
+    double t = normalQuantile(p);
+    for (int i = 0; i < 200; i++) {
+        double theta = atan(t / sqrt(nu));
+        double c2 = cos(theta) * cos(theta);
+        double term = 1, sum = 1, a;
+        if (degrees % 2 == 1) {
+            for (int k = 3; k <= degrees - 2; k += 2) {
+                term *= c2 * (k - 1) / k;
+                sum += term;
+            }
+            a = 2 / M_PI * (theta + (degrees > 1 ? sin(theta) * cos(theta) * sum : 0));
+        } else {
+            for (int k = 2; k <= degrees - 2; k += 2) {
+                term *= c2 * (k - 1) / k;
+                sum += term;
+            }
+            a = sin(theta) * sum;
+        }
+
+        double density = exp(logDensityScale - (nu + 1) / 2 * log1p(t * t / nu));
+        double step = (p - (1 + a) / 2) / density;
+        t += step;
+        if (fabs(step) <= 1e-12 * t)
+            break;
+    }
+    return t;
+}
+
+}
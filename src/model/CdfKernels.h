@@ -0,0 +1,107 @@
+/**
+ * @file CdfKernels.h
+ * @brief Numerical building blocks of the distributions in GeneralDistribution.h: the gamma cdf and quantile, the normal quantile
+ * and compensated summation, and the Student t quantile of the confidence intervals of quasi-Monte Carlo.
+ */
+
+#ifndef CDFKERNELS_H
+#define CDFKERNELS_H
+
+#include <math.h>
+
+namespace model {
+
+/**
+ * @brief The GammaCdf class evaluates the cdf of the gamma distribution with shape K and scale lambda,
+ * \f$ F(s) = P(K, s/\lambda)\f$ with P the regularized lower incomplete gamma function.
+ * The parameter dependent constants (e.g. \f$ \ln\Gamma(K)\f$) are computed once by setParameters.
+ * P is evaluated by its power series for \f$ x < K+1\f$ and otherwise by the continued fraction of 1-P,
+ * which both converge in a number of steps that only depends on K. For small integer shapes (Erlang)
+ * the finite sum of the Poisson probabilities is used instead of the continued fraction.
+ * The quantile is found by Halley's method on P, see quantile.
+ */
+class GammaCdf
+{
+public:
+    GammaCdf();
+
+    /**
+     * @brief setParameters Sets the shape and the scale.
+     * @return false if the shape or the scale is not positive.
+     */
+    bool setParameters(double shape, double scale);
+
+    double evaluate(double s) const;
+    void evaluate(const double *s, double *res, int n) const;
+
+    /**
+     * @brief quantile The inverse of the cdf, to a relative precision of about 1e-12.
+     */
+    double quantile(double p) const;
+
+private:
+    static const int MAX_ITERATIONS = 1000;
+    static const int MAX_QUANTILE_ITERATIONS = 20;
+    static const int MAX_ERLANG_SHAPE = 20;
+
+    double shape;
+    double invScale;
+    double logGammaShape;
+    int erlangShape; // the shape if it is an integer up to MAX_ERLANG_SHAPE, otherwise 0
+
+    double lower(double x) const;
+    double lowerSeries(double x) const;
+    double upperContinuedFraction(double x) const;
+    double upperErlang(double x) const;
+};
+
+/**
+ * @brief The NeumaierSum class accumulates a sum with Neumaier's compensated summation.
+ */
+class NeumaierSum
+{
+public:
+    NeumaierSum() : sum(0), compensation(0) {}
+
+    void add(double x) {
+        double t = sum + x;
+        if (fabs(sum) >= fabs(x))
+            compensation += (sum - t) + x;
+        else
+            compensation += (x - t) + sum;
+        sum = t;
+    }
+
+    double result() const { return sum + compensation; }
+
+private:
+    double sum;
+    double compensation;
+};
+
+/**
+ * @brief neumaierSum Sums the n values with Neumaier's compensated summation, so that the many small
+ * probability contributions of a fine satisfaction set do not lose precision against the large ones.
+ */
+double neumaierSum(const double *x, int n);
+
+/**
+ * @brief normalQuantile The inverse of the standard normal cdf, by Acklam's rational approximation refined with one
+ * Halley step, which gives full double precision.
+ * @param p A probability in (0,1).
+ * @return x such that \f$ \Phi(x) = p\f$, or -INFINITY/INFINITY for p <= 0 or p >= 1.
+ */
+double normalQuantile(double p);
+
+/**
+ * @brief studentQuantile The inverse of the cdf of Student's t distribution, by Newton's method on its closed form cdf
+ * for an integer number of degrees of freedom (Abramowitz and Stegun 26.7.3 and 26.7.4).
+ * @param p A probability in (0,1).
+ * @param degrees The degrees of freedom, at least 1.
+ * @return t such that \f$ F_\nu(t) = p\f$, or -INFINITY/INFINITY for p <= 0 or p >= 1.
+ */
+double studentQuantile(double p, int degrees);
+
+}
+
+#endif // CDFKERNELS_H
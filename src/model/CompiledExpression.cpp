@@ -0,0 +1,357 @@
+/**
+ * @file CompiledExpression.cpp
+ * @brief Compiles a user defined cdf of the form gen{f(s)} once into a small stack bytecode.
+ */
+
+#include "CompiledExpression.h"
+
+#include <math.h>
+#include <stdlib.h>
+#include <ctype.h>
+
+namespace model {
+
+namespace {
+
+struct NamedConstant {
+    const char *name;
+    double value;
+};
+
+/*
+ * The constants known by libmatheval.
+ */
+const NamedConstant constants[] = {
+    {"e", M_E}, {"log2e", M_LOG2E}, {"log10e", M_LOG10E}, {"ln2", M_LN2}, {"ln10", M_LN10},
+    {"pi", M_PI}, {"pi_2", M_PI_2}, {"pi_4", M_PI_4}, {"1_pi", M_1_PI}, {"2_pi", M_2_PI},
+    {"2_sqrtpi", M_2_SQRTPI}, {"sqrt2", M_SQRT2}, {"sqrt1_2", M_SQRT1_2}
+};
+
+struct NamedFunction {
+    const char *name;
+    int op;
+};
+
+}
+
+CompiledExpression::CompiledExpression() : stackDepth(0), compiled(false), pos(0), depth(0) {
+}
+
+bool CompiledExpression::compile(const char *expression) {
+    code.clear();
+    stackDepth = 0;
+    depth = 0;
+    compiled = false;
+    if (expression == NULL)
+        return false;
+
+    pos = expression;
+    if (!parseSum())
+        return false;
+    skipSpaces();
+    if (*pos != '\0' || depth != 1)
+        return false;
+
+    compiled = true;
+    return true;
+}
+
+void CompiledExpression::skipSpaces() {
+    while (isspace(*pos)) pos++;
+}
+
+bool CompiledExpression::parseSum() {
+    if (!parseProduct()) return false;
+    for (;;) {
+        skipSpaces();
+        char c = *pos;
+        if (c != '+' && c != '-') return true;
+        pos++;
+        if (!parseProduct()) return false;
+        emit(c == '+' ? OP_ADD : OP_SUB);
+    }
+}
+
+bool CompiledExpression::parseProduct() {
+    if (!parseUnary()) return false;
+    for (;;) {
+        skipSpaces();
+        char c = *pos;
+        if (c != '*' && c != '/') return true;
+        pos++;
+        if (!parseUnary()) return false;
+        emit(c == '*' ? OP_MUL : OP_DIV);
+    }
+}
+
+bool CompiledExpression::parseUnary() {
+    skipSpaces();
+    if (*pos == '-') {
+        pos++;
+        if (!parseUnary()) return false;
+        emit(OP_NEG);
+        return true;
+    }
+    return parsePower();
+}
+
+bool CompiledExpression::parsePower() {
+    if (!parsePrimary()) return false;
+    for (;;) {
+        skipSpaces();
+        if (*pos != '^') return true;
+        pos++;
+
+        // The exponent may carry its own unary minus, e.g. s^-2.
+        int negations = 0;
+        for (skipSpaces(); *pos == '-'; skipSpaces()) {
+            pos++;
+            negations++;
+        }
+        if (!parsePrimary()) return false;
+        if (negations % 2 == 1) emit(OP_NEG);
+        emit(OP_POW);
+    }
+}
+
+bool CompiledExpression::parseName(std::string &name) {
+    const char *start = pos;
+    while (isalnum(*pos) || *pos == '_') pos++;
+    name.assign(start, pos - start);
+    return !name.empty();
+}
+
+bool CompiledExpression::parsePrimary() {
+    static const NamedFunction functions[] = {
+        {"exp", OP_EXP}, {"log", OP_LOG}, {"sqrt", OP_SQRT}, {"sin", OP_SIN}, {"cos", OP_COS}, {"tan", OP_TAN},
+        {"cot", OP_COT}, {"sec", OP_SEC}, {"csc", OP_CSC}, {"asin", OP_ASIN}, {"acos", OP_ACOS}, {"atan", OP_ATAN},
+        {"acot", OP_ACOT}, {"asec", OP_ASEC}, {"acsc", OP_ACSC}, {"sinh", OP_SINH}, {"cosh", OP_COSH},
+        {"tanh", OP_TANH}, {"coth", OP_COTH}, {"sech", OP_SECH}, {"csch", OP_CSCH}, {"asinh", OP_ASINH},
+        {"acosh", OP_ACOSH}, {"atanh", OP_ATANH}, {"acoth", OP_ACOTH}, {"asech", OP_ASECH}, {"acsch", OP_ACSCH},
+        {"abs", OP_ABS}, {"step", OP_STEP}, {"delta", OP_DELTA}, {"nandelta", OP_NANDELTA}, {"erf", OP_ERF}
+    };
+
+    skipSpaces();
+    if (*pos == '(') {
+        pos++;
+        if (!parseSum()) return false;
+        skipSpaces();
+        if (*pos != ')') return false;
+        pos++;
+        return true;
+    }
+
+    // Constants such as 1_pi start with a digit, so they are tried before numbers.
+    if (isalnum(*pos) || *pos == '_' || *pos == '.') {
+        const char *start = pos;
+        std::string name;
+        if (parseName(name)) {
+            for (unsigned int i = 0; i < sizeof(constants) / sizeof(constants[0]); i++) {
+                if (name == constants[i].name) {
+                    emit(OP_CONST, constants[i].value);
+                    return true;
+                }
+            }
+            if (name == "s") {
+                emit(OP_VAR);
+                return true;
+            }
+            for (unsigned int i = 0; i < sizeof(functions) / sizeof(functions[0]); i++) {
+                if (name != functions[i].name) continue;
+                skipSpaces();
+                if (*pos != '(') return false;
+                pos++;
+                if (!parseSum()) return false;
+                skipSpaces();
+                if (*pos != ')') return false;
+                pos++;
+                emit((OpCode)functions[i].op);
+                return true;
+            }
+        }
+
+        pos = start;
+        char *end;
+        double value = strtod(start, &end);
+        if (end == start || isalpha(*end) || *end == '_')
+            return false; // unknown name, e.g. another variable
+        pos = end;
+        emit(OP_CONST, value);
+        return true;
+    }
+
+    return false;
+}
+
+int CompiledExpression::arity(OpCode op) {
+    switch (op) {
+    case OP_CONST:
+    case OP_VAR:
+        return 0;
+    case OP_ADD:
+    case OP_SUB:
+    case OP_MUL:
+    case OP_DIV:
+    case OP_POW:
+        return 2;
+    default:
+        return 1;
+    }
+}
+
+/*
+ * Emits an instruction and folds it with the preceding constants when all its operands are constant.
+ */
+void CompiledExpression::emit(OpCode op, double value) {
+    int n = arity(op);
+    if (n > 0 && (int)code.size() >= n) {
+        bool constant = true;
+        for (int i = 1; i <= n; i++)
+            constant = constant && code[code.size() - i].op == OP_CONST;
+        if (constant) {
+            double x = code[code.size() - n].value;
+            double y = (n == 2) ? code[code.size() - 1].value : 0;
+            code.resize(code.size() - n);
+            depth -= n;
+            Instruction folded = {OP_CONST, apply(op, x, y)};
+            code.push_back(folded);
+            depth++;
+            return;
+        }
+    }
+
+    Instruction instruction = {op, value};
+    code.push_back(instruction);
+    depth += 1 - n;
+    if (depth > stackDepth) stackDepth = depth;
+}
+
+double CompiledExpression::apply(OpCode op, double x, double y) {
+    switch (op) {
+    case OP_NEG: return -x;
+    case OP_ADD: return x + y;
+    case OP_SUB: return x - y;
+    case OP_MUL: return x * y;
+    case OP_DIV: return x / y;
+    case OP_POW: return pow(x, y);
+    case OP_EXP: return exp(x);
+    case OP_LOG: return log(x);
+    case OP_SQRT: return sqrt(x);
+    case OP_SIN: return sin(x);
+    case OP_COS: return cos(x);
+    case OP_TAN: return tan(x);
+    case OP_COT: return 1 / tan(x);
+    case OP_SEC: return 1 / cos(x);
+    case OP_CSC: return 1 / sin(x);
+    case OP_ASIN: return asin(x);
+    case OP_ACOS: return acos(x);
+    case OP_ATAN: return atan(x);
+    case OP_ACOT: return atan(1 / x);
+    case OP_ASEC: return acos(1 / x);
+    case OP_ACSC: return asin(1 / x);
+    case OP_SINH: return sinh(x);
+    case OP_COSH: return cosh(x);
+    case OP_TANH: return tanh(x);
+    case OP_COTH: return 1 / tanh(x);
+    case OP_SECH: return 1 / cosh(x);
+    case OP_CSCH: return 1 / sinh(x);
+    case OP_ASINH: return asinh(x);
+    case OP_ACOSH: return acosh(x);
+    case OP_ATANH: return atanh(x);
+    case OP_ACOTH: return 0.5 * log((x + 1) / (x - 1));
+    case OP_ASECH: return acosh(1 / x);
+    case OP_ACSCH: return asinh(1 / x);
+    case OP_ABS: return fabs(x);
+    case OP_STEP: return x < 0 ? 0 : 1;
+    case OP_DELTA: return x == 0 ? INFINITY : 0;
+    case OP_NANDELTA: return x == 0 ? NAN : 0;
+    case OP_ERF: return erf(x);
+    default: return NAN;
+    }
+}
+
+double CompiledExpression::evaluate(double s) const {
+    double stack[MAX_STACK];
+    int top = -1;
+
+    if (stackDepth > MAX_STACK) {
+        std::vector<double> buffer(stackDepth);
+        evaluate(&s, &buffer[0], 1);
+        return buffer[0];
+    }
+
+    for (std::vector<Instruction>::const_iterator it = code.begin(); it != code.end(); ++it) {
+        switch (it->op) {
+        case OP_CONST: stack[++top] = it->value; break;
+        case OP_VAR: stack[++top] = s; break;
+        case OP_ADD: top--; stack[top] += stack[top + 1]; break;
+        case OP_SUB: top--; stack[top] -= stack[top + 1]; break;
+        case OP_MUL: top--; stack[top] *= stack[top + 1]; break;
+        case OP_DIV: top--; stack[top] /= stack[top + 1]; break;
+        case OP_POW: top--; stack[top] = pow(stack[top], stack[top + 1]); break;
+        default: stack[top] = apply(it->op, stack[top], 0); break;
+        }
+    }
+    return stack[0];
+}
+
+void CompiledExpression::evaluate(const double *s, double *res, int n) const {
+    std::vector<double> stack(stackDepth * BLOCK_SIZE);
+
+    for (int start = 0; start < n; start += BLOCK_SIZE) {
+        int m = (n - start < BLOCK_SIZE) ? n - start : BLOCK_SIZE;
+        const double *x = s + start;
+        int top = -1;
+
+        for (std::vector<Instruction>::const_iterator it = code.begin(); it != code.end(); ++it) {
+            double *a;
+            double *b;
+            switch (it->op) {
+            case OP_CONST:
+                a = &stack[++top * BLOCK_SIZE];
+                for (int i = 0; i < m; i++) a[i] = it->value;
+                break;
+            case OP_VAR:
+                a = &stack[++top * BLOCK_SIZE];
+                for (int i = 0; i < m; i++) a[i] = x[i];
+                break;
+            case OP_ADD:
+                top--; a = &stack[top * BLOCK_SIZE]; b = a + BLOCK_SIZE;
+                for (int i = 0; i < m; i++) a[i] += b[i];
+                break;
+            case OP_SUB:
+                top--; a = &stack[top * BLOCK_SIZE]; b = a + BLOCK_SIZE;
+                for (int i = 0; i < m; i++) a[i] -= b[i];
+                break;
+            case OP_MUL:
+                top--; a = &stack[top * BLOCK_SIZE]; b = a + BLOCK_SIZE;
+                for (int i = 0; i < m; i++) a[i] *= b[i];
+                break;
+            case OP_DIV:
+                top--; a = &stack[top * BLOCK_SIZE]; b = a + BLOCK_SIZE;
+                for (int i = 0; i < m; i++) a[i] /= b[i];
+                break;
+            case OP_POW:
+                top--; a = &stack[top * BLOCK_SIZE]; b = a + BLOCK_SIZE;
+                for (int i = 0; i < m; i++) a[i] = pow(a[i], b[i]);
+                break;
+            case OP_NEG:
+                a = &stack[top * BLOCK_SIZE];
+                for (int i = 0; i < m; i++) a[i] = -a[i];
+                break;
+            case OP_EXP:
+                a = &stack[top * BLOCK_SIZE];
+                for (int i = 0; i < m; i++) a[i] = exp(a[i]);
+                break;
+            default:
+                a = &stack[top * BLOCK_SIZE];
+                for (int i = 0; i < m; i++) a[i] = apply(it->op, a[i], 0);
+                break;
+            }
+        }
+
+        for (int i = 0; i < m; i++) res[start + i] = stack[i];
+    }
+}
+
+}
@@ -0,0 +1,94 @@
+/**
+ * @file CompiledExpression.h
+ * @brief Compiles a user defined cdf of the form gen{f(s)} once into a small stack bytecode, so it can be evaluated
+ * without going through libmatheval on every call.
+ */
+
+#ifndef COMPILEDEXPRESSION_H
+#define COMPILEDEXPRESSION_H
+
+#include <vector>
+#include <string>
+
+namespace model {
+
+/**
+ * @brief The CompiledExpression class evaluates an expression in the single variable s.
+ * The accepted grammar is the one of libmatheval: numbers, the variable s, the constants e, log2e, log10e, ln2, ln10,
+ * pi, pi_2, pi_4, 1_pi, 2_pi, 2_sqrtpi, sqrt2 and sqrt1_2, the functions listed at GenPolicy::cdf, unary minus,
+ * + - * / and ^. Like libmatheval, ^ binds stronger than unary minus and is left associative.
+ * Subexpressions without s are folded into constants while compiling.
+ */
+class CompiledExpression
+{
+public:
+    CompiledExpression();
+
+    /**
+     * @brief compile Parses and compiles the expression.
+     * @param expression The expression, e.g. "1 - exp(-s/10)".
+     * @return false if the expression uses something outside the supported grammar (e.g. another variable).
+     * The expression can then still be evaluated by libmatheval.
+     */
+    bool compile(const char *expression);
+
+    bool isCompiled() const { return compiled; }
+
+    /**
+     * @brief evaluate Evaluates the compiled expression.
+     * @param s The value of the variable s.
+     * @return f(s)
+     */
+    double evaluate(double s) const;
+
+    /**
+     * @brief evaluate Evaluates the compiled expression for n values at once. The bytecode is executed instruction by
+     * instruction over blocks of values, which keeps the inner loops free of dispatch.
+     * @param s The n values of the variable s.
+     * @param res Output: the n results, may be the same array as s.
+     * @param n The number of values.
+     */
+    void evaluate(const double *s, double *res, int n) const;
+
+private:
+    enum OpCode {
+        OP_CONST, OP_VAR, OP_NEG, OP_ADD, OP_SUB, OP_MUL, OP_DIV, OP_POW,
+        OP_EXP, OP_LOG, OP_SQRT, OP_SIN, OP_COS, OP_TAN, OP_COT, OP_SEC, OP_CSC,
+        OP_ASIN, OP_ACOS, OP_ATAN, OP_ACOT, OP_ASEC, OP_ACSC,
+        OP_SINH, OP_COSH, OP_TANH, OP_COTH, OP_SECH, OP_CSCH,
+        OP_ASINH, OP_ACOSH, OP_ATANH, OP_ACOTH, OP_ASECH, OP_ACSCH,
+        OP_ABS, OP_STEP, OP_DELTA, OP_NANDELTA, OP_ERF
+    };
+
+    struct Instruction {
+        OpCode op;
+        double value;
+    };
+
+    static const int MAX_STACK = 64;
+    static const int BLOCK_SIZE = 64;
+
+    std::vector<Instruction> code;
+    int stackDepth;
+    bool compiled;
+
+    // Recursive descent parser state
+    const char *pos;
+    int depth;
+
+    bool parseSum();
+    bool parseProduct();
+    bool parseUnary();
+    bool parsePower();
+    bool parsePrimary();
+    bool parseName(std::string &name);
+    void skipSpaces();
+
+    void emit(OpCode op, double value = 0);
+    static int arity(OpCode op);
+    static double apply(OpCode op, double x, double y);
+};
+
+}
+
+#endif // COMPILEDEXPRESSION_H
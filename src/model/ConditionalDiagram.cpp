@@ -0,0 +1,244 @@
+/**
+ * @file ConditionalDiagram.cpp
+ * @brief Probabilities of a model with several general transitions, exact in the first general transition and
+ * conditional on or integrated over the delays of the others.
+ */
+
+#include "ConditionalDiagram.h"
+
+#include <algorithm>
+#include <math.h>
+
+namespace model {
+
+const double ConditionalDiagram::STD_TIME_MARGIN = 1e-3;
+const double ConditionalDiagram::MIN_DELAY = 1e-6;
+
+ConditionalDiagram::ConditionalDiagram(Model *model, Logger *guic) {
+    this->model = model;
+    this->guic = guic;
+    this->initialMarking = NULL;
+    this->modelChecker = NULL;
+    this->maxTime = model->MaxTime;
+    this->generalTransitions = model->N_generalTransitions;
+    this->determTransitions = model->N_determTransitions;
+}
+
+ConditionalDiagram::~ConditionalDiagram() {
+    delete modelChecker;
+    if (initialMarking != NULL) freeMarking(initialMarking);
+    TimedDiagram::getInstance()->clear();
+
+    // Restore the secondary general transitions
+    for (unsigned int k = 0; k < secondaries.size(); k++) {
+        model->transitions[secondaries[k]].type = TT_GENERAL;
+        model->transitions[secondaries[k]].idInMarking = secondaryIds[k];
+        model->transitions[secondaries[k]].time = secondaryTimes[k];
+    }
+    model->N_generalTransitions = generalTransitions;
+    model->N_determTransitions = determTransitions;
+    model->MaxTime = maxTime;
+}
+
+bool ConditionalDiagram::prepare() {
+    if (model->N_generalTransitions == 0) {
+        guic->addError("The model needs a general transition.");
+        return false;
+    }
+
+    int primary = gTransitionId(model);
+    for (int transitionIndex = 0; transitionIndex < model->N_transitions; transitionIndex++) {
+        Transition &transition = model->transitions[transitionIndex];
+        if (transition.type != TT_GENERAL || transitionIndex == primary) continue;
+        if (!firesOnce(transitionIndex)) {
+            guic->addError(QString("Transition #%1 : %2 can be enabled again after it fired, which is only supported for the first general transition.").arg(transitionIndex+1).arg(transition.id).toStdString());
+            return false;
+        }
+        secondaries.push_back(transitionIndex);
+        secondaryIds.push_back(transition.idInMarking);
+        secondaryTimes.push_back(transition.time);
+        transition.type = TT_DETERMINISTIC;
+        transition.idInMarking = model->N_determTransitions++;
+    }
+    // The primary transition is the first general transition, so its idInMarking is already 0
+    model->N_generalTransitions = 1;
+
+    // The initial marking is kept out of the register, which is emptied after every STD
+    initialMarking = createInitialMarking(model);
+    clearAllocatedMarkings();
+    TimedDiagram::getInstance()->setModel(model);
+    modelChecker = new ModelChecker(model, TimedDiagram::getInstance(), guic);
+    return modelChecker->setVariables();
+}
+
+/*
+ * Whether the transition is disabled for good once it fired: it takes tokens from a discrete place that no transition
+ * puts tokens into, and that has fewer than twice as many tokens as it takes at first. This is checked on the model
+ * instead of in the STDs, since the STD of a deterministic transition that keeps firing after a short delay may not even
+ * be built. It rejects some models in which the transition could not be enabled again for other reasons.
+ */
+bool ConditionalDiagram::firesOnce(int transitionIndex) const {
+    const Transition &transition = model->transitions[transitionIndex];
+    for (int i = 0; i < transition.inputListSize; i++) {
+        const Arc &arc = model->arcs[transition.inputList[i]];
+        if (arc.type != AT_DISCRETE_INPUT) continue;
+        const Place &place = model->places[arc.fromId];
+        if (place.inputListSize == 0 && place.d_mark < 2 * arc.weight) return true;
+    }
+    return false;
+}
+
+void ConditionalDiagram::calcProbs(const std::vector<double> &delays, const std::vector<double> &times, int pIndex, const std::vector<double> &amounts, std::vector<double> &probs) {
+    for (unsigned int k = 0; k < secondaries.size(); k++) {
+        model->transitions[secondaries[k]].time = delays[k];
+    }
+
+    // The STD only has to reach the last time point, but the model checker cannot evaluate it at MaxTime itself,
+    // where the regions end, so it is built a little further
+    model->MaxTime = times.back() + STD_TIME_MARGIN * std::max(1.0, times.back());
+
+    TimedDiagram::getInstance()->clear();
+    TimedDiagram::getInstance()->generateDiagram(initialMarking);
+    probs.resize(times.size() * amounts.size());
+    for (unsigned int i = 0; i < times.size(); i++) {
+        for (unsigned int j = 0; j < amounts.size(); j++) {
+            probs[i * amounts.size() + j] = modelChecker->calcContProbAtTime(times[i], pIndex, amounts[j]);
+        }
+    }
+    TimedDiagram::getInstance()->clear();
+    freeAllocatedMarkings();
+}
+
+long ConditionalDiagram::integrateProbs(const std::vector<GeneralDistribution *> &distributions, const std::vector<double> &times, int pIndex,
+                                        const std::vector<double> &amounts, double tolerance, std::vector<double> &probs, double &error) {
+    integrationDistributions = &distributions;
+    integrationTimes = &times;
+    integrationAmounts = &amounts;
+    integrationPlace = pIndex;
+    integrationTolerance = tolerance;
+    integrationDelays.assign(secondaries.size(), 0);
+    diagrams = 0;
+
+    if (secondaries.empty()) {
+        calcProbs(integrationDelays, times, pIndex, amounts, probs);
+        error = 0;
+        return 1;
+    }
+    integrate(0, probs, error);
+    return diagrams;
+}
+
+/*
+ * Integrates over the delays of the secondary transitions from dimension on, for the delays before it in
+ * integrationDelays. (0,1) is first divided into equal intervals, so that a jump is not missed by the few points of one
+ * interval. Then the intervals with the largest error are bisected until the error is at most the tolerance of the
+ * dimension, which is halved for every next one, so the errors of the inner integrals leave room for the outer one.
+ *
+ * The intervals are not divided at the time points or at the delays before it: the STD is not reliable when events
+ * coincide exactly, which would happen at the ends of such intervals.
+ */
+void ConditionalDiagram::integrate(unsigned int dimension, std::vector<double> &result, double &error) {
+    const double tolerance = ldexp(integrationTolerance, -(int) dimension);
+
+    std::vector<QuadratureInterval> intervals(INITIAL_QUADRATURE_INTERVALS);
+    error = 0;
+    for (unsigned int i = 0; i < intervals.size(); i++) {
+        QuadratureInterval &interval = intervals[i];
+        interval.a = (double) i / intervals.size();
+        interval.b = (double) (i + 1) / intervals.size();
+        for (int j = 0; j < 5; j++) {
+            if (j == 0 && i > 0) {
+                // The start is the end of the previous interval
+                interval.values[0] = intervals[i - 1].values[4];
+                interval.errors[0] = intervals[i - 1].errors[4];
+            } else {
+                evaluate(dimension, interval.a + j * (interval.b - interval.a) / 4, interval.values[j], interval.errors[j]);
+            }
+        }
+        estimate(interval);
+        error += interval.error;
+    }
+
+    while (error > tolerance && intervals.size() < (unsigned int) MAX_QUADRATURE_INTERVALS) {
+        unsigned int worst = 0;
+        for (unsigned int i = 1; i < intervals.size(); i++) {
+            if (intervals[i].error > intervals[worst].error) worst = i;
+        }
+
+        // The halves take the quarter points as their midpoints, so only their new quarter points are evaluated
+        QuadratureInterval &left = intervals[worst];
+        QuadratureInterval right;
+        right.a = (left.a + left.b) / 2;
+        right.b = left.b;
+        left.b = right.a;
+        right.values[0] = left.values[2];
+        right.errors[0] = left.errors[2];
+        right.values[2] = left.values[3];
+        right.errors[2] = left.errors[3];
+        right.values[4] = left.values[4];
+        right.errors[4] = left.errors[4];
+        left.values[4] = left.values[2];
+        left.errors[4] = left.errors[2];
+        left.values[2] = left.values[1];
+        left.errors[2] = left.errors[1];
+        for (int j = 1; j < 5; j += 2) {
+            evaluate(dimension, left.a + j * (left.b - left.a) / 4, left.values[j], left.errors[j]);
+            evaluate(dimension, right.a + j * (right.b - right.a) / 4, right.values[j], right.errors[j]);
+        }
+        estimate(left);
+        estimate(right);
+        intervals.push_back(right);
+
+        error = 0;
+        for (unsigned int i = 0; i < intervals.size(); i++) {
+            error += intervals[i].error;
+        }
+    }
+
+    result.assign(intervals[0].integral.size(), 0);
+    for (unsigned int i = 0; i < intervals.size(); i++) {
+        for (unsigned int j = 0; j < result.size(); j++) {
+            result[j] += intervals[i].integral[j];
+        }
+    }
+}
+
+/*
+ * The probabilities for the delay F^-1(u) of the secondary transition dimension, with the error of the inner
+ * integrals. A delay beyond the last time point cannot make a difference anymore, which also avoids an infinite one.
+ */
+void ConditionalDiagram::evaluate(unsigned int dimension, double u, std::vector<double> &values, double &error) {
+    const double maxDelay = 2 * integrationTimes->back() + 1;
+    double delay = (*integrationDistributions)[secondaryIds[dimension]]->quantile(u);
+    integrationDelays[dimension] = std::min(std::max(delay, MIN_DELAY), maxDelay);
+
+    error = 0;
+    if (dimension + 1 < secondaries.size()) {
+        integrate(dimension + 1, values, error);
+    } else {
+        calcProbs(integrationDelays, *integrationTimes, integrationPlace, *integrationAmounts, values);
+        diagrams++;
+    }
+}
+
+/*
+ * The composite Simpson estimate of the integral over the interval, with the difference to the Simpson estimate of the
+ * whole interval (in the largest component, over 15 as in Richardson extrapolation) plus the inner errors as its error.
+ */
+void ConditionalDiagram::estimate(QuadratureInterval &interval) {
+    const double length = interval.b - interval.a;
+    const unsigned int size = interval.values[0].size();
+
+    interval.integral.resize(size);
+    double difference = 0;
+    for (unsigned int k = 0; k < size; k++) {
+        double whole = length / 6 * (interval.values[0][k] + 4 * interval.values[2][k] + interval.values[4][k]);
+        interval.integral[k] = length / 12 * (interval.values[0][k] + 4 * interval.values[1][k] + 2 * interval.values[2][k]
+                                              + 4 * interval.values[3][k] + interval.values[4][k]);
+        difference = std::max(difference, fabs(interval.integral[k] - whole));
+    }
+    interval.error = difference / 15 + length / 12 * (interval.errors[0] + 4 * interval.errors[1] + 2 * interval.errors[2]
+                                                     + 4 * interval.errors[3] + interval.errors[4]);
+}
+
+}
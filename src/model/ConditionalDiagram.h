@@ -0,0 +1,135 @@
+/**
+ * @file ConditionalDiagram.h
+ * @brief Probabilities of a model with several general transitions, exact in the first general transition and
+ * conditional on or integrated over the delays of the others.
+ */
+
+#ifndef CONDITIONALDIAGRAM_H
+#define CONDITIONALDIAGRAM_H
+
+#include "DFPN2.h"
+#include "TimedDiagram.h"
+#include "ModelChecker.h"
+#include "GeneralDistribution.h"
+#include "Logger.h"
+
+#include <vector>
+
+namespace model {
+
+/**
+ * @brief The ConditionalDiagram class reduces a model with several general transitions to the one general transition
+ * the STD can handle. The first general transition is the primary one; the others (the secondary ones) are turned into
+ * deterministic transitions with given delays. The STD of the primary transition then gives the exact probability
+ * conditional on these delays, which is the sample of conditional Monte Carlo, and the integral of it over the
+ * distributions of the delays is the unconditional probability (see integrateProbs).
+ *
+ * A converted transition fires like a deterministic one, which fires again once it is enabled again, while a general
+ * transition fires at most once. So prepare rejects the model unless every secondary transition is disabled for good by
+ * its firing (see firesOnce). The STD and the register of allocated markings are global, so all of this has to run on
+ * one thread. The model is changed until the ConditionalDiagram is deleted.
+ */
+class ConditionalDiagram
+{
+public:
+    ConditionalDiagram(Model *model, Logger *guic);
+    virtual ~ConditionalDiagram();
+
+    /**
+     * @brief prepare Turns the secondary general transitions into deterministic ones and sets up the model checker.
+     * @return false if the model has no general transition, a secondary one can be enabled again after it fired or the
+     * model checker cannot be set up.
+     */
+    bool prepare();
+
+    int getSecondaryCount() const { return secondaries.size(); }
+
+    /**
+     * @brief getSecondaryGeneralId The idInMarking of a secondary transition as a general transition, i.e. its index in
+     * the delays of a DES run and in the distributions of integrateProbs.
+     */
+    int getSecondaryGeneralId(int k) const { return secondaryIds[k]; }
+
+    /**
+     * @brief calcProbs Calculates the probabilities that the fluid level of a place is at most the amounts, given the
+     * delays of the secondary transitions.
+     * @param delays The delay of each secondary transition.
+     * @param times The time points, in increasing order.
+     * @param pIndex The index of the fluid place.
+     * @param amounts The constants.
+     * @param probs Output: the probability of time point i and constant j at index i * amounts.size() + j.
+     */
+    void calcProbs(const std::vector<double> &delays, const std::vector<double> &times, int pIndex, const std::vector<double> &amounts, std::vector<double> &probs);
+
+    /**
+     * @brief integrateProbs Calculates the probabilities of calcProbs without conditions, by integrating them over the
+     * distributions of the secondary delays with nested adaptive Simpson quadrature. A delay is integrated in the
+     * quantile space, over u in (0,1) with the delay F^-1(u), so the weights are the probabilities of the distribution,
+     * which also covers point masses and unbounded delays. The probabilities jump where the level reaches a constant
+     * just at a time point, so a low order rule that reuses its points when an interval is bisected is the cheapest.
+     * The probabilities are therefore only as accurate as the quadrature, whose estimated error is returned.
+     * @param distributions The distributions of the general transitions, by their idInMarking before prepare.
+     * @param times The time points, in increasing order.
+     * @param pIndex The index of the fluid place.
+     * @param amounts The constants.
+     * @param tolerance The absolute error to aim for.
+     * @param probs Output: as for calcProbs.
+     * @param error Output: the estimated absolute error of the probabilities.
+     * @return The number of STDs that were built.
+     */
+    long integrateProbs(const std::vector<GeneralDistribution *> &distributions, const std::vector<double> &times, int pIndex,
+                        const std::vector<double> &amounts, double tolerance, std::vector<double> &probs, double &error);
+
+private:
+    // The relative margin between the last time point and the end of the STD
+    static const double STD_TIME_MARGIN;
+    // The number of intervals into which the quadrature of one delay divides (0,1) at first, and at most
+    static const int INITIAL_QUADRATURE_INTERVALS = 8;
+    static const int MAX_QUADRATURE_INTERVALS = 1024;
+    // The shortest delay of the quadrature, the STD cannot handle a deterministic transition that fires at once
+    static const double MIN_DELAY;
+
+    Model *model;
+    Logger *guic;
+    Marking *initialMarking;
+    ModelChecker *modelChecker;
+
+    // The secondary transitions, with their original idInMarking and time, and the original counts of the model
+    std::vector<int> secondaries;
+    std::vector<int> secondaryIds;
+    std::vector<double> secondaryTimes;
+    double maxTime;
+    int generalTransitions;
+    int determTransitions;
+
+    // The state of integrateProbs
+    const std::vector<GeneralDistribution *> *integrationDistributions;
+    const std::vector<double> *integrationTimes;
+    const std::vector<double> *integrationAmounts;
+    int integrationPlace;
+    double integrationTolerance;
+    std::vector<double> integrationDelays;
+    long diagrams;
+
+    /**
+     * @brief The QuadratureInterval struct is a subinterval of the quadrature of one delay, with the integrand (and
+     * its error, from the inner integrals) at its ends, its quarter points and its midpoint.
+     */
+    struct QuadratureInterval {
+        double a, b;
+        std::vector<double> values[5];
+        double errors[5];
+        std::vector<double> integral;
+        double error;
+    };
+
+    void integrate(unsigned int dimension, std::vector<double> &result, double &error);
+    void evaluate(unsigned int dimension, double u, std::vector<double> &values, double &error);
+    void estimate(QuadratureInterval &interval);
+
+    bool firesOnce(int transitionIndex) const;
+};
+
+}
+
+#endif // CONDITIONALDIAGRAM_H
@@ -7,11 +7,413 @@
 
 #include "Facade.h"
 #include "opencv/cv.h"
+#include "RandomStream.h"
+#include "RunningStatistics.h"
+#include "SobolSequence.h"
+#include "CdfKernels.h"
+#include "GeneralDistribution.h"
+#include "ConditionalDiagram.h"
+#include <algorithm>
+#include <iterator>
+#include <QMutex>
+#include <QThread>
+#include <QThreadPool>
+#include <QRunnable>
 extern "C" {
 #include "matheval.h"
 }
 
 namespace model {
+    namespace {
+        // The number of samples of a chunk, the unit of work of a thread
+        const long long DES_CHUNK_SAMPLES = 1024;
+
+        /*
+         * Collects the messages of a worker thread, since the logger of the facade may only be used by the calling thread.
+         */
+        class MessageCollector : public Logger {
+        public:
+            void addText(std::string) {}
+            void addSuccess(std::string) {}
+            void addWarning(std::string) {}
+            void addError(std::string str) { errors.push_back(str); }
+            void setText(std::string) {}
+            std::string getText() { return ""; }
+
+            std::vector<std::string> errors;
+        };
+
+        /*
+         * The statistics of a point from the statistics of its groups. With one group these are the statistics of the
+         * samples, otherwise of the means of the groups (the replicates of quasi-Monte Carlo), of which the samples are
+         * not independent. samples is set to the number of samples of the point.
+         */
+        RunningStatistics pointStatistics(const std::vector<RunningStatistics> &groupStatistics, int constant, int groups, long long &samples) {
+            if (groups == 1) {
+                samples = groupStatistics[constant].getCount();
+                return groupStatistics[constant];
+            }
+
+            RunningStatistics statistics;
+            samples = 0;
+            for (int group = 0; group < groups; group++) {
+                const RunningStatistics &replicate = groupStatistics[constant * groups + group];
+                if (replicate.getCount() == 0) continue;
+                statistics.add(replicate.getMean());
+                samples += replicate.getCount();
+            }
+            return statistics;
+        }
+
+        void deleteDistributions(std::vector<GeneralDistribution *> &distributions) {
+            for (unsigned int k = 0; k < distributions.size(); k++) {
+                delete distributions[k];
+            }
+            distributions.clear();
+        }
+
+        /*
+         * Creates the distributions of the general transitions, by their idInMarking, and prepares their quantiles.
+         * Returns false (with an error) if a cdf cannot be parsed or does not approach 1.
+         */
+        bool createDistributions(Model *model, Logger *guic, std::vector<GeneralDistribution *> &distributions) {
+            distributions.assign(model->N_generalTransitions, (GeneralDistribution *) NULL);
+            for (int transitionIndex = 0; transitionIndex < model->N_transitions; transitionIndex++) {
+                if (model->transitions[transitionIndex].type != TT_GENERAL) continue;
+                GeneralDistribution *distribution = GeneralDistribution::create(model, transitionIndex, guic);
+                if (distribution != NULL && !distribution->prepareQuantile()) {
+                    guic->addError(QString("Transition #%1 : %2 has a cdf that does not approach 1, so its delays cannot be drawn.").arg(transitionIndex+1).arg(model->transitions[transitionIndex].id).toStdString());
+                    delete distribution;
+                    distribution = NULL;
+                }
+                if (distribution == NULL) {
+                    deleteDistributions(distributions);
+                    return false;
+                }
+                distributions[model->transitions[transitionIndex].idInMarking] = distribution;
+            }
+            return true;
+        }
+
+        /*
+         * A chunk of samples of one trajectory set: the samples [firstSample, lastSample) of the set, simulated up to the
+         * time point horizon (exclusive). The statistics of the property are kept per time point, constant and group
+         * (index constant * groups + group). The chunks have a fixed size and are merged in order, so the result does not
+         * depend on the number of threads.
+         */
+        struct DESChunk {
+            int trajectorySet;
+            long long firstSample;
+            long long lastSample;
+            int horizon;
+            std::vector<std::vector<RunningStatistics> > statistics;
+        };
+
+        /*
+         * Simulates chunks of a DES on a thread of the pool, until no chunk is left. Sample k of trajectory set s draws its
+         * random numbers from stream s * samplesPerSet + k, independent of the thread and the chunk it is simulated in.
+         * There is one group of samples, except for quasi-Monte Carlo: then sample k belongs to replicate g = k % groups and
+         * takes point k / groups of the Sobol sequence, digitally shifted with the shift of the set and the replicate.
+         *
+         * A sample is one run, or with antithetic runs the average of the run with the random numbers v and the run with
+         * 1 - v. With importance sampling, the random number of a general transition is tilted to u = v^(1/alpha), which
+         * has density alpha * u^(alpha-1), and the run is weighted with the likelihood ratio u^(1-alpha) / alpha. Since the
+         * delay is the inverse cdf of u, its cdf becomes F(d)^alpha, so alpha < 1 makes short delays more likely and
+         * alpha > 1 long ones. This is no change of parameters: an exponential delay gets the cdf (1 - e^(-lambda d))^alpha,
+         * not another rate. The weights keep the estimate unbiased for any tilt, but a weighted sample can exceed 1.
+         *
+         * With multilevel splitting a sample is one replicate of the fixed effort estimator, see simulateSplittingChunk.
+         */
+        class DESWorker : public QRunnable {
+        public:
+            DESWorker(Model *model, Marking *initialMarking, const std::vector<double> &simulationTimes,
+                      const std::vector<double> &fluidPlaceMinimumConstants, int fluidPlaceIndex, long long samplesPerSet,
+                      const SimulationOptions &options, uint64_t seed, const SobolSequence *sobol, const std::vector<uint32_t> &shifts,
+                      int groups, const std::vector<GeneralDistribution *> &distributions, std::vector<DESChunk> &chunks, int &nextChunk, QMutex &mutex)
+                : model(model), initialMarking(initialMarking), simulationTimes(simulationTimes),
+                  fluidPlaceMinimumConstants(fluidPlaceMinimumConstants), fluidPlaceIndex(fluidPlaceIndex), samplesPerSet(samplesPerSet),
+                  options(options), seed(seed), sobol(sobol), shifts(shifts), groups(groups), distributions(distributions),
+                  chunks(chunks), nextChunk(nextChunk), mutex(mutex),
+                  simulator(model, &collector), // the marking of the simulator is allocated here, on the calling thread
+                  errors(collector.errors), failed(false) {
+                setAutoDelete(false);
+            }
+
+            void run() {
+                while (!failed) {
+                    int chunk;
+                    {
+                        QMutexLocker locker(&mutex);
+                        if (nextChunk >= (int)chunks.size()) return;
+                        chunk = nextChunk++;
+                    }
+                    failed = !(options.splittingLevels > 0 ? simulateSplittingChunk(chunks[chunk]) : simulateChunk(chunks[chunk]));
+                }
+            }
+
+        private:
+            Model *model;
+            Marking *initialMarking;
+            const std::vector<double> &simulationTimes;
+            const std::vector<double> &fluidPlaceMinimumConstants;
+            int fluidPlaceIndex;
+            long long samplesPerSet;
+            const SimulationOptions &options;
+            uint64_t seed;
+            const SobolSequence *sobol; // NULL for plain Monte Carlo
+            const std::vector<uint32_t> &shifts;
+            int groups;
+            const std::vector<GeneralDistribution *> &distributions; // by idInMarking
+            std::vector<DESChunk> &chunks;
+            int &nextChunk;
+            QMutex &mutex;
+            MessageCollector collector;
+            Simulator simulator;
+
+            bool simulateChunk(DESChunk &chunk) {
+                std::vector<double> times(simulationTimes.begin(), simulationTimes.begin() + chunk.horizon);
+                std::vector<double> uniforms(model->N_generalTransitions);
+                std::vector<uint32_t> point(model->N_generalTransitions);
+                std::vector<double> delays(model->N_generalTransitions);
+                std::vector<double> levels;
+                std::vector<std::vector<double> > values(chunk.horizon, std::vector<double>(fluidPlaceMinimumConstants.size()));
+                const int runsPerSample = options.antithetic ? 2 : 1;
+                const bool tilted = options.importanceExponent != 1;
+
+                // A trajectory set belongs to one constant, unless the same runs are used for all constants
+                unsigned int firstConstant = options.commonRandomNumbers ? 0 : chunk.trajectorySet;
+                unsigned int lastConstant = options.commonRandomNumbers ? fluidPlaceMinimumConstants.size() : chunk.trajectorySet + 1;
+                chunk.statistics.assign(chunk.horizon, std::vector<RunningStatistics>(fluidPlaceMinimumConstants.size() * groups));
+
+                for (long long sample = chunk.firstSample; sample < chunk.lastSample; sample++) {
+                    int group = sample % groups;
+                    if (sobol != NULL) {
+                        // The shifted point, in the middle of its cell of width 2^-32 so it is never 0
+                        sobol->point(sample / groups, &point[0]);
+                        const uint32_t *shift = &shifts[(chunk.trajectorySet * groups + group) * model->N_generalTransitions];
+                        for (int k = 0; k < model->N_generalTransitions; k++) {
+                            uniforms[k] = ((point[k] ^ shift[k]) + 0.5) * (1.0 / 4294967296.0);
+                        }
+                    } else {
+                        RandomStream random(seed, chunk.trajectorySet * samplesPerSet + sample);
+                        for (int k = 0; k < model->N_generalTransitions; k++) {
+                            uniforms[k] = random.nextUniform();
+                        }
+                    }
+
+                    for (unsigned int i = 0; i < times.size(); i++) {
+                        for (unsigned int j = firstConstant; j < lastConstant; j++) {
+                            values[i][j] = 0;
+                        }
+                    }
+
+                    for (int r = 0; r < runsPerSample; r++) {
+                        // Pick the delay of every general transition, and the likelihood ratio of the run
+                        double weight = 1;
+                        for (int transitionIndex = 0; transitionIndex < model->N_transitions; transitionIndex++) {
+                            Transition &transition = model->transitions[transitionIndex];
+                            if (transition.type != TT_GENERAL) continue;
+
+                            double u = r == 0 ? uniforms[transition.idInMarking] : 1 - uniforms[transition.idInMarking];
+                            if (tilted && transition.df_distr != Dtrm) {
+                                u = pow(u, 1 / options.importanceExponent);
+                                weight *= pow(u, 1 - options.importanceExponent) / options.importanceExponent;
+                            }
+                            delays[transition.idInMarking] = distributions[transition.idInMarking]->quantile(u);
+                        }
+
+                        // Simulate the trajectory
+                        if (!simulator.simulate(initialMarking, delays, times, fluidPlaceIndex, levels)) {
+                            return false;
+                        }
+
+                        // Add whether the run satisfies the property
+                        for (unsigned int i = 0; i < times.size(); i++) {
+                            for (unsigned int j = firstConstant; j < lastConstant; j++) {
+                                if (levels[i] <= fluidPlaceMinimumConstants[j]) values[i][j] += weight / runsPerSample;
+                            }
+                        }
+                    }
+
+                    for (unsigned int i = 0; i < times.size(); i++) {
+                        for (unsigned int j = firstConstant; j < lastConstant; j++) {
+                            chunk.statistics[i][j * groups + group].add(values[i][j]);
+                        }
+                    }
+                }
+                return true;
+            }
+
+            /*
+             * Draws the delays of the general transitions that have not fired, given the time they have been enabled:
+             * the delay is the inverse cdf of u in (F(a), 1) for the enabled time a. This is the distribution of the
+             * remaining delay of a trajectory that has reached the current state, so copies of the state that draw
+             * new delays continue independently. F(a) is quantileCdf, which unlike cdf may run on every worker and
+             * matches the quantile it is used with.
+             */
+            void drawRemainingDelays(RandomStream &random, std::vector<double> &delays) {
+                for (int transitionIndex = 0; transitionIndex < model->N_transitions; transitionIndex++) {
+                    Transition &transition = model->transitions[transitionIndex];
+                    if (transition.type != TT_GENERAL) continue;
+                    int k = transition.idInMarking;
+                    double v = random.nextUniform();
+                    if (simulator.hasFired(k)) continue;
+
+                    double enabled = distributions[k]->quantileCdf(simulator.getEnabledTime(k));
+                    delays[k] = std::max(simulator.getEnabledTime(k), distributions[k]->quantile(enabled + (1 - enabled) * v));
+                }
+            }
+
+            /*
+             * One replicate of the fixed effort splitting estimator of the probability that the level of the place is at
+             * most the constant c of the trajectory set, at every time point. If c is below the initial level x0 this is
+             * the rare event, otherwise the rare event is a level above c and its complement is added.
+             *
+             * The levels L_l = x0 + l (c - x0) / m for l < m divide the way to c into m stages. Stage l simulates
+             * splittingEffort runs, each from a random one of the states in which the runs of the previous stage reached
+             * L_(l-1) (the first stage from the initial marking), until the level reaches L_l or the last time point.
+             * The fraction p_l of the runs that reach L_l estimates the conditional probability to get there. The runs of
+             * the last stage are continued to the last time point, and the estimate at time t is p_1 ... p_(m-1) times the
+             * fraction of them that satisfy the rare event at t. A run can only satisfy it at t if it reached L_(m-1) before t,
+             * since the level is continuous. The product of the stage fractions is unbiased, so the replicates are
+             * independent unbiased samples. A sample costs m * splittingEffort runs.
+             */
+            bool simulateSplittingChunk(DESChunk &chunk) {
+                std::vector<double> times(simulationTimes.begin(), simulationTimes.begin() + chunk.horizon);
+                std::vector<double> delays(model->N_generalTransitions);
+                std::vector<double> levels;
+                std::vector<double> hits(chunk.horizon);
+                std::vector<SimulationState> entrances, crossings;
+                const int stages = options.splittingLevels;
+                const int effort = options.splittingEffort;
+                const int place = model->places[fluidPlaceIndex].idInMarking;
+                const double constant = fluidPlaceMinimumConstants[chunk.trajectorySet];
+                const double initialLevel = initialMarking->fluid0[place];
+                const int direction = constant < initialLevel ? -1 : 1;
+                chunk.statistics.assign(chunk.horizon, std::vector<RunningStatistics>(fluidPlaceMinimumConstants.size()));
+
+                for (long long sample = chunk.firstSample; sample < chunk.lastSample; sample++) {
+                    double weight = 1;
+                    simulator.reset(initialMarking);
+                    entrances.resize(1);
+                    simulator.save(entrances[0]);
+                    std::fill(hits.begin(), hits.end(), 0.0);
+
+                    for (int stage = 1; stage <= stages && weight > 0; stage++) {
+                        double level = initialLevel + stage * (constant - initialLevel) / stages;
+                        crossings.clear();
+                        for (int run = 0; run < effort; run++) {
+                            RandomStream random(seed, ((chunk.trajectorySet * samplesPerSet + sample) * stages + stage - 1) * effort + run);
+                            simulator.restore(entrances[std::min((int) (random.nextUniform() * entrances.size()), (int) entrances.size() - 1)]);
+                            drawRemainingDelays(random, delays);
+
+                            bool crossed;
+                            if (stage < stages) {
+                                if (!simulator.run(delays, times, fluidPlaceIndex, direction, level, levels, crossed)) return false;
+                                if (crossed) {
+                                    crossings.push_back(SimulationState());
+                                    simulator.save(crossings.back());
+                                }
+                            } else {
+                                // Before the time the run started here the rare event cannot hold
+                                unsigned int first = std::lower_bound(times.begin(), times.end(), simulator.getTime()) - times.begin();
+                                if (!simulator.run(delays, times, fluidPlaceIndex, 0, 0, levels, crossed)) return false;
+                                for (unsigned int i = first; i < times.size(); i++) {
+                                    if (direction < 0 ? levels[i] <= constant : levels[i] > constant) hits[i]++;
+                                }
+                            }
+                        }
+                        if (stage < stages) {
+                            weight *= (double) crossings.size() / effort;
+                            entrances.swap(crossings);
+                        }
+                    }
+
+                    for (unsigned int i = 0; i < times.size(); i++) {
+                        double estimate = weight * hits[i] / effort;
+                        chunk.statistics[i][chunk.trajectorySet].add(direction < 0 ? estimate : 1 - estimate);
+                    }
+                }
+                return true;
+            }
+
+        public:
+            const std::vector<std::string> &errors;
+            bool failed;
+        };
+
+        /*
+         * Conditional Monte Carlo for a model with several general transitions. A sample draws only the delays of the
+         * secondary transitions of a ConditionalDiagram (with the same random numbers as a plain run of the same
+         * stream), and the STD of the primary transition gives the exact probability conditional on these delays.
+         * By the law of total probability the samples are unbiased, and their variance is only the variance of the
+         * conditional probability, which is at most that of the indicator of a plain run.
+         * The STD and the register of allocated markings are global, so the samples are computed on the calling thread.
+         */
+        class ConditionalEstimator {
+        public:
+            ConditionalEstimator(Model *model, Logger *guic, const std::vector<double> &simulationTimes,
+                                 const std::vector<double> &fluidPlaceMinimumConstants, int fluidPlaceIndex, long long samplesPerSet,
+                                 uint64_t seed, const std::vector<GeneralDistribution *> &distributions)
+                : diagram(model, guic), simulationTimes(simulationTimes), fluidPlaceMinimumConstants(fluidPlaceMinimumConstants),
+                  fluidPlaceIndex(fluidPlaceIndex), samplesPerSet(samplesPerSet), seed(seed), distributions(distributions),
+                  generalTransitions(model->N_generalTransitions) {}
+
+            bool prepare() { return diagram.prepare(); }
+
+            // Without secondary transitions a single sample is the exact probability
+            bool exact() const { return diagram.getSecondaryCount() == 0; }
+
+            bool simulateChunk(DESChunk &chunk) {
+                std::vector<double> uniforms(generalTransitions);
+                std::vector<double> delays(diagram.getSecondaryCount());
+                std::vector<double> times(simulationTimes.begin(), simulationTimes.begin() + chunk.horizon);
+                std::vector<double> probs;
+                chunk.statistics.assign(chunk.horizon, std::vector<RunningStatistics>(fluidPlaceMinimumConstants.size()));
+
+                for (long long sample = chunk.firstSample; sample < chunk.lastSample; sample++) {
+                    RandomStream random(seed, chunk.trajectorySet * samplesPerSet + sample);
+                    for (int k = 0; k < generalTransitions; k++) {
+                        uniforms[k] = random.nextUniform();
+                    }
+                    for (unsigned int k = 0; k < delays.size(); k++) {
+                        int id = diagram.getSecondaryGeneralId(k);
+                        delays[k] = distributions[id]->quantile(uniforms[id]);
+                    }
+
+                    diagram.calcProbs(delays, times, fluidPlaceIndex, fluidPlaceMinimumConstants, probs);
+                    for (int i = 0; i < chunk.horizon; i++) {
+                        for (unsigned int j = 0; j < fluidPlaceMinimumConstants.size(); j++) {
+                            chunk.statistics[i][j].add(probs[i * fluidPlaceMinimumConstants.size() + j]);
+                        }
+                    }
+                }
+                return true;
+            }
+
+        private:
+            ConditionalDiagram diagram;
+            const std::vector<double> &simulationTimes;
+            const std::vector<double> &fluidPlaceMinimumConstants;
+            int fluidPlaceIndex;
+            long long samplesPerSet;
+            uint64_t seed;
+            const std::vector<GeneralDistribution *> &distributions; // by the original idInMarking
+            int generalTransitions;
+        };
+
+        /*
+         * Deletes a parsed formula with all its subformulas, which the parser creates as a tree.
+         */
+        void deleteFormula(Formula *formula) {
+            if (formula == NULL) return;
+            deleteFormula(formula->getLeftChild());
+            deleteFormula(formula->getRightChild());
+            delete formula;
+        }
+    }
+
+
     Facade::Facade(QString rawFileName, QString rawPlaceName, Logger *newGuic, bool allowMultipleGeneralTransitions)
     {
         guic = newGuic;
@@ -153,6 +555,23 @@ namespace model {
     }
 
     bool Facade::showProbFunc(double cStart, double cEnd, double cStep, double tStep, double maxTime) {
+        return showProbFunc(cStart, cEnd, cStep, tStep, maxTime, FIXED_STEP);
+    }
+
+    /**
+     * @brief Facade::showProbFunc Shows the 3D probability graph for a range of constants of the currently loaded model.
+     * @param cStart The first constant
+     * @param cEnd The last constant
+     * @param cStep The step size between the constants
+     * @param tStep The time step size of the graph, or the smallest refinement step when sampling adaptively.
+     * @param maxTime The maximum time to calculate probabilities for.
+     * @param sampling How the time axis is sampled.
+     * @return true if completed successfully, false otherwise.
+     */
+    bool Facade::showProbFunc(double cStart, double cEnd, double cStep, double tStep, double maxTime, TimeSampling sampling) {
+        // The maximal deviation from linear interpolation accepted by the adaptive sampling
+        const double adaptiveTolerance = 1.0e-4;
+
         timeval start, end;
         long mtime_full,mtime_std,mtime_measures, seconds, useconds;
         int regionAmount;
@@ -169,6 +588,14 @@ namespace model {
         //Input and output list of places and transitions are created and sorted wrt to their priority and share.
         model->MaxTime = maxTime;
 
+        if (model->N_generalTransitions > 1) {
+            if (sampling != FIXED_STEP) {
+                guic->addError("A model with several general transitions can only be sampled with a fixed time step.");
+                return false;
+            }
+            return _showIntegratedProbFunc(cStart, cEnd, cStep, tStep, maxTime);
+        }
+
         Marking* initialMarking = createInitialMarking(model);
         seconds = 0; useconds = 0;
 
@@ -208,20 +635,47 @@ namespace model {
             return false;
         }
 
+        QString outputFileName = QString(sampling == ADAPTIVE_STEP ? "./output/%1_3d_adaptive.dat" : sampling == PIECEWISE_EXACT ? "./output/%1_3d_exact.dat" : "./output/%1_3d.dat").arg(placeName);
         std::ofstream oFile;
-        oFile.open(QString2Char(QString("./output/%1_3d.dat").arg(placeName)), std::ios::out);
+        oFile.open(outputFileName.toStdString().c_str(), std::ios::out);
 
         seconds = 0; useconds = 0;
         timeval t0, t1;
         gettimeofday(&t0, NULL);
-        for (double t = .02; t <= model->MaxTime + .01; t += tStep){
-            for (amount = cStart+.05; amount <= cEnd; amount += cStep){
+        if (sampling == ADAPTIVE_STEP) {
+            // Non-uniform grid: one block of "c t p" lines per sampled time, as expected by splot.
+            std::vector<double> amounts;
+            for (amount = cStart+.05; amount <= cEnd; amount += cStep)
+                amounts.push_back(amount);
+
+            std::vector<double> times;
+            std::vector<std::vector<double> > probs;
+            modelChecker->calcAdaptiveProbCurve(times, probs, pIndex, amounts, tStep, adaptiveTolerance);
+            for (unsigned int i = 0; i < times.size(); i++) {
+                for (unsigned int k = 0; k < amounts.size(); k++)
+                    oFile << amounts[k] << " " << times[i] << " " << probs[i][k] << std::endl;
+                oFile << std::endl;
+            }
+            guic->addText(QString("Number of sampled time points: %1").arg(times.size()).toStdString());
+        } else if (sampling == PIECEWISE_EXACT) {
+            for (amount = cStart+.05; amount <= cEnd; amount += cStep) {
+                if (!writeExactProbCurve(oFile, modelChecker, pIndex, amount)) {
+                    oFile.close();
+                    delete modelChecker;
+                    freeMarking(initialMarking);
+                    return false;
+                }
+            }
+        } else {
+            for (double t = .02; t <= model->MaxTime + .01; t += tStep){
+                for (amount = cStart+.05; amount <= cEnd; amount += cStep){
 
-                double p = modelChecker->calcProb(modelChecker->calcAtomContISetAtTime(t, pIndex, amount),0.00);
+                    double p = modelChecker->calcProb(modelChecker->calcAtomContISetAtTime(t, pIndex, amount),0.00);
 
-                oFile << " "<< p;
+                    oFile << " "<< p;
+                }
+                oFile << std::endl;
             }
-            oFile << std::endl;
         }
 
         gettimeofday(&t1, NULL);
@@ -229,17 +683,29 @@ namespace model {
         seconds  += t1.tv_sec  - t0.tv_sec;
         useconds += t1.tv_usec - t0.tv_usec;
 
-        switch (model->transitions[gTransitionId(model)].df_distr)
-        {
-        case Gen: evaluator_destroy(modelChecker->getF());
-            break;
-        }
         mtime_measures = ((seconds * 1000 + useconds/1000.0) + 0.5);
         //std::cout << "total time computing measures:  " << mtime_measures << "ms" << std::endl;
 
         oFile.close();
         FILE* gnuplotPipe;
-        if ( (gnuplotPipe = popen("gnuplot -persist","w")) )
+        if (sampling == PIECEWISE_EXACT)
+        {
+            guic->addText(QString("The exact probability curve is written to %1").arg(outputFileName).toStdString());
+        }
+        else if (sampling == ADAPTIVE_STEP && (gnuplotPipe = popen("gnuplot -persist","w")) )
+        {
+            fprintf(gnuplotPipe,"set pm3d \n unset surface\n "
+                    "set xlabel \"Constant\" \n"
+                    "set zlabel \"Probability\"\n"
+                    "set ylabel \"Time\"\n"
+                    "set palette rgbformulae 33,13,10 \n");
+            fflush(gnuplotPipe);
+            fprintf(gnuplotPipe,"splot \"%s\" using 1:2:3 with lines\n",outputFileName.toStdString().c_str());
+            fflush(gnuplotPipe);
+            fprintf(gnuplotPipe,"exit \n");
+            fclose(gnuplotPipe);
+        }
+        else if ( (gnuplotPipe = popen("gnuplot -persist","w")) )
         {
             fprintf(gnuplotPipe,"set pm3d \n unset surface\n "
                     "set xlabel \"Constant\" \n"
@@ -282,6 +748,21 @@ namespace model {
      * @return true
      */
     bool Facade::showProbFunc(double c, double tStep, double maxTime) {
+        return showProbFunc(c, tStep, maxTime, FIXED_STEP);
+    }
+
+    /**
+     * @brief Facade::showProbFunc Shows the 2D probability graph for a given constant of the currently loaded model.
+     * @param c The constant
+     * @param tStep The step size of the graph, or the smallest refinement step when sampling adaptively.
+     * @param maxTime The maximum time to calculate probabilities for.
+     * @param sampling How the time axis is sampled.
+     * @return true if completed successfully, false otherwise.
+     */
+    bool Facade::showProbFunc(double c, double tStep, double maxTime, TimeSampling sampling) {
+        // The maximal deviation from linear interpolation accepted by the adaptive sampling
+        const double adaptiveTolerance = 1.0e-4;
+
         timeval start, end;
         long mtime_full,mtime_std,mtime_measures,seconds,useconds;
         int regionAmount;
@@ -298,6 +779,14 @@ namespace model {
         //Input and output list of places and transitions are created and sorted wrt to their priority and share.
         model->MaxTime = maxTime;
 
+        if (model->N_generalTransitions > 1) {
+            if (sampling != FIXED_STEP) {
+                guic->addError("A model with several general transitions can only be sampled with a fixed time step.");
+                return false;
+            }
+            return _showIntegratedProbFunc(c, c, 0, tStep, maxTime);
+        }
+
         Marking* initialMarking = createInitialMarking(model);
 
         TimedDiagram::getInstance()->setModel(model);
@@ -335,20 +824,39 @@ namespace model {
             return false;
         }
 
+        QString outputFileName = QString(sampling == ADAPTIVE_STEP ? "./output/%1_2d_adaptive.dat" : sampling == PIECEWISE_EXACT ? "./output/%1_2d_exact.dat" : "./output/%1_2d.dat").arg(placeName);
         std::ofstream oFile;
-        oFile.open(QString2Char(QString("./output/%1_2d.dat").arg(placeName)), std::ios::out);
+        oFile.open(outputFileName.toStdString().c_str(), std::ios::out);
 
         seconds = 0; useconds = 0;
         timeval t0, t1;
         amount = c;
         gettimeofday(&t0, NULL);
-        for (double t = 0; t <= model->MaxTime + .01; t += tStep){
+        if (sampling == ADAPTIVE_STEP) {
+            // Non-uniform grid: "t p" lines.
+            std::vector<double> amounts(1, amount);
+            std::vector<double> times;
+            std::vector<std::vector<double> > probs;
+            modelChecker->calcAdaptiveProbCurve(times, probs, pIndex, amounts, tStep, adaptiveTolerance);
+            for (unsigned int i = 0; i < times.size(); i++)
+                oFile << times[i] << " " << probs[i][0] << std::endl;
+            guic->addText(QString("Number of sampled time points: %1").arg(times.size()).toStdString());
+        } else if (sampling == PIECEWISE_EXACT) {
+            if (!writeExactProbCurve(oFile, modelChecker, pIndex, amount)) {
+                oFile.close();
+                delete modelChecker;
+                freeMarking(initialMarking);
+                return false;
+            }
+        } else {
+            for (double t = 0; t <= model->MaxTime + .01; t += tStep){
 
-                double p = modelChecker->calcProb(modelChecker->calcAtomContISetAtTime(t, pIndex, amount),0.00);
+                    double p = modelChecker->calcProb(modelChecker->calcAtomContISetAtTime(t, pIndex, amount),0.00);
 
-                oFile << " "<< p;
+                    oFile << " "<< p;
 
-            oFile << std::endl;
+                oFile << std::endl;
+            }
         }
 
         gettimeofday(&t1, NULL);
@@ -356,18 +864,27 @@ namespace model {
         seconds  += t1.tv_sec  - t0.tv_sec;
         useconds += t1.tv_usec - t0.tv_usec;
 
-        switch (model->transitions[gTransitionId(model)].df_distr)
-        {
-        case Gen: evaluator_destroy(modelChecker->getF());
-            break;
-        }
-
         mtime_measures = ((seconds * 1000 + useconds/1000.0) + 0.5);
         //std::cout << "total time computing measures:  " << mtime_measures << "ms" << std::endl;
 
         oFile.close();
         FILE* gnuplotPipe;
-        if ( (gnuplotPipe = popen("gnuplot -persist","w")) )
+        if (sampling == PIECEWISE_EXACT)
+        {
+            guic->addText(QString("The exact probability curve is written to %1").arg(outputFileName).toStdString());
+        }
+        else if (sampling == ADAPTIVE_STEP && (gnuplotPipe = popen("gnuplot -persist","w")) )
+        {
+            fprintf(gnuplotPipe,"set title 'Place constant 2d-plot '\n "
+                    "set xlabel \"Time\" \n"
+                    "set ylabel \"Probability\"\n");
+            fflush(gnuplotPipe);
+            fprintf(gnuplotPipe,"plot \"%s\" using 1:2 title \"probability\" with lp \n",outputFileName.toStdString().c_str());
+            fflush(gnuplotPipe);
+            fprintf(gnuplotPipe,"exit \n");
+            fclose(gnuplotPipe);
+        }
+        else if ( (gnuplotPipe = popen("gnuplot -persist","w")) )
         {
 
             char buffer[400];
@@ -400,30 +917,231 @@ namespace model {
         return true;
     }
 
+    /**
+     * @brief Facade::_showIntegratedProbFunc Shows the 2D or 3D probability graph of a model with several general
+     * transitions. The STD only handles the first general transition, so the probabilities are integrated over the delays
+     * of the others with a ConditionalDiagram, which builds one STD for every quadrature node. So unlike the other graphs
+     * these probabilities are numerical approximations, whose estimated error is reported.
+     * The graph has the same time points, constants and output file as that of showProbFunc with a fixed step.
+     * @param cStart The lowest constant, or the constant of the 2D graph.
+     * @param cEnd The highest constant.
+     * @param cStep The step size of the constants, or 0 for the 2D graph.
+     * @param tStep The step size of the time.
+     * @param maxTime The maximum time to calculate probabilities for.
+     * @return true if completed successfully, false otherwise.
+     */
+    bool Facade::_showIntegratedProbFunc(double cStart, double cEnd, double cStep, double tStep, double maxTime) {
+        // The absolute error of the probabilities the quadrature aims for
+        const double integrationTolerance = 1.0e-5;
+
+        const bool plot3d = cStep > 0;
+        timeval start, end;
+        long mtime_full, seconds, useconds;
+        gettimeofday(&start, NULL);
+
+        model->MaxTime = maxTime;
+
+        int pIndex;
+        for (pIndex = 0; pIndex < model->N_places; pIndex++) {
+            if (model->places[pIndex].type == PT_FLUID && strncmp(model->places[pIndex].id,QString2Char(placeName), strlen(model->places[pIndex].id)) == 0) {
+                break;
+            }
+        }
+        if (pIndex >= model->N_places) {
+            guic->addError("The place name is set to an invalid place name. This functionality only works for fluid place names.");
+            return false;
+        }
+
+        std::vector<double> times;
+        for (double t = plot3d ? .02 : 0; t <= maxTime + .01; t += tStep) {
+            times.push_back(t);
+        }
+        std::vector<double> amounts;
+        if (plot3d) {
+            for (double amount = cStart+.05; amount <= cEnd; amount += cStep)
+                amounts.push_back(amount);
+        } else {
+            amounts.push_back(cStart);
+        }
+        if (times.empty() || amounts.empty()) {
+            guic->addError("The graph has no time points or constants.");
+            return false;
+        }
+
+        std::vector<GeneralDistribution *> distributions;
+        if (!createDistributions(model, guic, distributions)) {
+            return false;
+        }
+
+        std::vector<double> probs;
+        double error;
+        long diagrams;
+        {
+            ConditionalDiagram diagram(model, guic);
+            if (!diagram.prepare()) {
+                deleteDistributions(distributions);
+                return false;
+            }
+            diagrams = diagram.integrateProbs(distributions, times, pIndex, amounts, integrationTolerance, probs, error);
+        }
+        deleteDistributions(distributions);
+
+        QString outputFileName = QString(plot3d ? "./output/%1_3d.dat" : "./output/%1_2d.dat").arg(placeName);
+        std::ofstream oFile;
+        oFile.open(outputFileName.toStdString().c_str(), std::ios::out);
+        for (unsigned int i = 0; i < times.size(); i++) {
+            for (unsigned int j = 0; j < amounts.size(); j++) {
+                oFile << " " << probs[i * amounts.size() + j];
+            }
+            oFile << std::endl;
+        }
+        oFile.close();
+
+        FILE* gnuplotPipe;
+        if (plot3d && (gnuplotPipe = popen("gnuplot -persist","w")) )
+        {
+            fprintf(gnuplotPipe,"set pm3d \n unset surface\n "
+                    "set xlabel \"Constant\" \n"
+                    "set zlabel \"Probability\"\n"
+                    "set ylabel \"Time\"\n"
+                    "set palette rgbformulae 33,13,10 \n");
+            fflush(gnuplotPipe);
+            fprintf(gnuplotPipe,"splot \"%s\" matrix with lines\n",outputFileName.toStdString().c_str());
+            fflush(gnuplotPipe);
+            fprintf(gnuplotPipe,"exit \n");
+            fclose(gnuplotPipe);
+        }
+        else if (!plot3d && (gnuplotPipe = popen("gnuplot -persist","w")) )
+        {
+            fprintf(gnuplotPipe,"set title 'Place constant 2d-plot '\n "
+                    "set xlabel \"Time\" \n"
+                    "set ylabel \"Probability\"\n");
+            fflush(gnuplotPipe);
+            fprintf(gnuplotPipe,"plot \"%s\" title \"probability\" with lp \n",outputFileName.toStdString().c_str());
+            fflush(gnuplotPipe);
+            fprintf(gnuplotPipe,"exit \n");
+            fclose(gnuplotPipe);
+        }
+
+        gettimeofday(&end, NULL);
+        seconds  = end.tv_sec  - start.tv_sec;
+        useconds = end.tv_usec - start.tv_usec;
+        mtime_full = ((seconds) * 1000 + useconds/1000.0) + 0.5;
+
+        guic->addText(QString("Number of STDs: %1").arg(diagrams).toStdString());
+        guic->addText(QString("Estimated error of the probabilities: %1").arg(error).toStdString());
+        if (error > integrationTolerance) {
+            guic->addWarning(QString("The estimated error is above the tolerance of %1.").arg(integrationTolerance).toStdString());
+        }
+        guic->addText(QString("Total execution time: %1 ms").arg(mtime_full).toStdString());
+        return true;
+    }
+
+    /**
+     * @brief Facade::writeExactProbCurve Writes the exact piecewise representation of \f$ P(x \leq amount)\f$ over time.
+     * The block starts with "constant c" and "breakpoints n t_0 ... t_n-1". It is followed by one "segment tStart tEnd m" line
+     * per piece, each followed by m lines "loSlope loIntercept hiSlope hiIntercept". On the open interval (tStart, tEnd) the
+     * probability equals the sum over these lines of F(hiSlope*t + hiIntercept) - F(loSlope*t + loIntercept), where F is the
+     * cdf given on the "distribution" line at the top of the file.
+     * @param out The stream to write to.
+     * @param modelChecker The model checker holding the STD.
+     * @param pIndex The index of the continuous place.
+     * @param amount The constant.
+     * @return true if completed successfully, false otherwise.
+     */
+    bool Facade::writeExactProbCurve(std::ostream &out, ModelChecker *modelChecker, int pIndex, double amount) {
+        const char* distributionNames[] = {"", "exp", "uni", "gen", "gamma", "norm", "foldednorm", "dtrm"};
+
+        std::vector<ProbCurveSegment> segments;
+        if (!modelChecker->calcExactProbCurve(segments, pIndex, amount)) {
+            guic->addError(QString("The exact probability curve for constant %1 could not be determined.").arg(amount).toStdString());
+            return false;
+        }
+
+        out.precision(15);
+        if (out.tellp() <= 0) {
+            int gTransition = gTransitionId(model);
+            out << "distribution " << distributionNames[model->transitions[gTransition].df_distr] << "{" << model->transitions[gTransition].df_argument << "}" << std::endl;
+        }
+
+        out << "constant " << amount << std::endl;
+        out << "breakpoints " << (segments.empty() ? 0 : segments.size() + 1);
+        for (unsigned int i = 0; i < segments.size(); i++)
+            out << " " << segments[i].tStart;
+        if (!segments.empty())
+            out << " " << segments.back().tEnd;
+        out << std::endl;
+
+        for (unsigned int i = 0; i < segments.size(); i++) {
+            out << "segment " << segments[i].tStart << " " << segments[i].tEnd << " " << segments[i].intervals.size() << std::endl;
+            for (unsigned int j = 0; j < segments[i].intervals.size(); j++) {
+                AffineInterval &interval = segments[i].intervals[j];
+                out << interval.loSlope << " " << interval.loIntercept << " " << interval.hiSlope << " " << interval.hiIntercept << std::endl;
+            }
+        }
+        return true;
+    }
+
+    /**
+     * @brief Facade::setSimulationOptions Sets the seed, the number of threads and the stopping rule of the DES.
+     * @param options The options.
+     */
+    void Facade::setSimulationOptions(const SimulationOptions &options) {
+        simulationOptions = options;
+    }
+
     /**
      * @brief Facade::showProbFunc Shows the 2D probability graph for a given constant of the currently loaded model, calculated using DES.
      * @param fluidPlaceMinimumConstant The constant
-     * @param runsPerStep The number of simulation runs per step of the graph
+     * @param runsPerStep The number of simulation runs per step of the graph, or the maximum in the sequential mode of SimulationOptions
      * @param simulationTimeStep The step size of the graph
      * @param simulationTimeMax The maximum time to calculate probabilities for.
      * @return true if completed successfully, false otherwise.
      */
     bool Facade::showDESProbFunc(double fluidPlaceMinimumConstant, int runsPerStep, double simulationTimeStep, double simulationTimeMax) {
+        return showDESProbFunc(fluidPlaceMinimumConstant, runsPerStep, simulationTimeStep, simulationTimeMax, FIXED_STEP);
+    }
+
+    /**
+     * @brief Facade::showDESProbFunc Shows the 2D probability graph for a given constant of the currently loaded model, calculated using DES.
+     * @param fluidPlaceMinimumConstant The constant
+     * @param runsPerStep The number of simulation runs per step of the graph, or the maximum in the sequential mode of SimulationOptions
+     * @param simulationTimeStep The step size of the graph
+     * @param simulationTimeMax The maximum time to calculate probabilities for.
+     * @param sampling How the time axis is sampled, FIXED_STEP or ADAPTIVE_STEP.
+     * @return true if completed successfully, false otherwise.
+     */
+    bool Facade::showDESProbFunc(double fluidPlaceMinimumConstant, int runsPerStep, double simulationTimeStep, double simulationTimeMax, TimeSampling sampling) {
         if(runsPerStep <= 0) {
             return false;
         }
-        return _showDESProbFunc(fluidPlaceMinimumConstant, fluidPlaceMinimumConstant, 0, runsPerStep, simulationTimeStep, simulationTimeMax);
+        return _showDESProbFunc(fluidPlaceMinimumConstant, fluidPlaceMinimumConstant, 0, runsPerStep, simulationTimeStep, simulationTimeMax, sampling);
     }
 
     /**
      * @brief Facade::showProbFunc Shows the 2D probability graph for a given constant of the currently loaded model, calculated using DES.
      * @param fluidPlaceMinimumConstant The constant
-     * @param runsPerStep The number of simulation runs per step of the graph
+     * @param runsPerStep The number of simulation runs per step of the graph, or the maximum in the sequential mode of SimulationOptions
      * @param simulationTimeStep The step size of the graph
      * @param simulationTimeMax The maximum time to calculate probabilities for.
      * @return true if completed successfully, false otherwise.
      */
     bool Facade::showDESProbFunc(double fluidPlaceMinimumStart, double fluidPlaceMinimumEnd, double fluidPlaceMinimumStep, int runsPerStep, double simulationTimeStep, double simulationTimeMax) {
+        return showDESProbFunc(fluidPlaceMinimumStart, fluidPlaceMinimumEnd, fluidPlaceMinimumStep, runsPerStep, simulationTimeStep, simulationTimeMax, FIXED_STEP);
+    }
+
+    /**
+     * @brief Facade::showDESProbFunc Shows the 3D probability graph for a range of constants of the currently loaded model, calculated using DES.
+     * @param fluidPlaceMinimumStart The first constant
+     * @param fluidPlaceMinimumEnd The last constant
+     * @param fluidPlaceMinimumStep The step size between the constants
+     * @param runsPerStep The number of simulation runs per step of the graph, or the maximum in the sequential mode of SimulationOptions
+     * @param simulationTimeStep The step size of the graph
+     * @param simulationTimeMax The maximum time to calculate probabilities for.
+     * @param sampling How the time axis is sampled, FIXED_STEP or ADAPTIVE_STEP.
+     * @return true if completed successfully, false otherwise.
+     */
+    bool Facade::showDESProbFunc(double fluidPlaceMinimumStart, double fluidPlaceMinimumEnd, double fluidPlaceMinimumStep, int runsPerStep, double simulationTimeStep, double simulationTimeMax, TimeSampling sampling) {
         // Check the input
         if(fluidPlaceMinimumStep <= 0) {
             return false;
@@ -434,22 +1152,25 @@ namespace model {
         if(runsPerStep <= 0) {
             return false;
         }
-        return _showDESProbFunc(fluidPlaceMinimumStart, fluidPlaceMinimumEnd, fluidPlaceMinimumStep, runsPerStep, simulationTimeStep, simulationTimeMax);
+        return _showDESProbFunc(fluidPlaceMinimumStart, fluidPlaceMinimumEnd, fluidPlaceMinimumStep, runsPerStep, simulationTimeStep, simulationTimeMax, sampling);
     }
 
     /**
      * @brief Facade::showProbFunc Shows the 2D or 3D probability graph for a given constant of the currently loaded model, calculated using DES.
      * @param fluidPlaceMinimumConstant The constant
-     * @param runsPerStep The number of simulation runs per step of the graph
+     * @param runsPerStep The number of simulation runs per step of the graph, or the maximum in the sequential mode of SimulationOptions
      * @param simulationTimeStep The step size of the graph
      * @param simulationTimeMax The maximum time to calculate probabilities for.
+     * @param sampling How the time axis is sampled. ADAPTIVE_STEP adds the breakpoints of the STD to the time steps.
      * @return true if completed successfully, false otherwise.
      */
-    bool Facade::_showDESProbFunc(double fluidPlaceMinimumStart, double fluidPlaceMinimumEnd, double fluidPlaceMinimumStep, int runsPerStep, double simulationTimeStep, double simulationTimeMax) {
-        // Should we do a new randomized run for each constant step?
-        const bool runPerFluidPlaceMinimum = true;
+    bool Facade::_showDESProbFunc(double fluidPlaceMinimumStart, double fluidPlaceMinimumEnd, double fluidPlaceMinimumStep, int runsPerStep, double simulationTimeStep, double simulationTimeMax, TimeSampling sampling) {
+        // Should we do a new randomized run for each constant step? With common random numbers all constants use the same runs,
+        // and so do the samples of conditional Monte Carlo, which give the probabilities of all constants at once
+        const bool conditional = simulationOptions.conditionalMonteCarlo;
+        const bool runPerFluidPlaceMinimum = !simulationOptions.commonRandomNumbers && !conditional;
 
-        // The file used for reading random data from
+        // The file used for reading a random seed from
         const std::string randomDataFile = "/dev/urandom";
 
         // The starting time for the simulation
@@ -464,9 +1185,6 @@ namespace model {
             return false;
         }
 
-        // Will we be doing DES?
-        bool isDES = runsPerStep > 0;
-
         // Initialize the model
         InitializeModel(model);
 
@@ -485,212 +1203,350 @@ namespace model {
             return false;
         }
 
-        // Open the output file; this is were the plot data will be written to
-        std::string outputFileName = std::string("./output/") + placeName.toStdString() + std::string(isDES ? "_des_" : "_") + std::string(fluidPlaceMinimumStep > 0 ? "3" : "2") + std::string("d.dat");
+        if (sampling == PIECEWISE_EXACT) {
+            guic->addError("A simulation has no exact probability curve; sample it with a fixed or adaptive time step.");
+            return false;
+        }
+        if (sampling == ADAPTIVE_STEP && model->N_generalTransitions != 1) {
+            guic->addError("A model with several general transitions can only be sampled with a fixed time step.");
+            return false;
+        }
+
+        // The time points and the constants of the graph
+        std::vector<double> simulationTimes;
+        for (double simulationTime = simulationTimeMin; simulationTime <= simulationTimeMax + .01; simulationTime += simulationTimeStep) {
+            simulationTimes.push_back(simulationTime);
+        }
+        if (sampling == ADAPTIVE_STEP) {
+            // The curve has its kinks at the breakpoints of the STD. A run gives the level at all time points at once, so
+            // they are added to the time steps instead of replacing them
+            Marking* diagramMarking = createInitialMarking(model);
+            TimedDiagram::getInstance()->setModel(model);
+            TimedDiagram::getInstance()->generateDiagram(diagramMarking);
+            std::vector<double> breakpoints;
+            TimedDiagram::getInstance()->getBreakpoints(breakpoints);
+            freeMarking(diagramMarking);
+
+            std::vector<double> times;
+            std::merge(simulationTimes.begin(), simulationTimes.end(), breakpoints.begin(), breakpoints.end(), std::back_inserter(times));
+            simulationTimes.clear();
+            for (unsigned int i = 0; i < times.size(); i++) {
+                if (simulationTimes.empty() || !IS_ZERO(times[i] - simulationTimes.back()))
+                    simulationTimes.push_back(times[i]);
+            }
+            guic->addText(QString("Number of sampled time points: %1").arg(simulationTimes.size()).toStdString());
+        }
+
+        // Open the output file; this is were the plot data will be written to. Adaptive output has the times in it
+        std::string outputFileName = std::string("./output/") + placeName.toStdString() + std::string("_des_") + std::string(fluidPlaceMinimumStep > 0 ? "3" : "2") +
+                                     std::string(sampling == ADAPTIVE_STEP ? "d_adaptive.dat" : "d.dat");
         std::ofstream outputFile;
         outputFile.open(outputFileName.c_str());
-
-        // Determine the number of constant steps
-        int fluidPlaceMinimumStepCount = 1;
-        if(fluidPlaceMinimumStep > 0) {
-            fluidPlaceMinimumStepCount += (fluidPlaceMinimumEnd - fluidPlaceMinimumStart) / fluidPlaceMinimumStep;
+        std::vector<double> fluidPlaceMinimumConstants;
+        for (double fluidPlaceMinimumConstant = fluidPlaceMinimumStart; fluidPlaceMinimumConstant <= fluidPlaceMinimumEnd + .01; fluidPlaceMinimumConstant += fluidPlaceMinimumStep) {
+            fluidPlaceMinimumConstants.push_back(fluidPlaceMinimumConstant);
+            if (fluidPlaceMinimumStep <= 0) break;
         }
 
         // Store the DES init time
         timeval timeInitDES;
         gettimeofday(&timeInitDES, NULL);
 
-        // Some variables for use with DES
-        FILE* randomDataFileHandle = NULL;
-        struct generalTransitionData {
-            int index;
-            int df_distr;
-            char* df_argument;
-        };
-        int generalTransitionCount = 0;
-        generalTransitionData* generalTransitions = NULL;
-
-        // DES-specific initialization
-        if(isDES) {
-            // Try to access the random data file
-            randomDataFileHandle = fopen(randomDataFile.c_str(), "r");
+        // Determine the seed of the random streams
+        uint64_t seed = simulationOptions.seed;
+        if (simulationOptions.randomSeed) {
+            FILE* randomDataFileHandle = fopen(randomDataFile.c_str(), "r");
             if(!randomDataFileHandle) {
                 guic->addText("Failed to open random data file: " + randomDataFile);
                 return false;
             }
+            if(fread(&seed, sizeof(seed), 1, randomDataFileHandle) != 1) {
+                guic->addText("Failed to read (enough) random data from file: " + randomDataFile);
+                fclose(randomDataFileHandle);
+                return false;
+            }
+            fclose(randomDataFileHandle);
+        }
+        guic->addText(QString("DES seed: %1").arg((qulonglong) seed).toStdString());
 
-            // Find all general transition and store their properties
-            generalTransitionCount = model->N_generalTransitions;
-            generalTransitions = new generalTransitionData[generalTransitionCount];
-            for (int transitionIndex = 0, generalTransitionIndex = 0; transitionIndex < model->N_transitions && generalTransitionIndex < generalTransitionCount; transitionIndex++) {
-                if (model->transitions[transitionIndex].type == TT_GENERAL) {
-                    // Save the properties
-                    generalTransitions[generalTransitionIndex].index = transitionIndex;
-                    generalTransitions[generalTransitionIndex].df_distr = model->transitions[transitionIndex].df_distr;
-                    generalTransitions[generalTransitionIndex].df_argument = model->transitions[transitionIndex].df_argument;
-
-                    // We process the first transition differently
-                    if(generalTransitionIndex == 0) {
-                        // Set an deterministic distribution for the transition
-                        model->transitions[transitionIndex].df_distr = Dtrm;
-                        model->transitions[transitionIndex].idInMarking = 0;
-                    } else {
-                        // Make the transition fully deterministic
-                        model->transitions[transitionIndex].type = TT_DETERMINISTIC;
-                        model->transitions[transitionIndex].df_distr = 0;
-                        model->transitions[transitionIndex].df_argument = NULL;
-                        model->N_generalTransitions -= 1;
-                        model->transitions[transitionIndex].idInMarking = model->N_determTransitions;
-                        model->N_determTransitions += 1;
-                    }
+        // The delays of the general transitions are drawn by the quantiles of their distributions, which are parsed and
+        // prepared once here, so the workers cannot run into an error
+        std::vector<GeneralDistribution *> distributions;
+        if (!createDistributions(model, guic, distributions)) {
+            return false;
+        }
 
-                    // Increase the count of processed general transitions
-                    generalTransitionIndex++;
-                }
-            }
-        } else {
-            // We need at least 1 run for the analytical approach
-            runsPerStep = 1;
+        // Every run is one trajectory, which gives the fluid level at all time points at once; a sample consists of one or,
+        // with antithetic runs, two runs, and with splitting of all runs of a replicate, of which at least two are needed
+        // for an interval. A fixed number of runs is simulated in one round; the sequential mode simulates rounds of
+        // batchRuns runs, until the confidence intervals of all time points of a constant are small enough or runsPerStep
+        // is reached.
+        const bool sequential = simulationOptions.halfWidth > 0;
+        const bool splitting = simulationOptions.splittingLevels > 0;
+        const int runsPerSample = splitting ? simulationOptions.splittingLevels * simulationOptions.splittingEffort : (simulationOptions.antithetic ? 2 : 1);
+        const long long minimumSamples = splitting ? 2 : 1;
+        const long long samplesPerSet = std::max(minimumSamples, (long long) runsPerStep / runsPerSample);
+        const long long roundSamples = sequential ? std::max(minimumSamples, (long long) simulationOptions.batchRuns / runsPerSample) : samplesPerSet;
+        const long long chunkSamples = splitting ? 1 : DES_CHUNK_SAMPLES;
+        const double z = normalQuantile(0.5 + simulationOptions.confidenceLevel / 2);
+        // The samples of plain runs are indicators, whose interval is the Wilson interval (see RunningStatistics::getInterval)
+        const bool indicators = !simulationOptions.antithetic && simulationOptions.importanceExponent == 1 && !splitting &&
+                                !simulationOptions.quasiMonteCarlo && !conditional;
+        if (sequential && (simulationOptions.batchRuns <= 0 || !(z > 0 && z < INFINITY))) {
+            guic->addError("The confidence level has to be in (0,1) and the batch size has to be positive.");
+            deleteDistributions(distributions);
+            return false;
+        }
+        if (!(simulationOptions.importanceExponent > 0 && simulationOptions.importanceExponent < 2)) {
+            // For alpha >= 2 the likelihood ratio has an infinite variance
+            guic->addError("The importance sampling exponent has to be in (0,2).");
+            deleteDistributions(distributions);
+            return false;
         }
 
-        // Create the initial marking
-        Marking* initialMarking = createInitialMarking(model);
+        if (splitting && (simulationOptions.splittingEffort <= 0 || simulationOptions.antithetic || simulationOptions.commonRandomNumbers ||
+                          simulationOptions.importanceExponent != 1 || simulationOptions.quasiMonteCarlo)) {
+            // The levels depend on the constant, and the other techniques would change the runs of the stages
+            guic->addError("Splitting needs a positive number of runs per level and cannot be combined with other variance reduction.");
+            deleteDistributions(distributions);
+            return false;
+        }
+        if (conditional && (simulationOptions.antithetic || simulationOptions.importanceExponent != 1 || simulationOptions.quasiMonteCarlo || splitting)) {
+            guic->addError("Conditional Monte Carlo cannot be combined with other variance reduction.");
+            deleteDistributions(distributions);
+            return false;
+        }
 
-        // Clear the current list of markings, for memory leak countering
-        clearAllocatedMarkings();
+        int trajectorySets = runPerFluidPlaceMinimum ? fluidPlaceMinimumConstants.size() : 1;
+
+        // Quasi-Monte Carlo: the points of a Sobol sequence of the dimension of the general transitions, with a random
+        // digital shift for every replicate of every trajectory set
+        const int groups = simulationOptions.quasiMonteCarlo ? simulationOptions.replicates : 1;
+        SobolSequence sobol;
+        std::vector<uint32_t> shifts;
+        if (simulationOptions.quasiMonteCarlo) {
+            if (groups < 2 || !sobol.setDimension(std::max(1, model->N_generalTransitions))) {
+                guic->addError(QString("Quasi-Monte Carlo needs at least 2 replicates and at most %1 general transitions.").arg(SobolSequence::MAX_DIMENSION).toStdString());
+                deleteDistributions(distributions);
+                return false;
+            }
+            for (int group = 0; group < trajectorySets * groups; group++) {
+                RandomStream random(seed, group);
+                for (int k = 0; k < model->N_generalTransitions; k++) {
+                    shifts.push_back((uint32_t) (random.nextUniform() * 4294967296.0));
+                }
+            }
+        }
 
-        // Set up the STD
-        TimedDiagram::getInstance()->setModel(model);
-        TimedDiagram::getInstance()->generateDiagram(initialMarking);
-        ModelChecker *modelChecker = new ModelChecker(model, TimedDiagram::getInstance(), guic);
+        // The intervals of quasi-Monte Carlo rest on the means of the few replicates, so they take the quantile of Student's
+        // t distribution with replicates - 1 degrees of freedom instead of the normal one
+        const double quantile = groups > 1 ? studentQuantile(0.5 + simulationOptions.confidenceLevel / 2, groups - 1) : z;
+
+        std::vector<long long> setSamples(trajectorySets, 0);
+        std::vector<int> setHorizons(trajectorySets, simulationTimes.size());
+        std::vector<std::vector<RunningStatistics> > groupStatistics(simulationTimes.size(), std::vector<RunningStatistics>(fluidPlaceMinimumConstants.size() * groups));
+
+        // Conditional Monte Carlo computes the samples on this thread; it changes the model until it is deleted
+        ConditionalEstimator *conditionalEstimator = NULL;
+        long long maximumSamples = samplesPerSet;
+        bool exact = false;
+        if (conditional) {
+            conditionalEstimator = new ConditionalEstimator(model, guic, simulationTimes, fluidPlaceMinimumConstants, fluidPlaceIndex,
+                                                            samplesPerSet, seed, distributions);
+            if (!conditionalEstimator->prepare()) {
+                delete conditionalEstimator;
+                deleteDistributions(distributions);
+                return false;
+            }
+            exact = conditionalEstimator->exact();
+            if (exact) maximumSamples = 1;
+        }
 
-        // Check if setting the variables works correctly
-        if (!modelChecker->setVariables()) {
-            // Clean-up code
-            delete modelChecker;
-            freeMarking(initialMarking);
-            return false;
+        // One worker per thread, which keeps its simulator over all rounds
+        Marking* initialMarking = conditional ? NULL : createInitialMarking(model);
+        std::vector<DESChunk> chunks;
+        int nextChunk;
+        QMutex chunkMutex;
+        int threads = simulationOptions.threads > 0 ? simulationOptions.threads : QThread::idealThreadCount();
+        if (threads < 1) threads = 1;
+        if (conditional) threads = 0;
+        std::vector<DESWorker *> workers;
+        for (int thread = 0; thread < threads; thread++) {
+            workers.push_back(new DESWorker(model, initialMarking, simulationTimes, fluidPlaceMinimumConstants, fluidPlaceIndex,
+                                            samplesPerSet, simulationOptions, seed, simulationOptions.quasiMonteCarlo ? &sobol : NULL, shifts, groups,
+                                            distributions, chunks, nextChunk, chunkMutex));
         }
+        QThreadPool pool;
+        pool.setMaxThreadCount(threads);
 
         // Store the starting time
         timeval timeStart;
         gettimeofday(&timeStart, NULL);
 
-        // Calculate the probability for each step in the graph
-        for (double simulationTime = simulationTimeMin; simulationTime <= simulationTimeMax + .01; simulationTime += simulationTimeStep) {
-            // The probabilities to calculate
-            double* probabilities = new double[fluidPlaceMinimumStepCount];
-
-            // More simulation
-            int fluidPlaceRun = 0;
-            for(double fluidPlaceMinimumConstant = fluidPlaceMinimumStart; fluidPlaceMinimumConstant <= fluidPlaceMinimumEnd + .01; fluidPlaceMinimumConstant += fluidPlaceMinimumStep) {
-                // Calculate the probability for a number of times
-                for (int run = 0; run < runsPerStep; run++) {
-                    // Loop over all general transitions and pick them a random value
-                    if(isDES) for (int generalTransitionIndex = 0; generalTransitionIndex < generalTransitionCount; generalTransitionIndex++) {
-                        // Read a random unsigned long from the handle
-                        unsigned long x;
-                        if(fread(&x, sizeof(x), 1, randomDataFileHandle) != 1) {
-                            guic->addText("Failed to read (enough) random data from file: " + randomDataFile);
-                            delete modelChecker;
-                            freeMarking(initialMarking);
-                            delete generalTransitions;
-                            fclose(randomDataFileHandle);
-                            return false;
-                        }
-
-                        // Calculate a uniform distrubuted double value
-                        double randomValue = (double) x / ULONG_MAX;
-
-                        // Apply the correct distribution
-                        randomValue = modelChecker->calculateDistributionValue(generalTransitions[generalTransitionIndex].df_distr, generalTransitions[generalTransitionIndex].df_argument, randomValue);
+        bool failed = false;
+        while (!failed) {
+            // Divide the next samples of the unfinished trajectory sets into chunks
+            chunks.clear();
+            for (int set = 0; set < trajectorySets; set++) {
+                if (setHorizons[set] == 0) continue;
+                long long lastSample = std::min(setSamples[set] + roundSamples, maximumSamples);
+                for (long long firstSample = setSamples[set]; firstSample < lastSample; firstSample += chunkSamples) {
+                    DESChunk chunk;
+                    chunk.trajectorySet = set;
+                    chunk.firstSample = firstSample;
+                    chunk.lastSample = std::min(firstSample + chunkSamples, lastSample);
+                    chunk.horizon = setHorizons[set];
+                    chunks.push_back(chunk);
+                }
+                setSamples[set] = lastSample;
+            }
+            if (chunks.empty()) break;
 
-                        // Check the generated value
-                        if(randomValue < 0) {
-                            guic->addError("Failed to generate a valid value for general transition.");
-                            delete modelChecker;
-                            freeMarking(initialMarking);
-                            delete generalTransitions;
-                            fclose(randomDataFileHandle);
-                            return false;
-                        }
+            nextChunk = 0;
+            for (int thread = 0; thread < threads; thread++) {
+                pool.start(workers[thread]);
+            }
+            pool.waitForDone();
+            for (unsigned int c = 0; conditional && !failed && c < chunks.size(); c++) {
+                failed = !conditionalEstimator->simulateChunk(chunks[c]);
+            }
 
-                        // Save the value to the model
-                        if(generalTransitionIndex == 0) {
-                            char randomValueBuffer[255];
-                            sprintf(randomValueBuffer, "%.10f", randomValue);
-                            model->transitions[generalTransitions[generalTransitionIndex].index].df_argument = randomValueBuffer;
-                        } else {
-                            model->transitions[generalTransitions[generalTransitionIndex].index].time = randomValue;
-                        }
+            for (int thread = 0; thread < threads; thread++) {
+                failed = failed || workers[thread]->failed;
+            }
+            if (failed) break;
+            for (unsigned int c = 0; c < chunks.size(); c++) {
+                for (int i = 0; i < chunks[c].horizon; i++) {
+                    for (unsigned int j = 0; j < groupStatistics[i].size(); j++) {
+                        groupStatistics[i][j].merge(chunks[c].statistics[i][j]);
                     }
-
-                    // Regenerate the STD
-                    TimedDiagram::getInstance()->clear();
-                    TimedDiagram::getInstance()->generateDiagram(initialMarking);
-                    if(!modelChecker->setVariables()) return false;
-
-                    // Calculate the probabilities using the model methods
-                    if(!runPerFluidPlaceMinimum && fluidPlaceMinimumStep > 0) {
-                        int i = 0;
-                        for(fluidPlaceMinimumConstant = fluidPlaceMinimumStart; fluidPlaceMinimumConstant <= fluidPlaceMinimumEnd + .01; fluidPlaceMinimumConstant += fluidPlaceMinimumStep) {
-                            if(run == 0) probabilities[i] = 0;
-                            probabilities[i] += modelChecker->calcProb(modelChecker->calcAtomContISetAtTime(simulationTime, fluidPlaceIndex, fluidPlaceMinimumConstant), 0.00);
-                            i++;
-                        }
-                    } else {
-                        if(run == 0) probabilities[fluidPlaceRun] = 0;
-                        probabilities[fluidPlaceRun] += modelChecker->calcProb(modelChecker->calcAtomContISetAtTime(simulationTime, fluidPlaceIndex, fluidPlaceMinimumConstant), 0.00);
+                }
+            }
+            if (!sequential) break;
+
+            // Only simulate up to the last time point of which an interval is still too wide; a set that reached the
+            // maximum number of runs is finished
+            for (int set = 0; set < trajectorySets; set++) {
+                unsigned int firstConstant = runPerFluidPlaceMinimum ? set : 0;
+                unsigned int lastConstant = runPerFluidPlaceMinimum ? set + 1 : fluidPlaceMinimumConstants.size();
+                int horizon = 0;
+                for (int i = 0; i < setHorizons[set]; i++) {
+                    for (unsigned int j = firstConstant; j < lastConstant; j++) {
+                        long long samples;
+                        double lower, upper;
+                        pointStatistics(groupStatistics[i], j, groups, samples).getInterval(quantile, samples * runsPerSample, indicators, lower, upper);
+                        if ((upper - lower) / 2 > simulationOptions.halfWidth) horizon = i + 1;
                     }
-
-                    // Free the newly generated markings
-                    freeAllocatedMarkings();
                 }
-                fluidPlaceRun++;
-                if(!runPerFluidPlaceMinimum || fluidPlaceMinimumStep <= 0) break;
+                setHorizons[set] = setSamples[set] < maximumSamples ? horizon : 0;
+            }
+        }
+
+        // Report the errors of the workers
+        for (int thread = 0; thread < threads; thread++) {
+            for (unsigned int i = 0; i < workers[thread]->errors.size(); i++) {
+                guic->addError(workers[thread]->errors[i]);
             }
+            delete workers[thread];
+        }
+
+        // Free the memory used for the simulation and the initial marking, and restore the model
+        delete conditionalEstimator;
+        deleteDistributions(distributions);
+        if (initialMarking != NULL) freeMarking(initialMarking);
+
+        if (failed) {
+            return false;
+        }
+
+        // Calculate and output the averages, and the confidence intervals with the number of runs of every point
+        std::string intervalFileName = outputFileName.substr(0, outputFileName.size() - 4) + "_ci.dat";
+        std::ofstream intervalFile;
+        intervalFile.open(intervalFileName.c_str());
+        intervalFile << "# time constant probability lower upper runs (" << simulationOptions.confidenceLevel * 100 << "% confidence)" << std::endl;
+
+        long long totalRuns = 0;
+        int widePoints = 0;
+        double maxHalfWidth = 0;
+        for (int set = 0; set < trajectorySets; set++) {
+            totalRuns += setSamples[set] * runsPerSample;
+        }
+        for (unsigned int i = 0; i < simulationTimes.size(); i++) {
+            for(unsigned int j = 0; j < fluidPlaceMinimumConstants.size(); j++) {
+                long long samples;
+                RunningStatistics cell = pointStatistics(groupStatistics[i], j, groups, samples);
+                double lower, upper;
+                cell.getInterval(quantile, samples * runsPerSample, indicators, lower, upper);
+                // The exact probabilities of conditional Monte Carlo with one general transition have no interval
+                if (exact) lower = upper = cell.getMean();
+                double halfWidth = (upper - lower) / 2;
+                maxHalfWidth = std::max(maxHalfWidth, halfWidth);
+                if (sequential && halfWidth > simulationOptions.halfWidth) widePoints++;
 
-            // Calculate and output the averages
-            for(int i = 0; i < fluidPlaceMinimumStepCount; i++) {
-                if(i > 0) outputFile << " ";
                 char probabilityBuffer[255];
-                sprintf(probabilityBuffer, "%.10f", probabilities[i] / runsPerStep);
+                if (sampling == ADAPTIVE_STEP) {
+                    // Non-uniform grid: "t p" lines, or one block of "c t p" lines per time point as expected by splot
+                    if (fluidPlaceMinimumStep > 0) {
+                        sprintf(probabilityBuffer, "%g %g %.10f\n", fluidPlaceMinimumConstants[j], simulationTimes[i], cell.getMean());
+                    } else {
+                        sprintf(probabilityBuffer, "%g %.10f\n", simulationTimes[i], cell.getMean());
+                    }
+                } else {
+                    sprintf(probabilityBuffer, j > 0 ? " %.10f" : "%.10f", cell.getMean());
+                }
                 outputFile << (std::string) probabilityBuffer;
+
+                // Enough digits for the tail probabilities of splitting. Only the reported interval is clipped to [0, 1],
+                // the estimate of importance sampling can lie above it
+                sprintf(probabilityBuffer, "%g %g %.15g %.15g %.15g %lld", simulationTimes[i], fluidPlaceMinimumConstants[j], cell.getMean(),
+                        std::max(0.0, lower), std::min(1.0, upper), samples * runsPerSample);
+                intervalFile << (std::string) probabilityBuffer << std::endl;
             }
 
             // Output the calculated probability to the file
-            outputFile << std::endl;
+            if (sampling != ADAPTIVE_STEP || fluidPlaceMinimumStep > 0) outputFile << std::endl;
+        }
+        intervalFile.close();
 
-            // Delete the separate results
-            delete probabilities;
+        guic->addText(QString("DES runs: %1, largest confidence half-width: %2").arg(totalRuns).arg(maxHalfWidth).toStdString());
+        if (widePoints > 0) {
+            guic->addWarning(QString("%1 points did not reach the confidence half-width %2 within %3 runs.").arg(widePoints).arg(simulationOptions.halfWidth).arg(runsPerStep).toStdString());
         }
 
         // Store the ending time
         timeval timeEnd;
         gettimeofday(&timeEnd, NULL);
 
-        // DES de-init
-        if(isDES) {
-            // Delete the general transition data
-            delete generalTransitions;
-
-            // Close random file handle
-            fclose(randomDataFileHandle);
-        }
-
         // Close the output file handle
         outputFile.close();
 
-        // Free the memory used for the initial marking
-        delete modelChecker;
-        freeMarking(initialMarking);
-
         // Run GNUPlot to display the graph
         FILE* gnuplotPipe;
-        if((gnuplotPipe = popen("gnuplot -persist", "w"))) {
+        if(sampling == ADAPTIVE_STEP && (gnuplotPipe = popen("gnuplot -persist", "w"))) {
+            if(fluidPlaceMinimumStep > 0) {
+                fprintf(gnuplotPipe,
+                    "set title 'Place constant 3D-plot DES'\n"
+                    "set pm3d\n"
+                    "unset surface\n"
+                    "set xlabel \"Constant\"\n"
+                    "set ylabel \"Time\"\n"
+                    "set zlabel \"Probability\"\n"
+                    "set palette rgbformulae 33, 13, 10\n"
+                    "splot \"%s\" using 1:2:3 with lines\n", outputFileName.c_str());
+            } else {
+                fprintf(gnuplotPipe,
+                    "set title 'Place constant 2D-plot DES'\n"
+                    "set xlabel \"Time\"\n"
+                    "set ylabel \"Probability\"\n"
+                    "plot \"%s\" using 1:2 title \"probability\" with lp\n", outputFileName.c_str());
+            }
+            fflush(gnuplotPipe);
+            fprintf(gnuplotPipe, "exit\n");
+            fclose(gnuplotPipe);
+        } else if((gnuplotPipe = popen("gnuplot -persist", "w"))) {
             if(fluidPlaceMinimumStep > 0) {
                 fprintf(gnuplotPipe,
-                    "set title 'Place constant 3D-plot%s'\n"
+                    "set title 'Place constant 3D-plot DES'\n"
                     "set pm3d\n"
                     "unset surface\n"
                     "set xlabel \"Constant\"\n"
@@ -699,7 +1555,6 @@ namespace model {
                     "set xtics (\"%.1f\" 0, \"%.1f\" %.1f, \"%.1f\" %.1f, \"%.1f\" %.1f, \"%.1f\" %.1f)\n "
                     "set ytics (\"0\" 0, \"%.1f\" %.1f, \"%.1f\" %.1f, \"%.1f\" %.1f, \"%.1f\" %.1f, \"%.1f\" %.1f)\n"
                     "set palette rgbformulae 33, 13, 10\n",
-                    isDES ? " DES" : "",
                     fluidPlaceMinimumStart,
                     fluidPlaceMinimumStart + (fluidPlaceMinimumEnd - fluidPlaceMinimumStart) * 0.25, ((fluidPlaceMinimumEnd - fluidPlaceMinimumStart) / fluidPlaceMinimumStep) * 0.25,
                     fluidPlaceMinimumStart + (fluidPlaceMinimumEnd - fluidPlaceMinimumStart) * 0.50, ((fluidPlaceMinimumEnd - fluidPlaceMinimumStart) / fluidPlaceMinimumStep) * 0.50,
@@ -713,11 +1568,10 @@ namespace model {
                 );
             } else {
                 fprintf(gnuplotPipe,
-                    "set title 'Place constant 2D-plot%s'\n"
+                    "set title 'Place constant 2D-plot DES'\n"
                     "set xlabel \"Time\"\n"
                     "set ylabel \"Probability\"\n"
                     "set xtics (\"0\" 0, \"%.1f\" %.1f, \"%.1f\" %.1f,\"%.1f\" %.1f, \"%.1f\" %.1f, \"%.1f\" %.1f)\n",
-                    isDES ? " DES" : "",
                     simulationTimeMax * 0.2, simulationTimeMax * 0.2 / simulationTimeStep,
                     simulationTimeMax * 0.4, simulationTimeMax * 0.4 / simulationTimeStep,
                     simulationTimeMax * 0.6, simulationTimeMax * 0.6 / simulationTimeStep,
@@ -739,10 +1593,8 @@ namespace model {
         // Print the total simulation time
         double timeDiffMs = (timeInitDES.tv_sec  - timeInit.tv_sec) * 1000 + (timeInitDES.tv_usec - timeInit.tv_usec) / 1000.0;
         guic->addText(QString("Basic initialisation time: %1 ms").arg(timeDiffMs).toStdString());
-        if(isDES) {
-            timeDiffMs = (timeStart.tv_sec  - timeInitDES.tv_sec) * 1000 + (timeStart.tv_usec - timeInitDES.tv_usec) / 1000.0;
-            guic->addText(QString("DES initialisation time: %1 ms").arg(timeDiffMs).toStdString());
-        }
+        timeDiffMs = (timeStart.tv_sec  - timeInitDES.tv_sec) * 1000 + (timeStart.tv_usec - timeInitDES.tv_usec) / 1000.0;
+        guic->addText(QString("DES initialisation time: %1 ms").arg(timeDiffMs).toStdString());
         timeDiffMs = (timeEnd.tv_sec  - timeStart.tv_sec) * 1000 + (timeEnd.tv_usec - timeStart.tv_usec) / 1000.0;
         guic->addText(QString("Simulation time: %1 ms").arg(timeDiffMs).toStdString());
         timeDiffMs = (timeEnd.tv_sec  - timeInit.tv_sec) * 1000 + (timeEnd.tv_usec - timeInit.tv_usec) / 1000.0;
@@ -845,12 +1697,6 @@ namespace model {
 
         //std::cout << "total time computing measures:  " << mtime_measures << "ms" << std::endl;
 
-        switch (model->transitions[gTransitionId(model)].df_distr)
-        {
-        case Gen: evaluator_destroy(modelChecker->getF());
-            break;
-        }
-
         delete modelChecker;
         freeMarking(initialMarking);
         delete fullFML;
@@ -883,4 +1729,154 @@ namespace model {
         return true;
     }
 
+    /**
+     * @brief Facade::modelCheck Checks several formulas at several times against one STD. All formulas are compiled into
+     * one plan, so the subformulas they share are evaluated once per time, and the atomic formulas of all of them are
+     * evaluated together in one pass over the regions.
+     * @param results Output: whether formula f holds at check time i, at index f * checkTimes.size() + i.
+     * @param probs Output: the probability of the path formula of formula f at check time i, at the same index.
+     * @param rawFormulas The formulas, each of the form PR op p (...).
+     * @param checkTimes The times to check.
+     * @param maxTime The end time of the STD.
+     * @return false if a formula cannot be parsed or evaluated, the error is reported to the logger.
+     */
+    bool Facade::modelCheck(std::vector<bool> &results, std::vector<double> &probs, const QStringList &rawFormulas, const std::vector<double> &checkTimes, double maxTime) {
+        if (!_modelCheck(results, probs, rawFormulas, checkTimes, maxTime)) return false;
+
+        unsigned int k = 0; // index of formula f at check time i in results and probs
+        for (int f = 0; f < rawFormulas.size(); f++) {
+            for (unsigned int i = 0; i < checkTimes.size(); i++, k++) {
+                guic->addText(QString("%1 at time %2: probability %3, %4").arg(rawFormulas[f]).arg(checkTimes[i]).arg(probs[k])
+                              .arg(results[k] ? "satisfied" : "not satisfied").toStdString());
+            }
+        }
+        return true;
+    }
+
+    /**
+     * @brief Facade::showFormulaProbFunc Plots the probability of the path formula of a formula over the check times
+     * 0, tStep, ..., maxCheckTime. The STD is built once and all check times are evaluated with one plan, which keeps the
+     * polygons of an until over the times, so they are created once for the whole sweep instead of once per time.
+     * The curve is written as "t p" lines to ./output/formula_2d.dat.
+     * @param rawFormula The formula, of the form PR op p (...).
+     * @param tStep The step between the check times.
+     * @param maxCheckTime The last check time, before maxTime.
+     * @param maxTime The end time of the STD.
+     */
+    bool Facade::showFormulaProbFunc(QString rawFormula, double tStep, double maxCheckTime, double maxTime) {
+        if (!(tStep > 0) || !(maxCheckTime >= 0) || !(maxCheckTime < maxTime)) {
+            guic->addError("The time step has to be positive and the last time to check has to be before the maximum time.");
+            return false;
+        }
+
+        std::vector<double> checkTimes;
+        for (int i = 0; i * tStep <= maxCheckTime; i++)
+            checkTimes.push_back(i * tStep);
+
+        std::vector<bool> results;
+        std::vector<double> probs;
+        if (!_modelCheck(results, probs, QStringList(rawFormula), checkTimes, maxTime)) return false;
+
+        QString outputFileName("./output/formula_2d.dat");
+        std::ofstream oFile;
+        oFile.open(outputFileName.toStdString().c_str(), std::ios::out);
+        for (unsigned int i = 0; i < checkTimes.size(); i++)
+            oFile << checkTimes[i] << " " << probs[i] << std::endl;
+        oFile.close();
+
+        FILE* gnuplotPipe;
+        if ( (gnuplotPipe = popen("gnuplot -persist","w")) )
+        {
+            fprintf(gnuplotPipe,"set title 'Formula 2d-plot '\n "
+                    "set xlabel \"Time\" \n"
+                    "set ylabel \"Probability\"\n");
+            fflush(gnuplotPipe);
+            fprintf(gnuplotPipe,"plot \"%s\" using 1:2 title \"probability\" with lp \n",outputFileName.toStdString().c_str());
+            fflush(gnuplotPipe);
+            fprintf(gnuplotPipe,"exit \n");
+            fclose(gnuplotPipe);
+        }
+        guic->addText(QString("Number of check times: %1").arg(checkTimes.size()).toStdString());
+        return true;
+    }
+
+    /*
+     * Checks the formulas at the check times as modelCheck, without reporting the results.
+     */
+    bool Facade::_modelCheck(std::vector<bool> &results, std::vector<double> &probs, const QStringList &rawFormulas, const std::vector<double> &checkTimes, double maxTime) {
+        timeval start, end;
+        gettimeofday(&start, NULL);
+
+        if (model == 0) {
+            return false;
+        }
+
+        for (unsigned int i = 0; i < checkTimes.size(); i++) {
+            if (!(checkTimes[i] >= 0)) {
+                guic->addError(QString("The time to check %1 is invalid, please specify a new time.").arg(checkTimes[i]).toStdString());
+                return false;
+            }
+        }
+
+        InitializeModel(model);
+        model->MaxTime = maxTime;
+
+        if (model->N_generalTransitions != 1) {
+            guic->addError("Formulas can only be checked for a model with one general transition.");
+            return false;
+        }
+
+        Marking* initialMarking = createInitialMarking(model);
+        TimedDiagram::getInstance()->setModel(model);
+        TimedDiagram::getInstance()->generateDiagram(initialMarking);
+        gettimeofday(&end, NULL);
+        double mtime_std = (end.tv_sec - start.tv_sec) * 1000 + (end.tv_usec - start.tv_usec) / 1000.0;
+
+        ModelChecker *modelChecker = new ModelChecker(model, TimedDiagram::getInstance(), guic);
+        std::vector<Formula*> formulas;
+        FormulaPlan plan;
+        std::vector<int> roots;
+        bool ok = modelChecker->setVariables();
+
+        for (int f = 0; ok && f < rawFormulas.size(); f++) {
+            Formula *fullFML;
+            ok = modelChecker->parseFML(fullFML, rawFormulas[f]);
+            if (!ok) break;
+            formulas.push_back(fullFML);
+            if (fullFML->getType() != PROB || fullFML->getLeftChild() == 0) {
+                guic->addError(QString("The formula %1 is not a probability formula.").arg(rawFormulas[f]).toStdString());
+                ok = false;
+                break;
+            }
+            roots.push_back(plan.addFormula(fullFML->getLeftChild()));
+        }
+
+        results.assign(formulas.size() * checkTimes.size(), false);
+        probs.assign(formulas.size() * checkTimes.size(), 0);
+        for (unsigned int i = 0; ok && i < checkTimes.size(); i++) {
+            modelChecker->setCheckTime(checkTimes[i]);
+            ok = modelChecker->evaluatePlan(plan);
+            for (unsigned int f = 0; ok && f < formulas.size(); f++) {
+                double prob = modelChecker->calcProb(plan.getCached(roots[f]), 0.00);
+                probs[f * checkTimes.size() + i] = prob;
+                results[f * checkTimes.size() + i] = modelChecker->probSatisfies(prob, (ProbFormula*)formulas[f]);
+            }
+        }
+
+        delete modelChecker;
+        freeMarking(initialMarking);
+        for (unsigned int f = 0; f < formulas.size(); f++)
+            deleteFormula(formulas[f]);
+        if (!ok) return false;
+
+        gettimeofday(&end, NULL);
+        double mtime_full = (end.tv_sec - start.tv_sec) * 1000 + (end.tv_usec - start.tv_usec) / 1000.0;
+        guic->addText(QString("Number of regions: %1").arg(TimedDiagram::getInstance()->getNumberOfRegions()).toStdString());
+        guic->addText(QString("Number of distinct subformulas: %1").arg(plan.getNodeCount()).toStdString());
+        guic->addText(QString("Time to generate STD: %1 ms").arg(mtime_std).toStdString());
+        guic->addText(QString("Total execution time: %1 ms").arg(mtime_full).toStdString());
+
+        return true;
+    }
+
 }
@@ -7,8 +7,10 @@
 #include "Logger.h"
 #include "Formula.h"
 #include "ModelChecker.h"
+#include "Simulator.h"
 
 #include <QString>
+#include <QStringList>
 //#include <QTextEdit>
 #include <cmath>
 #include <iostream>
@@ -20,6 +22,16 @@
 
 namespace model {
 
+/**
+ * @brief The TimeSampling enum selects how the time axis of a probability plot is sampled.
+ * FIXED_STEP samples every time step, ADAPTIVE_STEP samples exactly at the breakpoints of the STD and only refines
+ * in between where the curve is nonlinear (the time step is then the smallest step of the refinement).
+ * PIECEWISE_EXACT does not sample at all, but writes the exact piecewise representation of the curve.
+ * A simulation gives the level at every time point of a run at once, so with ADAPTIVE_STEP it samples the breakpoints
+ * of the STD on top of every time step, and it has no PIECEWISE_EXACT.
+ */
+enum TimeSampling { FIXED_STEP, ADAPTIVE_STEP, PIECEWISE_EXACT };
+
 class Facade
 {
 public:
@@ -32,10 +44,17 @@ public:
     bool virtual setFile(QString rawFileName);
     bool virtual showSTD(QString rawFileName, double maxTime, int imageScale);
     bool virtual showProbFunc(double cStart, double cEnd, double cStep, double tStep, double maxTime);
+    bool virtual showProbFunc(double cStart, double cEnd, double cStep, double tStep, double maxTime, TimeSampling sampling);
     bool virtual showProbFunc(double c, double tStep, double maxTime);
+    bool virtual showProbFunc(double c, double tStep, double maxTime, TimeSampling sampling);
     bool virtual showDESProbFunc(double cStart, double cEnd, double cStep, int runsPerStep, double tStep, double maxTime);
+    bool virtual showDESProbFunc(double cStart, double cEnd, double cStep, int runsPerStep, double tStep, double maxTime, TimeSampling sampling);
     bool virtual showDESProbFunc(double c, int runsPerStep, double tStep, double maxTime);
+    bool virtual showDESProbFunc(double c, int runsPerStep, double tStep, double maxTime, TimeSampling sampling);
+    void virtual setSimulationOptions(const SimulationOptions &options);
     bool virtual modelCheck(bool &res, QString rawFormula, QString rawCheckTime, double maxTime);
+    bool virtual modelCheck(std::vector<bool> &results, std::vector<double> &probs, const QStringList &rawFormulas, const std::vector<double> &checkTimes, double maxTime);
+    bool virtual showFormulaProbFunc(QString rawFormula, double tStep, double maxCheckTime, double maxTime);
 //    bool virtual tempUntilModelCheck();
 
     Model *model;
@@ -44,8 +63,13 @@ public:
     Logger *guic;
 
 private:
+    SimulationOptions simulationOptions;
+
     const char* QString2Char(QString rawQString);
-    bool _showDESProbFunc(double cStart, double cEnd, double cStep, int runsPerStep, double tStep, double maxTime);
+    bool writeExactProbCurve(std::ostream &out, ModelChecker *modelChecker, int pIndex, double amount);
+    bool _showDESProbFunc(double cStart, double cEnd, double cStep, int runsPerStep, double tStep, double maxTime, TimeSampling sampling);
+    bool _showIntegratedProbFunc(double cStart, double cEnd, double cStep, double tStep, double maxTime);
+    bool _modelCheck(std::vector<bool> &results, std::vector<double> &probs, const QStringList &rawFormulas, const std::vector<double> &checkTimes, double maxTime);
 };
 
 }
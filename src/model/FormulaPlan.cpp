@@ -0,0 +1,137 @@
+/**
+ * @file FormulaPlan.cpp
+ * @brief The evaluation plan of an STL formula, in which identical subformulas are shared.
+ */
+
+#include "FormulaPlan.h"
+
+#include <math.h>
+
+namespace model {
+
+bool FormulaPlan::NodeKey::operator<(const NodeKey &other) const {
+    if (type != other.type) return type < other.type;
+    if (left != other.left) return left < other.left;
+    if (right != other.right) return right < other.right;
+    if (value1 != other.value1) return value1 < other.value1;
+    if (value2 != other.value2) return value2 < other.value2;
+    if (identity != other.identity) return identity < other.identity;
+    return placeName < other.placeName;
+}
+
+FormulaPlan::FormulaPlan() {
+    checkTime = NAN;
+    root = -1;
+}
+
+FormulaPlan::FormulaPlan(Formula *formula) {
+    checkTime = NAN;
+    root = -1;
+    addFormula(formula);
+}
+
+FormulaPlan::~FormulaPlan() {
+    clearCache();
+    clearUntilCaches();
+}
+
+/*
+ * Adds the nodes of the formula in post-order and returns the node of the formula itself, which is an existing node
+ * if the same structure was compiled before.
+ */
+int FormulaPlan::compile(Formula *formula) {
+    if (formula == NULL) return -1;
+
+    NodeKey key;
+    key.type = formula->getType();
+    key.left = compile(formula->getLeftChild());
+    key.right = compile(formula->getRightChild());
+    key.value1 = 0;
+    key.value2 = 0;
+    key.identity = NULL;
+
+    switch (key.type) {
+    case DISCRETE:
+        key.placeName = ((AtomDisFormula *) formula)->getPlaceName();
+        key.value1 = ((AtomDisFormula *) formula)->getN();
+        atoms.push_back(formula);
+        break;
+    case CONTINUOUS:
+        key.placeName = ((AtomContFormula *) formula)->getPlaceName();
+        key.value1 = ((AtomContFormula *) formula)->getC();
+        atoms.push_back(formula);
+        break;
+    case UNTIL:
+        key.value1 = ((UntilFormula *) formula)->getBound().start;
+        key.value2 = ((UntilFormula *) formula)->getBound().end;
+        break;
+    case TT:
+    case AND:
+    case NEG:
+        break;
+    default:
+        key.identity = formula;
+        break;
+    }
+
+    std::map<NodeKey, int>::iterator it = nodeIndex.find(key);
+    if (it != nodeIndex.end()) return it->second;
+
+    PlanNode node;
+    node.type = key.type;
+    node.left = key.left;
+    node.right = key.right;
+    node.formula = formula;
+    node.needed = false;
+    node.formulaRoot = false;
+    nodes.push_back(node);
+    nodeIndex[key] = nodes.size() - 1;
+    return nodes.size() - 1;
+}
+
+int FormulaPlan::addFormula(Formula *formula) {
+    root = compile(formula);
+    cache.resize(nodes.size(), (IntervalSet *) NULL);
+    untilCaches.resize(nodes.size(), (UntilCache *) NULL);
+
+    // The children of an until are clipped as polygons, their satisfaction sets are not needed for it
+    if (root != -1) nodes[root].needed = nodes[root].formulaRoot = true;
+    for (int node = root; node >= 0; node--) {
+        if (!nodes[node].needed || nodes[node].type == UNTIL) continue;
+        if (nodes[node].left != -1) nodes[nodes[node].left].needed = true;
+        if (nodes[node].right != -1) nodes[nodes[node].right].needed = true;
+    }
+    return root;
+}
+
+void FormulaPlan::setCheckTime(double time) {
+    if (time == checkTime) return;
+    clearCache();
+    checkTime = time;
+}
+
+void FormulaPlan::setCached(int node, IntervalSet *iSet) {
+    delete cache[node];
+    cache[node] = iSet;
+}
+
+void FormulaPlan::clearCache() {
+    for (unsigned int node = 0; node < cache.size(); node++) {
+        delete cache[node];
+        cache[node] = NULL;
+    }
+}
+
+UntilCache *FormulaPlan::getUntilCache(int node) {
+    if (untilCaches[node] == NULL) untilCaches[node] = new UntilCache();
+    return untilCaches[node];
+}
+
+void FormulaPlan::clearUntilCaches() {
+    for (unsigned int node = 0; node < untilCaches.size(); node++) {
+        delete untilCaches[node];
+        untilCaches[node] = NULL;
+    }
+}
+
+}
@@ -0,0 +1,122 @@
+/**
+ * @file FormulaPlan.h
+ * @brief The evaluation plan of an STL formula, in which identical subformulas are shared.
+ */
+
+#ifndef FORMULAPLAN_H
+#define FORMULAPLAN_H
+
+#include "Formula.h"
+#include "IntervalSet.h"
+#include "UntilTraversal.h"
+
+#include <map>
+#include <string>
+#include <vector>
+
+namespace model {
+
+/**
+ * @brief The FormulaPlan class compiles the AST of one or more formulas into a DAG of nodes, in which structurally
+ * identical subformulas are one node (hash-consing). The nodes are stored in post-order, so the children of a node always come
+ * before it, and every node has a slot for its satisfaction set at the current check time. Evaluating the nodes in
+ * order therefore computes every subformula exactly once, in time linear in the size of the formula.
+ *
+ * The plan refers to the formulas of the AST, which have to outlive it. It owns the cached interval sets, and the caches
+ * of its untils, which do not depend on the check time but on the STD.
+ */
+class FormulaPlan
+{
+public:
+    /**
+     * @brief The PlanNode struct is one distinct subformula. The children are node indices, -1 if absent.
+     */
+    struct PlanNode {
+        Formula_type type;
+        int left, right;
+        Formula *formula; // the first formula of the AST with this structure
+        bool needed; // whether the satisfaction set of the node is needed for that of the root
+        bool formulaRoot; // whether the node is that of an added formula, whose satisfaction set is read from the cache
+    };
+
+    FormulaPlan();
+    FormulaPlan(Formula *formula);
+    virtual ~FormulaPlan();
+
+    /**
+     * @brief addFormula Adds another formula to the plan, sharing the subformulas it has in common with the formulas
+     * added before. Its satisfaction set is then cached at the returned node when the plan is evaluated.
+     * @return The node of the formula, -1 for no formula.
+     */
+    int addFormula(Formula *formula);
+
+    /**
+     * @brief getRoot The node of the formula of the constructor, or of the last added formula.
+     */
+    int getRoot() const { return root; }
+    int getNodeCount() const { return nodes.size(); }
+    const PlanNode &getNode(int node) const { return nodes[node]; }
+
+    /**
+     * @brief getAtoms All atomic formulas of the ASTs, also those that share a node with another one. The operands of an
+     * until are read from the AST, so their place indices have to be set on every copy.
+     */
+    const std::vector<Formula *> &getAtoms() const { return atoms; }
+
+    /**
+     * @brief setCheckTime Drops the cached satisfaction sets if they belong to another check time.
+     */
+    void setCheckTime(double time);
+
+    /**
+     * @brief getCached The cached satisfaction set of a node, NULL if it has not been evaluated at the check time.
+     */
+    IntervalSet *getCached(int node) const { return cache[node]; }
+
+    /**
+     * @brief setCached Caches the satisfaction set of a node, the plan takes ownership of it.
+     */
+    void setCached(int node, IntervalSet *iSet);
+
+    void clearCache();
+
+    /**
+     * @brief getUntilCache The cache of an until node, kept over all check times. It belongs to the STD the plan is
+     * evaluated on, see clearUntilCaches.
+     */
+    UntilCache *getUntilCache(int node);
+
+    /**
+     * @brief clearUntilCaches Drops the caches of the untils, which has to be done when the STD changes.
+     */
+    void clearUntilCaches();
+
+private:
+    /*
+     * The structure of a node: its type, its children and the parameters of an atomic formula or an until.
+     * Formulas the plan does not know are never shared, they are identified by their address.
+     */
+    struct NodeKey {
+        Formula_type type;
+        int left, right;
+        std::string placeName;
+        double value1, value2;
+        const Formula *identity;
+
+        bool operator<(const NodeKey &other) const;
+    };
+
+    std::vector<PlanNode> nodes;
+    std::vector<Formula *> atoms;
+    std::map<NodeKey, int> nodeIndex;
+    std::vector<IntervalSet *> cache;
+    std::vector<UntilCache *> untilCaches;
+    double checkTime;
+    int root;
+
+    int compile(Formula *formula);
+};
+
+}
+
+#endif // FORMULAPLAN_H
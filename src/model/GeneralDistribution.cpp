@@ -0,0 +1,321 @@
+/**
+ * @file GeneralDistribution.cpp
+ * @brief The distribution of a general transition, created once from its df_distr and df_argument.
+ */
+
+#include "GeneralDistribution.h"
+
+#include <QString>
+#include <string.h>
+#include <stdlib.h>
+#include <algorithm>
+
+namespace model {
+
+namespace {
+
+/*
+ * Splits an argument of the form "x,y".
+ */
+bool parseTwoArguments(const char *argument, double &x, double &y) {
+    std::vector<char> copy(argument, argument + strlen(argument) + 1);
+    char *argFinder = strtok(&copy[0], ",");
+    if (argFinder == NULL)
+        return false;
+    x = atof(argFinder);
+    argFinder = strtok(NULL, ",");
+    if (argFinder == NULL)
+        return false;
+    y = atof(argFinder);
+    return true;
+}
+
+void reportInvalidArgument(Model *model, int transition, Logger *guic, const char *reason) {
+    guic->addError(QString("Transition #%1 : %2 has an invalid cumulative distribution function (cdf) for %3").arg(transition+1).arg(model->transitions[transition].id).arg(reason).toStdString());
+}
+
+}
+
+GeneralDistribution *GeneralDistribution::create(Model *model, int transition, Logger *guic) {
+    const char *argument = model->transitions[transition].df_argument;
+
+    switch (model->transitions[transition].df_distr)
+    {
+    case Exp: {
+        TypedDistribution<ExpPolicy> *distribution = new TypedDistribution<ExpPolicy>();
+        distribution->getPolicy().lambda = atof(argument);
+        return distribution;
+    }
+    case Uni: {
+        TypedDistribution<UniPolicy> *distribution = new TypedDistribution<UniPolicy>();
+        if (!parseTwoArguments(argument, distribution->getPolicy().a, distribution->getPolicy().b)) {
+            reportInvalidArgument(model, transition, guic, "uni{a,b}, since this requires two arguments.");
+            delete distribution;
+            return NULL;
+        }
+        return distribution;
+    }
+    case Gen: {
+        TypedDistribution<GenPolicy> *distribution = new TypedDistribution<GenPolicy>();
+        std::vector<char> copy(argument, argument + strlen(argument) + 1);
+        distribution->getPolicy().f = evaluator_create(&copy[0]);
+        if (distribution->getPolicy().f == NULL) {
+            reportInvalidArgument(model, transition, guic, "gen{f(s)}, since f(s) could not be parsed.");
+            delete distribution;
+            return NULL;
+        }
+        // Compile once; if the expression is outside the supported grammar libmatheval is used instead.
+        distribution->getPolicy().compiled.compile(argument);
+        return distribution;
+    }
+    case Gamma: {
+        TypedDistribution<GammaPolicy> *distribution = new TypedDistribution<GammaPolicy>();
+        double K, lambda;
+        if (!parseTwoArguments(argument, K, lambda)) {
+            reportInvalidArgument(model, transition, guic, "gamma{K,lambda}, since this requires two arguments.");
+            delete distribution;
+            return NULL;
+        }
+        if (!distribution->getPolicy().gamma.setParameters(K, lambda)) {
+            reportInvalidArgument(model, transition, guic, "gamma{K,lambda}, since K and lambda have to be positive.");
+            delete distribution;
+            return NULL;
+        }
+        return distribution;
+    }
+    case Norm: {
+        TypedDistribution<NormalPolicy> *distribution = new TypedDistribution<NormalPolicy>();
+        if (!parseTwoArguments(argument, distribution->getPolicy().mu, distribution->getPolicy().sigma)) {
+            reportInvalidArgument(model, transition, guic, "norm{mu,sigma}, since this requires two arguments.");
+            delete distribution;
+            return NULL;
+        }
+        return distribution;
+    }
+    case FoldedNorm: {
+        TypedDistribution<FoldedNormalPolicy> *distribution = new TypedDistribution<FoldedNormalPolicy>();
+        if (!parseTwoArguments(argument, distribution->getPolicy().mu, distribution->getPolicy().sigma)) {
+            reportInvalidArgument(model, transition, guic, "foldednorm{mu,sigma}, since this requires two arguments.");
+            delete distribution;
+            return NULL;
+        }
+        return distribution;
+    }
+    case Dtrm: {
+        TypedDistribution<DtrmPolicy> *distribution = new TypedDistribution<DtrmPolicy>();
+        distribution->getPolicy().dtrm = atof(argument);
+        return distribution;
+    }
+    }
+
+    guic->addError(QString("Transition #%1 : %2 has an unknown cumulative distribution function (cdf).").arg(transition+1).arg(model->transitions[transition].id).toStdString());
+    return NULL;
+}
+
+/*
+ * The general cumulative distribution function defined by the user.
+ * The math library supports the following functionalities:
+ *
+ * -> e (e), log2(e) (log2e), log10(e) (log10e), ln(2) (ln2), ln(10) (ln10), pi (pi),
+ * pi / 2 (pi_2), pi / 4 (pi_4), 1 / pi (1_pi), 2 / pi (2_pi), 2 / sqrt(pi) (2_sqrtpi),
+ * sqrt(2) (sqrt) and sqrt(1 / 2) (sqrt1_2).
+ * -> exponential (exp), logarithmic (log), square root (sqrt), sine (sin), cosine (cos),
+ * tangent (tan), cotangent (cot), secant (sec), cosecant (csc), inverse sine (asin),
+ * inverse cosine (acos), inverse tangent (atan), inverse cotangent (acot),
+ * inverse secant (asec), inverse cosecant (acsc), hyperbolic sine (sinh),
+ * cosine (cosh), hyperbolic tangent (tanh), hyperbolic cotangent (coth),
+ * hyperbolic secant (sech), hyperbolic cosecant (csch), hyperbolic inverse sine (asinh),
+ * hyperbolic inverse cosine (acosh), hyperbolic inverse tangent (atanh),
+ * hyperbolic inverse cotangent (acoth), hyperbolic inverse secant (asech),
+ * hyperbolic inverse cosecant (acsch), absolute value (abs),
+ * Heaviside step function (step) with value 1 defined for x = 0,
+ * Dirac delta function with infinity (delta) and not-a-number (nandelta)
+ * values defined for x = 0, and error function (erf).
+ * -> unary minus ('-'),addition ('+'), subtraction ('+'), multiplication ('*'),
+ * division multiplication ('/') and exponentiation ('^')
+ * -> Parenthesis ('(' and ')') could be used to change priority order
+ *
+ * For more details visit: http://www.gnu.org/software/libmatheval/manual/libmatheval.html
+ */
+double GenPolicy::cdf(double s) const {
+    if (s == INFINITY)
+        return 1;
+    if (compiled.isCompiled())
+        return compiled.evaluate(s);
+
+    char *names[] = { (char *)"s" };
+    double values[] = { s };
+
+    return evaluator_evaluate(f, sizeof(names)/sizeof(names[0]), names, values);
+}
+
+void GenPolicy::cdf(const double *s, double *res, int n) const {
+    if (!compiled.isCompiled()) {
+        for (int i = 0; i < n; i++)
+            res[i] = cdf(s[i]);
+        return;
+    }
+
+    compiled.evaluate(s, res, n);
+    for (int i = 0; i < n; i++) {
+        if (s[i] == INFINITY) res[i] = 1;
+    }
+}
+
+template <>
+void TypedDistribution<GenPolicy>::cdfDiffs(const double *lo, const double *hi, double *res, int n) const {
+    if (n == 0)
+        return;
+    std::vector<double> fLo(n);
+    policy.cdf(lo, &fLo[0], n);
+    policy.cdf(hi, res, n);
+    for (int i = 0; i < n; i++)
+        res[i] -= fLo[i];
+}
+
+template <>
+double TypedDistribution<GenPolicy>::calcProb(const IntervalSet *iSet, double shift) const {
+    int n = iSet->intervals.size();
+    if (n == 0)
+        return 0;
+
+    std::vector<double> lo(n), hi(n), diff(n);
+    for (int i = 0; i < n; i++) {
+        lo[i] = iSet->intervals[i].start - shift;
+        hi[i] = iSet->intervals[i].end - shift;
+    }
+    cdfDiffs(&lo[0], &hi[0], &diff[0], n);
+    return neumaierSum(&diff[0], n);
+}
+
+template <>
+bool TypedDistribution<GenPolicy>::prepareQuantile() {
+    return policy.tabulateQuantile();
+}
+
+template <>
+double TypedDistribution<GenPolicy>::quantileCdf(double s) const {
+    return policy.quantileCdf(s);
+}
+
+/*
+ * F(s) = P(|X| <= s) for X normal(mu, sigma) lies between 2 Phi((s - |mu|) / sigma) - 1 and Phi((s - |mu|) / sigma),
+ * so the quantile lies between |mu| + sigma z(u) and |mu| + sigma z((1 + u) / 2). In this bracket Newton's method is
+ * safeguarded by bisection.
+ */
+double FoldedNormalPolicy::quantile(double u) const {
+    if (!(u > 0))
+        return 0;
+    if (u >= 1)
+        return INFINITY;
+
+    double lo = std::max(0.0, fabs(mu) + sigma * normalQuantile(u));
+    double hi = fabs(mu) + sigma * normalQuantile((1 + u) / 2);
+    // For mu = 0 the upper bound is exact, for a large mu / sigma the lower one
+    double s = (fabs(mu) > sigma && lo > 0) ? lo : hi;
+    const double scale = 1 / (sqrt(2.0) * sigma);
+    for (int i = 0; i < 100; i++) {
+        // F(s) by erfc, which unlike erf is accurate where F is small
+        double f = .5 * (erfc((fabs(mu) - s) * scale) - erfc((s + fabs(mu)) * scale)) - u;
+        if (f < 0) lo = s; else hi = s;
+
+        double zMinus = (s - mu) / sigma;
+        double zPlus = (s + mu) / sigma;
+        double density = (exp(-.5 * zMinus * zMinus) + exp(-.5 * zPlus * zPlus)) / (sigma * sqrt(2 * M_PI));
+        double next = s - f / density;
+        if (fabs(next - s) <= 1e-12 * s)
+            return next;
+        if (!(next > lo && next < hi))
+            next = .5 * (lo + hi);
+        if (hi - lo <= 1e-12 * hi)
+            return next;
+        s = next;
+    }
+    return s;
+}
+
+double GenPolicy::quantile(double u) const {
+    if (u < 1 - 1.0 / QUANTILE_CELLS) {
+        double x = std::max(0.0, u * QUANTILE_CELLS);
+        int i = (int)x;
+        return bodyQuantiles[i] + (x - i) * (bodyQuantiles[i + 1] - bodyQuantiles[i]);
+    }
+
+    double x = (u < 1) ? -log2((1 - u) * QUANTILE_CELLS) : QUANTILE_TAIL_STEPS;
+    int j = std::max(0, (int)x);
+    if (j >= QUANTILE_TAIL_STEPS)
+        return tailQuantiles[QUANTILE_TAIL_STEPS];
+    if (tailQuantiles[j + 1] == INFINITY)
+        return INFINITY;
+    return tailQuantiles[j] + (x - j) * (tailQuantiles[j + 1] - tailQuantiles[j]);
+}
+
+/*
+ * Inverts the interpolation of quantile: linear in u in the body, and linear in -log2((1 - u) * QUANTILE_CELLS) in the
+ * tail. Where the tail becomes INFINITY the rest of the probability is never reached.
+ */
+double GenPolicy::quantileCdf(double s) const {
+    if (s < bodyQuantiles[0])
+        return 0;
+    if (s < bodyQuantiles[QUANTILE_CELLS - 1]) {
+        int i = std::upper_bound(bodyQuantiles.begin(), bodyQuantiles.end(), s) - bodyQuantiles.begin() - 1;
+        return (i + (s - bodyQuantiles[i]) / (bodyQuantiles[i + 1] - bodyQuantiles[i])) / QUANTILE_CELLS;
+    }
+    if (s < tailQuantiles[0])
+        return 1 - 1.0 / QUANTILE_CELLS;
+
+    int j = std::upper_bound(tailQuantiles.begin(), tailQuantiles.end(), s) - tailQuantiles.begin() - 1;
+    if (j >= QUANTILE_TAIL_STEPS)
+        return 1;
+    if (tailQuantiles[j + 1] == INFINITY)
+        return 1 - ldexp(1.0, -j) / QUANTILE_CELLS;
+    double x = j + (s - tailQuantiles[j]) / (tailQuantiles[j + 1] - tailQuantiles[j]);
+    return 1 - pow(2.0, -x) / QUANTILE_CELLS;
+}
+
+/*
+ * The smallest s in [lo, hi] with F(s) >= u, by bisection; F(hi) >= u and F(s) < u below lo.
+ */
+double GenPolicy::invert(double u, double lo, double hi) const {
+    for (int i = 0; i < 200 && hi - lo > 1e-12 * std::max(1.0, hi); i++) {
+        double mid = .5 * (lo + hi);
+        if (cdf(mid) >= u)
+            hi = mid;
+        else
+            lo = mid;
+    }
+    return hi;
+}
+
+/*
+ * Tabulates the quantile, assuming f is a cdf on [0, INFINITY). The body has to end before MAX_DELAY; a tail point
+ * beyond it is INFINITY, i.e. the transition does not fire.
+ */
+bool GenPolicy::tabulateQuantile() {
+    const double MAX_DELAY = 1e15;
+
+    double hi = 1;
+    while (!(cdf(hi) >= 1 - 1.0 / QUANTILE_CELLS)) {
+        hi *= 2;
+        if (hi > MAX_DELAY)
+            return false;
+    }
+
+    double lo = 0;
+    bodyQuantiles.resize(QUANTILE_CELLS);
+    bodyQuantiles[0] = 0;
+    for (int i = 1; i < QUANTILE_CELLS; i++) {
+        lo = bodyQuantiles[i] = invert((double)i / QUANTILE_CELLS, lo, hi);
+    }
+
+    tailQuantiles.resize(QUANTILE_TAIL_STEPS + 1);
+    for (int j = 0; j <= QUANTILE_TAIL_STEPS; j++) {
+        double u = 1 - ldexp(1.0, -j) / QUANTILE_CELLS;
+        while (!(cdf(hi) >= u) && hi <= MAX_DELAY)
+            hi *= 2;
+        lo = tailQuantiles[j] = (cdf(hi) >= u) ? invert(u, lo, hi) : INFINITY;
+    }
+    return true;
+}
+
+}
@@ -0,0 +1,239 @@
+/**
+ * @file GeneralDistribution.h
+ * @brief The distribution of a general transition, created once from its df_distr and df_argument.
+ */
+
+#ifndef GENERALDISTRIBUTION_H
+#define GENERALDISTRIBUTION_H
+
+#include "DFPN2.h"
+#include "IntervalSet.h"
+#include "Logger.h"
+#include "CdfKernels.h"
+#include "CompiledExpression.h"
+
+#include <math.h>
+#include <vector>
+
+extern "C" {
+#include <matheval.h>
+}
+
+namespace model {
+
+/**
+ * @brief The GeneralDistribution class is the interface of the distribution of one general transition.
+ * The concrete distributions are the TypedDistribution instantiations below, which are created by create().
+ */
+class GeneralDistribution
+{
+public:
+    virtual ~GeneralDistribution() {}
+
+    virtual Distribution getType() const = 0;
+
+    /**
+     * @brief cdf The cumulative distribution function F(s), with F(INFINITY) = 1.
+     */
+    virtual double cdf(double s) const = 0;
+
+    /**
+     * @brief cdfDiffs Calculates res[i] = F(hi[i]) - F(lo[i]) for i < n.
+     */
+    virtual void cdfDiffs(const double *lo, const double *hi, double *res, int n) const = 0;
+
+    /**
+     * @brief calcProb Calculates the probability that the firing time lies in the interval set shifted by -shift,
+     * i.e. the compensated sum of F(end - shift) - F(start - shift) over all intervals.
+     */
+    virtual double calcProb(const IntervalSet *iSet, double shift) const = 0;
+
+    /**
+     * @brief quantile The inverse cdf \f$ F^{-1}(u) = \inf\{s : F(s) \geq u\}\f$, which turns a uniformly
+     * distributed random number into a firing delay. It only reads the distribution, so threads may share it.
+     */
+    virtual double quantile(double u) const = 0;
+
+    /**
+     * @brief quantileCdf The cdf of the delays that quantile draws, \f$ \sup\{u : F^{-1}(u) \leq s\}\f$. It is F
+     * itself where quantile is exact, and for gen{f(s)} the inverse of the tabulated quantile, so unlike cdf it never
+     * evaluates f and threads may share it. It needs prepareQuantile as well.
+     */
+    virtual double quantileCdf(double s) const = 0;
+
+    /**
+     * @brief prepareQuantile Precomputes what quantile needs; it has to be called once before quantile.
+     * @return false if the quantile cannot be computed, e.g. if gen{f(s)} does not approach 1.
+     */
+    virtual bool prepareQuantile() = 0;
+
+    /**
+     * @brief create Parses the distribution of a general transition.
+     * @param model The model.
+     * @param transition The index of the general transition.
+     * @param guic The logger for parse errors.
+     * @return The distribution, owned by the caller, or NULL if the argument is invalid.
+     */
+    static GeneralDistribution *create(Model *model, int transition, Logger *guic);
+};
+
+/*
+ * The distribution policies. Each one provides the cdf and the difference F(hi) - F(lo) as inline functions,
+ * so TypedDistribution compiles them into its loops, and the quantile.
+ */
+
+struct ExpPolicy {
+    static const Distribution type = Exp;
+    double lambda;
+
+    double cdf(double s) const { return s != INFINITY ? (1 - exp(-lambda * s)) : 1; }
+    // exp(-lambda*lo) - exp(-lambda*hi) avoids the cancellation of 1 - exp(.) for small s.
+    double diff(double lo, double hi) const { return exp(-lambda * lo) - exp(-lambda * hi); }
+    double quantile(double u) const { return -log1p(-u) / lambda; }
+};
+
+struct UniPolicy {
+    static const Distribution type = Uni;
+    double a, b;
+
+    double cdf(double s) const {
+        double f = (s - a) * (1 / (b - a));
+        return f < 0 ? 0 : (f > 1 ? 1 : f);
+    }
+    double diff(double lo, double hi) const { return cdf(hi) - cdf(lo); }
+    double quantile(double u) const { return a + (b - a) * u; }
+};
+
+struct NormalPolicy {
+    static const Distribution type = Norm;
+    double mu, sigma;
+
+    double cdf(double s) const { return s != INFINITY ? .5 * (1 + erf((s - mu) / (sqrt(2.0) * sigma))) : 1; }
+    // In the upper tail erf is close to 1, so the difference is taken of erfc instead.
+    double diff(double lo, double hi) const {
+        double scale = 1 / (sqrt(2.0) * sigma);
+        double zLo = (lo - mu) * scale;
+        double zHi = (hi - mu) * scale;
+        return (zLo > 0) ? .5 * (erfc(zLo) - erfc(zHi)) : .5 * (erf(zHi) - erf(zLo));
+    }
+    double quantile(double u) const { return mu + sigma * normalQuantile(u); }
+};
+
+struct FoldedNormalPolicy {
+    static const Distribution type = FoldedNorm;
+    double mu, sigma;
+
+    double cdf(double s) const {
+        return s != INFINITY ? .5 * (erf((s + mu) / (sqrt(2.0) * sigma)) + erf((s - mu) / (sqrt(2.0) * sigma))) : 1;
+    }
+    double diff(double lo, double hi) const {
+        double scale = 1 / (sqrt(2.0) * sigma);
+        return .5 * ((erf((hi + mu) * scale) - erf((lo + mu) * scale)) +
+                     (erf((hi - mu) * scale) - erf((lo - mu) * scale)));
+    }
+    double quantile(double u) const;
+};
+
+struct GammaPolicy {
+    static const Distribution type = Gamma;
+    GammaCdf gamma;
+
+    double cdf(double s) const { return gamma.evaluate(s); }
+    double diff(double lo, double hi) const { return gamma.evaluate(hi) - gamma.evaluate(lo); }
+    double quantile(double u) const { return gamma.quantile(u); }
+};
+
+struct DtrmPolicy {
+    static const Distribution type = Dtrm;
+    double dtrm;
+
+    double cdf(double s) const { return (s < dtrm) ? 0 : 1; }
+    double diff(double lo, double hi) const { return (double)(hi >= dtrm) - (double)(lo >= dtrm); }
+    double quantile(double) const { return dtrm; }
+};
+
+/**
+ * @brief The GenPolicy struct is the user defined cdf gen{f(s)}. The expression is compiled once; if it is outside
+ * the grammar of CompiledExpression, libmatheval evaluates it. The policy owns the libmatheval evaluator.
+ *
+ * The quantile interpolates a table that tabulateQuantile computes by bisection on f. The table has a part uniform in u
+ * and a tail uniform in log(1 - u), so it does not evaluate f (libmatheval is not reentrant) and is accurate in the tail.
+ */
+struct GenPolicy {
+    static const Distribution type = Gen;
+    void *f;
+    CompiledExpression compiled;
+
+    GenPolicy() : f(NULL) {}
+    ~GenPolicy() { if (f != NULL) evaluator_destroy(f); }
+
+    double cdf(double s) const;
+    void cdf(const double *s, double *res, int n) const;
+    double diff(double lo, double hi) const { return cdf(hi) - cdf(lo); }
+    double quantile(double u) const;
+    double quantileCdf(double s) const;
+    bool tabulateQuantile();
+
+private:
+    static const int QUANTILE_CELLS = 4096;
+    static const int QUANTILE_TAIL_STEPS = 40;
+
+    std::vector<double> bodyQuantiles; // F^-1(i / QUANTILE_CELLS) for i < QUANTILE_CELLS
+    std::vector<double> tailQuantiles; // F^-1(1 - 2^-j / QUANTILE_CELLS) for j <= QUANTILE_TAIL_STEPS
+
+    double invert(double u, double lo, double hi) const;
+
+    GenPolicy(const GenPolicy &);
+    GenPolicy &operator=(const GenPolicy &);
+};
+
+/**
+ * @brief The TypedDistribution class implements GeneralDistribution for one policy. Its loops call the inline
+ * functions of the policy directly, so there is no dispatch per interval.
+ */
+template <class Policy>
+class TypedDistribution : public GeneralDistribution
+{
+public:
+    Distribution getType() const { return Policy::type; }
+
+    double cdf(double s) const { return policy.cdf(s); }
+
+    void cdfDiffs(const double *lo, const double *hi, double *res, int n) const {
+        for (int i = 0; i < n; i++)
+            res[i] = policy.diff(lo[i], hi[i]);
+    }
+
+    double calcProb(const IntervalSet *iSet, double shift) const {
+        NeumaierSum sum;
+        for (std::vector<Interval>::const_iterator it = iSet->intervals.begin(); it != iSet->intervals.end(); ++it)
+            sum.add(policy.diff(it->start - shift, it->end - shift));
+        return sum.result();
+    }
+
+    double quantile(double u) const { return policy.quantile(u); }
+    double quantileCdf(double s) const { return policy.cdf(s); }
+    bool prepareQuantile() { return true; }
+
+    Policy &getPolicy() { return policy; }
+    const Policy &getPolicy() const { return policy; }
+
+private:
+    Policy policy;
+};
+
+/*
+ * The compiled gen{f(s)} is evaluated over whole arrays at once, see CompiledExpression::evaluate.
+ */
+template <>
+void TypedDistribution<GenPolicy>::cdfDiffs(const double *lo, const double *hi, double *res, int n) const;
+template <>
+double TypedDistribution<GenPolicy>::calcProb(const IntervalSet *iSet, double shift) const;
+template <>
+bool TypedDistribution<GenPolicy>::prepareQuantile();
+template <>
+double TypedDistribution<GenPolicy>::quantileCdf(double s) const;
+
+}
+
+#endif // GENERALDISTRIBUTION_H
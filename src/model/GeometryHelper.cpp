@@ -7,11 +7,15 @@
 
 #include "GeometryHelper.h"
 
+#include <algorithm>
+#include <math.h>
+
 namespace model {
 
-Polygon* GeometryHelper::reform(Polygon* poly, Interval interval) {
-	return NULL;
-}
+// Times of at most a few thousand are scaled far below the coordinate range of ClipperLib
+const double GeometryHelper::CLIPPER_SCALE = 1e9;
+// A few units of the rounding to integers
+const double GeometryHelper::AREA_PREC = 4e-9;
 
 RegionState GeometryHelper::getTimeAndDirection(DtrmEvent* dtrmRegion,Formula* formula, double& t, Direction& dir) {
 	/*
@@ -67,16 +71,78 @@ RegionState GeometryHelper::getTimeAndDirection(DtrmEvent* dtrmRegion,Formula* f
 		return PART;
 }
 
+IntervalSet* GeometryHelper::getTimeIntervals(DtrmEvent* dtrmRegion, Formula* formula) {
+	Interval regionTimes(dtrmRegion->time, dtrmRegion->nextDtrmEvent->time);
+	IntervalSet* ret = new IntervalSet();
+
+	switch (formula->getType()){
+	case TT:
+		ret->intervals.push_back(regionTimes);
+		break;
+	case DISCRETE:{
+		AtomDisFormula* disFormula = (AtomDisFormula*)formula;
+		if (dtrmRegion->postRegionMarking->tokens[model->places[disFormula->getPlaceIndex()].idInMarking] == disFormula->getN())
+			ret->intervals.push_back(regionTimes);
+		break;
+	}
+	case AND:{
+		IntervalSet* left = getTimeIntervals(dtrmRegion, formula->getLeftChild());
+		IntervalSet* right = getTimeIntervals(dtrmRegion, formula->getRightChild());
+		delete ret;
+		ret = left->intersect(right);
+		delete left;
+		delete right;
+		break;
+	}
+	case NEG:{
+		IntervalSet* holds = getTimeIntervals(dtrmRegion, formula->getLeftChild());
+		ret->intervals.push_back(regionTimes);
+		IntervalSet* notHolds = ret->minus(holds);
+		delete ret;
+		ret = notHolds;
+		delete holds;
+		break;
+	}
+	default:{
+		double t = INF;
+		Direction dir = UP;
+		RegionState state = getTimeAndDirection(dtrmRegion, formula, t, dir);
+		Interval part;
+		if (state == ENTIRE)
+			ret->intervals.push_back(regionTimes);
+		else if (state == PART && Interval(dir == UP ? regionTimes.end : regionTimes.start, t).intersect(regionTimes, part))
+			ret->intervals.push_back(part);
+		break;
+	}
+	}
+	return ret;
+}
+
 void GeometryHelper::drawPolygon(cv::Mat& im, Polygon* poly, const int scale, cv::Scalar color) {
-	for (unsigned int i = 0; i < poly->segments->size(); i++){
-		cv::Point p1(poly->segments->at(i)->p1.X * scale, poly->segments->at(i)->p1.Y * scale);
-		cv::Point p2(poly->segments->at(i)->p2.X * scale, poly->segments->at(i)->p2.Y * scale);
+	for (unsigned int i = 0; i < poly->vertices.size(); i++){
+		const Point &v1 = poly->vertices[i];
+		const Point &v2 = poly->vertices[(i + 1) % poly->vertices.size()];
+		cv::Point p1(v1.X * scale, v1.Y * scale);
+		cv::Point p2(v2.X * scale, v2.Y * scale);
 
 		cv::line(im, p1, p2, color, 1);
 	}
 
 }
 
+void GeometryHelper::drawArea(cv::Mat& im, const ClipperLib::Polygons& area, const int scale, cv::Scalar color) {
+	for (unsigned int i = 0; i < area.size(); i++){
+		for (unsigned int j = 0; j < area[i].size(); j++){
+			const ClipperLib::IntPoint &v1 = area[i][j];
+			const ClipperLib::IntPoint &v2 = area[i][(j + 1) % area[i].size()];
+			cv::Point p1(v1.X / CLIPPER_SCALE * scale, v1.Y / CLIPPER_SCALE * scale);
+			cv::Point p2(v2.X / CLIPPER_SCALE * scale, v2.Y / CLIPPER_SCALE * scale);
+
+			cv::line(im, p1, p2, color, 1);
+		}
+	}
+}
+
 void GeometryHelper::drawVerticalLine(cv::Mat& im, double t, Direction dir, const int scale, cv::Scalar color) {
 	cv::Point p1(t*scale, t*scale);
 	cv::Point p2(model->MaxTime*scale, t*scale);
@@ -134,6 +200,7 @@ Polygon* GeometryHelper::createPolygon(Region* region, Formula* formula) {
 	if (IS_ZERO(d)){
 		if (!IS_ZERO(f1)){
 			propLine.X = (atomConProp->getC() - f0)/f1;
+			propLine.a = INF;
 			Direction upOrDown = (f1 > 0)?UP:DOWN;
 			poly = splitRegion(region, &propLine, upOrDown);
 		}
@@ -155,143 +222,381 @@ Polygon* GeometryHelper::createPolygon(Region* region, Formula* formula) {
 }
 
 Polygon* GeometryHelper::splitRegion(Region* region, Line* line, Direction direction) {
+	Polygon* poly = regionToPoly(region);
+	poly->clip(*line, direction == UP);
+	return poly;
+}
+
+/*
+ * A copy of the outline the region computed when it was created.
+ */
+Polygon* GeometryHelper::regionToPoly(Region* region) {
 	Polygon* poly = new Polygon();
+	poly->vertices = region->outline.vertices;
+	return poly;
+}
+
+/*
+ * Crops the polygon in place, so the result is poly itself, or NULL if nothing is left of it.
+ */
+Polygon* GeometryHelper::cropPolygon(Polygon* poly, double t, Direction dir) {
+	if (poly == NULL || poly->isEmpty()) return NULL;
+
+	Line line(0, t);
+	poly->clip(line, dir == UP);
+	if (poly->isEmpty()) return NULL;
+	return poly;
+}
 
-//	region->print(std::cout);
 
-	for (unsigned int i = 0; i < region->eventSegments->size(); i++)
-		addToPolygon(poly, region->eventSegments->at(i)->timeSegment, line, direction);
+bool GeometryHelper::isPolyContainPt(Polygon* poly, Point* p) {
+	for (unsigned int i = 0; i < poly->vertices.size(); i++){
+		if (poly->vertices[i] == *p)
+			return true;
+	}
+	return false;
+}
 
-	addToPolygon(poly, region->leftBoundry, line, direction);
-	addToPolygon(poly, region->rightBoundry, line, direction);
-	addToPolygon(poly, region->lowerBoundry, line, direction);
+/*
+ * The s-interval of the part of the segment inside the polygon, NULL if there is no such part of positive length.
+ */
+IntervalSet* GeometryHelper::getIntersectionIntervals(Polygon* poly, Segment* segment) {
+	double u0, u1;
+	if (!poly->clipSegment(segment->p1, segment->p2, u0, u1)) return NULL;
 
-	Point p1, p2;
-	if (region->intersect(*line, p1, p2))
-		poly->segments->push_back(new Segment(p1, p2));
+	double x0 = segment->p1.X + u0 * (segment->p2.X - segment->p1.X);
+	double x1 = segment->p1.X + u1 * (segment->p2.X - segment->p1.X);
+	if (IS_ZERO(x1 - x0)) return NULL;
 
-	return poly;
+	IntervalSet* ret = new IntervalSet();
+	ret->intervals.push_back(Interval(x0, x1));
+	return ret;
 }
 
-Polygon* GeometryHelper::regionToPoly(Region* region) {
-	Polygon* poly = new Polygon();
-	for (unsigned int i = 0; i < region->eventSegments->size(); i++){
-		if (region->eventSegments->at(i)->timeSegment->p1 != region->eventSegments->at(i)->timeSegment->p2)
-			poly->segments->push_back(region->eventSegments->at(i)->timeSegment);
+/*
+ * The s-interval of the intersection of the polygons, which is convex. Where they only share an edge, that is the
+ * s-interval of the edge.
+ */
+IntervalSet* GeometryHelper::getIntersectionIntervals(Polygon* poly1, Polygon* poly2) {
+	IntervalSet* ret = new IntervalSet();
+	Polygon intersection;
+	intersection.vertices = poly1->vertices;
+	intersection.clip(*poly2);
+	if (intersection.vertices.empty()) return ret;
+
+	double start = INF, end = -INF;
+	for (unsigned int i = 0; i < intersection.vertices.size(); i++){
+		start = std::min(start, intersection.vertices[i].X);
+		end = std::max(end, intersection.vertices[i].X);
 	}
+	if (!IS_ZERO(end - start))
+		ret->intervals.push_back(Interval(start, end));
+	return ret;
+}
 
-	if (region->leftBoundry->p1 != region->leftBoundry->p2) poly->segments->push_back(region->leftBoundry);
-	if (region->rightBoundry->p1 != region->rightBoundry->p2) poly->segments->push_back(region->rightBoundry);
-	if (region->lowerBoundry->p1 != region->lowerBoundry->p2) poly->segments->push_back(region->lowerBoundry);
+bool GeometryHelper::isConvexFormula(Formula* formula) {
+	return formula->getType() == CONTINUOUS || formula->getType() == COMBI;
+}
 
-	return poly;
+bool GeometryHelper::isAreaFormula(Formula* formula) {
+	switch (formula->getType()){
+	case TT:
+	case DISCRETE:
+	case CONTINUOUS:
+	case COMBI:
+		return true;
+	case AND:
+		return formula->getLeftChild() != NULL && formula->getRightChild() != NULL
+				&& isAreaFormula(formula->getLeftChild()) && isAreaFormula(formula->getRightChild());
+	case NEG:
+		return formula->getLeftChild() != NULL && isAreaFormula(formula->getLeftChild());
+	default:
+		return false;
+	}
+}
+
+/*
+ * The atomic formulas are the convex polygons of createPolygon, which are combined with ClipperLib: a conjunction is
+ * their intersection and a negation the difference from the region. A region without area (a segment) has none in
+ * ClipperLib either, so there the formula is combined along the segment and the result is widened to slivers of
+ * AREA_PREC, through which the paths that cross the region are followed.
+ */
+void GeometryHelper::createArea(ClipperLib::Polygons& area, Region* region, Formula* formula) {
+	area.clear();
+	Polygon* regionPoly = regionToPoly(region);
+	if (regionPoly->vertices.size() >= 3){
+		delete regionPoly;
+		combineArea(area, region, formula);
+		return;
+	}
 
+	IntervalSet* iSet = (regionPoly->vertices.size() == 2) ? getSegmentIntervals(region, regionPoly, formula) : new IntervalSet();
+	iSet->removeRedundency();
+	for (unsigned int i = 0; i < iSet->intervals.size(); i++){
+		const Point &p1 = regionPoly->vertices[0];
+		const Point &p2 = regionPoly->vertices[1];
+		double slope = (p2.Y - p1.Y) / (p2.X - p1.X);
+		double x0 = iSet->intervals[i].start, x1 = iSet->intervals[i].end;
+		if (IS_ZERO(x1 - x0)) continue;
+		double h = AREA_PREC / 2 / sqrt(1 + slope * slope);
+
+		Polygon sliver;
+		sliver.vertices.push_back(Point(x0 + slope * h, p1.Y + slope * (x0 - p1.X) - h));
+		sliver.vertices.push_back(Point(x1 + slope * h, p1.Y + slope * (x1 - p1.X) - h));
+		sliver.vertices.push_back(Point(x1 - slope * h, p1.Y + slope * (x1 - p1.X) + h));
+		sliver.vertices.push_back(Point(x0 - slope * h, p1.Y + slope * (x0 - p1.X) + h));
+		ClipperLib::Polygons sliverArea;
+		toArea(sliverArea, &sliver);
+		area.insert(area.end(), sliverArea.begin(), sliverArea.end());
+	}
+	delete iSet;
+	delete regionPoly;
 }
 
-void GeometryHelper::addToPolygon(Polygon* poly, Segment* seg, Line* line, Direction direction) {
-	Point intersection;
-    if (seg->intersect(*line, intersection)){
-        if ((direction == UP && line->isUp(seg->p1)) || (direction == DOWN && !line->isUp(seg->p1)) ){
-            if (intersection != seg->p1)
-                poly->segments->push_back(new Segment(seg->p1, intersection));
-        }
-        else
-            if (intersection != seg->p2)
-                poly->segments->push_back(new Segment(seg->p2, intersection));
-    }else if((direction == UP && line->isUp(seg->p1) && line->isUp(seg->p2)) || (direction == DOWN && !line->isUp(seg->p1) && !line->isUp(seg->p2)) ){
-        poly->segments->push_back(seg);
-    }
+void GeometryHelper::combineArea(ClipperLib::Polygons& area, Region* region, Formula* formula) {
+	area.clear();
+	Formula_type type = formula->getType();
+	if (type == DISCRETE){
+		AtomDisFormula* disFormula = (AtomDisFormula*)formula;
+		if (region->marking->tokens[model->places[disFormula->getPlaceIndex()].idInMarking] != disFormula->getN())
+			return;
+		type = TT;
+	}
+
+	if (type == TT){
+		Polygon* poly = regionToPoly(region);
+		toArea(area, poly);
+		delete poly;
+	}else if (type == AND || type == NEG){
+		ClipperLib::Polygons subject, clip;
+		if (type == AND){
+			combineArea(subject, region, formula->getLeftChild());
+			combineArea(clip, region, formula->getRightChild());
+		}else{
+			Polygon* poly = regionToPoly(region);
+			toArea(subject, poly);
+			delete poly;
+			combineArea(clip, region, formula->getLeftChild());
+		}
+
+		ClipperLib::Clipper clipper;
+		clipper.AddPolygons(subject, ClipperLib::ptSubject);
+		clipper.AddPolygons(clip, ClipperLib::ptClip);
+		clipper.Execute(type == AND ? ClipperLib::ctIntersection : ClipperLib::ctDifference, area, ClipperLib::pftNonZero, ClipperLib::pftNonZero);
+	}else{
+		Polygon* poly = createPolygon(region, formula);
+		if (poly != NULL){
+			toArea(area, poly);
+			delete poly;
+		}
+	}
 }
 
-Polygon* GeometryHelper::cropPolygon(Polygon* poly, double t, Direction dir) {
-	if (poly == NULL || poly->segments->size() == 0) return NULL;
-
-	Polygon* newPoly = new Polygon();
-    Line* line = new Line(0, t);
-    Point p1, p2;
-    if (poly->intersect(line, p1, p2)){
-        for (unsigned int i = 0; i < poly->segments->size(); i++)
-            addToPolygon(newPoly, poly->segments->at(i), line, dir);
-        newPoly->segments->push_back(new Segment(p1, p2));
-    }else{
-        if ((dir == DOWN && !line->isUp(poly->segments->at(0)->p1))  || (dir == UP && line->isUp(poly->segments->at(0)->p1))){
-            for (unsigned int i = 0; i < poly->segments->size(); i++)
-                newPoly->segments->push_back(poly->segments->at(i));
-        }else
-            newPoly = NULL;
-
-    }
-	return newPoly;
+/*
+ * The s-intervals of the segment of a region without area in which the formula holds. An atomic formula holds on the
+ * part of the segment that createPolygon leaves.
+ */
+IntervalSet* GeometryHelper::getSegmentIntervals(Region* region, Polygon* regionPoly, Formula* formula) {
+	Interval segment(regionPoly->vertices[0].X, regionPoly->vertices[1].X);
+	IntervalSet* ret = new IntervalSet();
+	Formula_type type = formula->getType();
+	if (type == DISCRETE){
+		AtomDisFormula* disFormula = (AtomDisFormula*)formula;
+		if (region->marking->tokens[model->places[disFormula->getPlaceIndex()].idInMarking] != disFormula->getN())
+			return ret;
+		type = TT;
+	}
 
+	if (type == TT){
+		ret->intervals.push_back(segment);
+	}else if (type == AND){
+		IntervalSet* left = getSegmentIntervals(region, regionPoly, formula->getLeftChild());
+		IntervalSet* right = getSegmentIntervals(region, regionPoly, formula->getRightChild());
+		delete ret;
+		ret = left->intersect(right);
+		delete left;
+		delete right;
+	}else if (type == NEG){
+		IntervalSet* holds = getSegmentIntervals(region, regionPoly, formula->getLeftChild());
+		ret->intervals.push_back(segment);
+		IntervalSet* notHolds = ret->minus(holds);
+		delete ret;
+		ret = notHolds;
+		delete holds;
+	}else{
+		Polygon* poly = createPolygon(region, formula);
+		if (poly != NULL && poly->vertices.size() == 2)
+			ret->intervals.push_back(Interval(poly->vertices[0].X, poly->vertices[1].X));
+		delete poly;
+	}
+	return ret;
 }
 
+/*
+ * A polygon without area has no area in ClipperLib either, so it is left out.
+ */
+void GeometryHelper::toArea(ClipperLib::Polygons& area, Polygon* poly) {
+	area.clear();
+	if (poly->vertices.size() < 3) return;
+
+	area.resize(1);
+	for (unsigned int i = 0; i < poly->vertices.size(); i++)
+		area[0].push_back(ClipperLib::IntPoint((ClipperLib::long64) floor(poly->vertices[i].X * CLIPPER_SCALE + 0.5),
+				(ClipperLib::long64) floor(poly->vertices[i].Y * CLIPPER_SCALE + 0.5)));
+}
 
-bool GeometryHelper::isPolyContainPt(Polygon* poly, Point* p) {
-	for (unsigned int i = 0; i < poly->segments->size(); i++){
-		if (poly->segments->at(i)->p1 == *p || poly->segments->at(i)->p2 == *p)
-			return true;
+/*
+ * Intersects the area with a box that covers it in s, from t downwards or upwards.
+ */
+void GeometryHelper::cropArea(ClipperLib::Polygons& area, double t, Direction dir) {
+	if (area.empty()) return;
+
+	ClipperLib::long64 left = area[0][0].X, right = left, bottom = area[0][0].Y, top = bottom;
+	for (unsigned int i = 0; i < area.size(); i++){
+		for (unsigned int j = 0; j < area[i].size(); j++){
+			left = std::min(left, area[i][j].X);
+			right = std::max(right, area[i][j].X);
+			bottom = std::min(bottom, area[i][j].Y);
+			top = std::max(top, area[i][j].Y);
+		}
 	}
-	return false;
+
+	ClipperLib::long64 cut = (ClipperLib::long64) floor(t * CLIPPER_SCALE + 0.5);
+	if (dir == DOWN){
+		if (cut >= top) return;
+		bottom = bottom - 1;
+		top = cut;
+	}else{
+		if (cut <= bottom) return;
+		bottom = cut;
+		top = top + 1;
+	}
+	ClipperLib::Polygons box(1);
+	if (bottom < top){
+		box[0].push_back(ClipperLib::IntPoint(left - 1, bottom));
+		box[0].push_back(ClipperLib::IntPoint(right + 1, bottom));
+		box[0].push_back(ClipperLib::IntPoint(right + 1, top));
+		box[0].push_back(ClipperLib::IntPoint(left - 1, top));
+	}
+
+	ClipperLib::Polygons cropped;
+	ClipperLib::Clipper clipper;
+	clipper.AddPolygons(area, ClipperLib::ptSubject);
+	clipper.AddPolygons(box, ClipperLib::ptClip);
+	clipper.Execute(ClipperLib::ctIntersection, cropped, ClipperLib::pftNonZero, ClipperLib::pftNonZero);
+	area.swap(cropped);
+}
+
+/*
+ * The output of ClipperLib has no overlapping polygons, so crossing their edges to the right of p alternates between
+ * inside and outside (holes included).
+ */
+bool GeometryHelper::isAreaContainPt(const ClipperLib::Polygons& area, const Point& p) {
+	bool inside = false;
+	for (unsigned int i = 0; i < area.size(); i++){
+		for (unsigned int j = 0; j < area[i].size(); j++){
+			const ClipperLib::IntPoint &v1 = area[i][j];
+			const ClipperLib::IntPoint &v2 = area[i][(j + 1) % area[i].size()];
+			Point a(v1.X / CLIPPER_SCALE, v1.Y / CLIPPER_SCALE);
+			Point b(v2.X / CLIPPER_SCALE, v2.Y / CLIPPER_SCALE);
+
+			// On the boundary
+			double dx = b.X - a.X, dy = b.Y - a.Y;
+			double u = std::max(0.0, std::min(1.0, ((p.X - a.X) * dx + (p.Y - a.Y) * dy) / (dx * dx + dy * dy)));
+			double ex = a.X + u * dx - p.X, ey = a.Y + u * dy - p.Y;
+			if (ex * ex + ey * ey <= AREA_PREC * AREA_PREC)
+				return true;
+
+			if ((a.Y > p.Y) != (b.Y > p.Y) && p.X < a.X + (p.Y - a.Y) * dx / dy)
+				inside = !inside;
+		}
+	}
+	return inside;
 }
 
+/*
+ * The segment is cut where it crosses an edge of the area and where it passes a vertex, and each piece is inside or
+ * outside as a whole.
+ */
+IntervalSet* GeometryHelper::getIntersectionIntervals(const ClipperLib::Polygons& area, Segment* segment) {
+	const Point &p1 = segment->p1;
+	double dx = segment->p2.X - p1.X, dy = segment->p2.Y - p1.Y;
+	double length = sqrt(dx * dx + dy * dy);
+	if (IS_ZERO(length)) return NULL;
+
+	std::vector<double> cuts;
+	cuts.push_back(0);
+	cuts.push_back(1);
+	for (unsigned int i = 0; i < area.size(); i++){
+		for (unsigned int j = 0; j < area[i].size(); j++){
+			const ClipperLib::IntPoint &v1 = area[i][j];
+			const ClipperLib::IntPoint &v2 = area[i][(j + 1) % area[i].size()];
+			Point a(v1.X / CLIPPER_SCALE, v1.Y / CLIPPER_SCALE);
+			Point b(v2.X / CLIPPER_SCALE, v2.Y / CLIPPER_SCALE);
+
+			// The distances of the ends of the edge to the left of the segment
+			double da = (dx * (a.Y - p1.Y) - dy * (a.X - p1.X)) / length;
+			double db = (dx * (b.Y - p1.Y) - dy * (b.X - p1.X)) / length;
+			if (fabs(da) <= AREA_PREC)
+				cuts.push_back(((a.X - p1.X) * dx + (a.Y - p1.Y) * dy) / (length * length));
+			else if ((da > AREA_PREC && db < -AREA_PREC) || (da < -AREA_PREC && db > AREA_PREC)){
+				double u = da / (da - db);
+				Point c(a.X + u * (b.X - a.X), a.Y + u * (b.Y - a.Y));
+				cuts.push_back(((c.X - p1.X) * dx + (c.Y - p1.Y) * dy) / (length * length));
+			}
+		}
+	}
+	std::sort(cuts.begin(), cuts.end());
 
-IntervalSet* GeometryHelper::getIntersectionIntervals(Polygon* poly, Segment* segment) {
-	Point intPt1, intPt2;
-	int numIntersection = 0;
-//	std::cout << "---------------------------" << std::endl;
-//	poly->print();
-    for (unsigned int i = 0; i < poly->segments->size(); i++){
-            Point intPt;
-            IntersectionStatus inStatus = poly->segments->at(i)->intersect2(*segment, intPt);
-            if ( inStatus == ALL){
-                Interval i1(segment->p1.X, segment->p2.X);
-                Interval i2(poly->segments->at(i)->p1.X, poly->segments->at(i)->p2.X);
-                Interval res;
-                i1.intersect(i2, res);
-                IntervalSet* ret = new IntervalSet();
-                ret->intervals.push_back(res);
-                return ret;
-            } else if(inStatus == NO) continue;
-            if (numIntersection == 0) { intPt1 = intPt; numIntersection++;}
-            else if (numIntersection == 1 ) { intPt2 = intPt; numIntersection++;}
-            else break;
-    }
-	if (numIntersection < 2) return NULL; //No intersection
-	else {Interval I(intPt1.X, intPt2.X); IntervalSet* ret = new IntervalSet(); ret->intervals.push_back(I); return ret;}
+	IntervalSet* ret = new IntervalSet();
+	for (unsigned int k = 0; k + 1 < cuts.size(); k++){
+		double u0 = std::max(0.0, cuts[k]), u1 = std::min(1.0, cuts[k + 1]);
+		if (u1 <= u0) continue;
+
+		Point mid(p1.X + (u0 + u1) / 2 * dx, p1.Y + (u0 + u1) / 2 * dy);
+		if (!isAreaContainPt(area, mid)) continue;
+
+		double x0 = p1.X + u0 * dx, x1 = p1.X + u1 * dx;
+		if (!ret->intervals.empty() && IS_ZERO(ret->intervals.back().end - std::min(x0, x1)))
+			ret->intervals.back().end = std::max(x0, x1);
+		else
+			ret->intervals.push_back(Interval(x0, x1));
+	}
+
+	std::vector<Interval> intervals;
+	for (unsigned int k = 0; k < ret->intervals.size(); k++){
+		if (!IS_ZERO(ret->intervals[k].end - ret->intervals[k].start))
+			intervals.push_back(ret->intervals[k]);
+	}
+	ret->intervals.swap(intervals);
+	if (ret->isEmpty()){
+		delete ret;
+		return NULL;
+	}
+	return ret;
 }
 
-IntervalSet* GeometryHelper::getIntersectionIntervals(Polygon* poly1, Polygon* poly2) {
-	Point intPt1, intPt2;
-	int numIntersection = 0;
+/*
+ * The s-intervals of the polygons of the intersection of the areas.
+ */
+IntervalSet* GeometryHelper::getIntersectionIntervals(const ClipperLib::Polygons& area1, const ClipperLib::Polygons& area2) {
+	ClipperLib::Polygons intersection;
+	ClipperLib::Clipper clipper;
+	clipper.AddPolygons(area1, ClipperLib::ptSubject);
+	clipper.AddPolygons(area2, ClipperLib::ptClip);
+	clipper.Execute(ClipperLib::ctIntersection, intersection, ClipperLib::pftNonZero, ClipperLib::pftNonZero);
+
 	IntervalSet* ret = new IntervalSet();
-    for (unsigned int i = 0; i < poly1->segments->size(); i++){
-        for (unsigned int j = 0; j < poly2->segments->size(); j++){
-            Point intPt;
-            IntersectionStatus inStatus = poly1->segments->at(i)->intersect2(*poly2->segments->at(j), intPt);
-            if (inStatus == ALL){
-                Interval i1(poly1->segments->at(i)->p1.X, poly1->segments->at(i)->p2.X);
-                Interval i2(poly2->segments->at(j)->p1.X, poly2->segments->at(j)->p2.X);
-                Interval res;
-                i1.intersect(i2, res);
-                ret->intervals.push_back(res);
-                break;
-            }
-            if (inStatus == POINT && numIntersection == 0) {
-                intPt1 = intPt;
-                numIntersection++;
-            }
-            else if (inStatus == POINT && numIntersection == 1 ) {
-                intPt2 = intPt;
-                numIntersection++;
-            }
-        }
-        if (numIntersection ==2){
-            Interval I(intPt1.X, intPt2.X);
-            ret->intervals.push_back(I);
-        }
-    }
-//	std::cout << "ret: ";
-//	ret->print();
+	for (unsigned int i = 0; i < intersection.size(); i++){
+		if (intersection[i].empty()) continue;
+		ClipperLib::long64 start = intersection[i][0].X, end = start;
+		for (unsigned int j = 1; j < intersection[i].size(); j++){
+			start = std::min(start, intersection[i][j].X);
+			end = std::max(end, intersection[i][j].X);
+		}
+		if (start < end)
+			ret->intervals.push_back(Interval(start / CLIPPER_SCALE, end / CLIPPER_SCALE));
+	}
 	ret->removeRedundency();
 	return ret;
 }
@@ -8,7 +8,7 @@
 #ifndef GEOMETRYHELPER_H_
 #define GEOMETRYHELPER_H_
 
-//#include "./clipper/clipper.hpp"
+#include "./clipper/clipper.hpp"
 #include "Formula.h"
 #include "IntervalSet.h"
 #include "Region.h"
@@ -28,31 +28,56 @@ enum RegionState {ENTIRE, PART, NONE};
 class GeometryHelper {
 	Model* model;
 
+	void combineArea(ClipperLib::Polygons& area, Region* region, Formula* formula);
+	IntervalSet* getSegmentIntervals(Region* region, Polygon* regionPoly, Formula* formula);
+
 public:
 	//Stochastic part functions
     Polygon* createPolygon(Region* region, Formula* formula);
     Polygon* splitRegion(Region* region, Line* line, Direction direction);
     Polygon* regionToPoly(Region* region);
-	/*
-	 * Helper function. if the line has an intersection with seg, according to the direction intersection point
-	 * and appropriate end point of seg is added to polygon.
-	 */
-	void addToPolygon(Polygon* poly, Segment* seg, Line* line, Direction direction);
 	bool isPolyContainPt(Polygon* poly, Point* p);
 	IntervalSet* getIntersectionIntervals(Polygon* poly, Segment* segment);
 	IntervalSet* getIntersectionIntervals(Polygon* poly1, Polygon* poly2);
-	Polygon* reform(Polygon* poly, Interval interval);
+
+	/*
+	 * Boolean combinations (and, negation, true and discrete atomic formulas) are built with ClipperLib, as areas of
+	 * polygons with the coordinates scaled by CLIPPER_SCALE to integers. An area is closed: points within AREA_PREC of
+	 * its boundary are in it.
+	 */
+	static const double CLIPPER_SCALE;
+	static const double AREA_PREC;
+	/*
+	 * Whether createPolygon handles the formula, in which case it holds in a convex part of a region. Otherwise it has
+	 * to be combined by createArea.
+	 */
+	bool isConvexFormula(Formula* formula);
+	/*
+	 * Whether the formula is a boolean combination that createArea handles.
+	 */
+	bool isAreaFormula(Formula* formula);
+	void createArea(ClipperLib::Polygons& area, Region* region, Formula* formula);
+	void toArea(ClipperLib::Polygons& area, Polygon* poly);
+	void cropArea(ClipperLib::Polygons& area, double t, Direction dir);
+	bool isAreaContainPt(const ClipperLib::Polygons& area, const Point& p);
+	IntervalSet* getIntersectionIntervals(const ClipperLib::Polygons& area, Segment* segment);
+	IntervalSet* getIntersectionIntervals(const ClipperLib::Polygons& area1, const ClipperLib::Polygons& area2);
 
 	//Discrete part functions.
 	/*
 	 * return true if formula holds in entire region. o.w. t and dir represent the validity area.
 	 */
 	RegionState getTimeAndDirection(DtrmEvent* dtrmRegion, Formula* psi1, double& t, Direction& dir);
+	/*
+	 * The times in the deterministic region at which an atomic formula or a boolean combination holds.
+	 */
+	IntervalSet* getTimeIntervals(DtrmEvent* dtrmRegion, Formula* formula);
 
 
 	Polygon* cropPolygon(Polygon* poly, double t, Direction dir);
 
 	void drawPolygon(cv::Mat& im, Polygon* poly, const int scale, cv::Scalar color = cv::Scalar(0, 0, 255));
+	void drawArea(cv::Mat& im, const ClipperLib::Polygons& area, const int scale, cv::Scalar color = cv::Scalar(0, 0, 255));
 	void drawVerticalLine(cv::Mat& im, double t, Direction dir,const int scale, cv::Scalar color =  cv::Scalar(0, 0, 255));
 
 	GeometryHelper(Model* _model): model(_model){};
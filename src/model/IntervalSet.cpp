@@ -49,6 +49,11 @@ IntervalSet* IntervalSet::unionWith(const IntervalSet* uSet) {
 	return unionSet;
 }
 
+void IntervalSet::append(const IntervalSet* intSet) {
+	if (intSet == NULL) return;
+	intervals.insert(intervals.end(), intSet->intervals.begin(), intSet->intervals.end());
+}
+
 Interval::Interval(double _start, double _end) {
 	start = std::min(_start, _end);
 	end = std::max(_start, _end);
@@ -100,7 +105,7 @@ void IntervalSet::removeRedundency() {
 	intervals.clear();
 	for (unsigned int i = 0; i < newSet.size(); i++){
 		Interval toSave = newSet[i];
-		while(toSave.end == newSet[i+1].start){
+		while(i + 1 < newSet.size() && toSave.end == newSet[i+1].start){
 			toSave.end = newSet[i+1].end;
 			i++;
 		}
@@ -44,6 +44,11 @@ public:
 	IntervalSet* unionWith(const Interval intSet);
 	IntervalSet* minus(const Interval intSet);
 
+	/*
+	 * Adds the intervals of intSet without merging them, see removeRedundency. NULL is the empty set.
+	 */
+	void append(const IntervalSet* intSet);
+
 	/*
 	 * Sorts based on the start point of intervals.
 	 */
@@ -9,9 +9,7 @@
 
 namespace model {
 
-Line::Line() {
-	// TODO Auto-generated constructor stub
-
+Line::Line(): X(0), a(0), b(0) {
 }
 
 Line::~Line() {
@@ -61,6 +59,7 @@ Segment::Segment(Point &p1, Point &p2) {
 	this->p1 = p1;
 	this->p2 = p2;
     if (IS_ZERO(p1.X - p2.X)){
+		X = p1.X;
 		a = INF;
 		b = INF;
 	} else{
@@ -75,7 +74,7 @@ Segment::Segment(double a, double b, Point &p1, Point &p2): Line(a, b){
 }
 
 Segment::Segment(Line &line, double start, double end): Line (line.a, line.b) {
-	p1.X = start; p2.Y = line.getY(start);
+	p1.X = start; p1.Y = line.getY(start);
 	p2.X = end; p2.Y = line.getY(end);
 }
 
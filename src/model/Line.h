@@ -40,8 +40,8 @@ public:
 	double b;    
 
 	Line();
-	Line(double _a, double _b): a(_a), b(_b) {};
-	Line(double _X): X(_X), a(INF){};
+	Line(double _a, double _b): X(0), a(_a), b(_b) {};
+	Line(double _X): X(_X), a(INF), b(0){};
 	virtual ~Line();
 
 	Line & operator =(const Line &l);
@@ -5,217 +5,84 @@
  */
 
 #include "ModelChecker.h"
+#include "flex/parser_bison_class.tab.h"
+
+#include <QThread>
+#include <QThreadPool>
+#include <algorithm>
 
 using namespace std;
 
 namespace model {
 
-IntervalSet* ModelChecker::visitStocRegion(Region* region, Formula* psi1, Formula* psi2, IntervalSet* potentialSatSet, double t, Interval bound) {
-	//TODO:[IMPORTANT assumption] t=0 and bound = [0, MAX_TIME]
-
-	if (region == NULL) return NULL;
-	//if line t is within the region
-
-
-	//if line t is NOT within the region
-	Polygon *psi1_poly = geometryHelper->createPolygon(region, psi1);
-	Polygon *psi2_poly = geometryHelper->createPolygon(region, psi2);
-	psi1_poly = geometryHelper->cropPolygon(psi1_poly, bound.end, DOWN);
-	psi2_poly = geometryHelper->cropPolygon(psi2_poly, bound.end, DOWN);
-
-    //if (psi1_poly != NULL) psi1_poly->print();
-    //if (psi2_poly != NULL) psi2_poly->print();
-
-	if (!debugImage.empty()){
-		if (psi1_poly != NULL) geometryHelper->drawPolygon(debugImage, psi1_poly, scale, cv::Scalar(0, 0, 255));
-		if (psi2_poly != NULL) geometryHelper->drawPolygon(debugImage, psi2_poly, scale, cv::Scalar(255, 255, 0));
-		cv::Mat flipped;
-		cv::flip(debugImage, flipped, 0);
-		cv::imshow("test", flipped);
-		cv::waitKey(0);
-	}
-
-	// First interval set.
-	if (psi2_poly != NULL){
-		for (unsigned int i = 0; i < potentialSatSet->intervals.size(); i++){
-			Point p1(potentialSatSet->intervals.at(i).start, region->lowerBoundry->getY(potentialSatSet->intervals.at(i).start));
-			Point p2(potentialSatSet->intervals.at(i).end, region->lowerBoundry->getY(potentialSatSet->intervals.at(i).end));
-			Segment* seg = new Segment(p1, p2);
-
-            satSet = satSet->unionWith(geometryHelper->getIntersectionIntervals(psi2_poly, seg));
-            delete seg;
-		}
-	}
-
-	if (psi1_poly != NULL){
-		IntervalSet* psi1_Int = new IntervalSet();
-		//Second interval set.
-		for (unsigned int i = 0; i < potentialSatSet->intervals.size(); i++){
-			Point p1(potentialSatSet->intervals.at(i).start, region->lowerBoundry->getY(potentialSatSet->intervals.at(i).start));
-			Point p2(potentialSatSet->intervals.at(i).end, region->lowerBoundry->getY(potentialSatSet->intervals.at(i).end));
-			Segment* seg = new Segment(p1, p2);
-
-			psi1_Int = psi1_Int->unionWith(geometryHelper->getIntersectionIntervals(psi1_poly, seg));
-			//In general case here the psi1_poly should be reformed.
-            delete seg;
-		}
-
-		if (psi2_poly != NULL){
-			IntervalSet* psi12_Int = geometryHelper->getIntersectionIntervals(psi1_poly, psi2_poly);
-            if (psi12_Int != NULL){
-                satSet = satSet->unionWith(psi1_Int->intersect(psi12_Int));
-			}
-		}
-
-        //Third Set of intervals.
-        for (unsigned int i = 0; i < region->successors->size(); i++){
-            IntervalSet* potPsi1_int = geometryHelper->getIntersectionIntervals(psi1_poly, region->successors->at(i)->lowerBoundry);
-            if (potPsi1_int != NULL){
-                potPsi1_int = potPsi1_int->minus(satSet);
-                potPsi1_int = potPsi1_int->intersect(psi1_Int);
-                if (!potPsi1_int->isEmpty())
-                     satSet = satSet->unionWith(visitStocRegion(region->successors->at(i), psi1, psi2, potPsi1_int, t, bound));
-            }
-        }
-	}
-
-	return satSet;
-
-}
-
 bool ModelChecker::setVariables() {
-    char *argFinder;
-    int a;
-
-    int distr = this->model->transitions[gTransitionId(this->model)].df_distr;
-
-    //char *argument = this->model->transitions[gTransitionId(this->model)].df_argument;
-    char argument[strlen(this->model->transitions[gTransitionId(this->model)].df_argument)];
-    strcpy(argument, this->model->transitions[gTransitionId(this->model)].df_argument);
-    //memcpy (argument, this->model->transitions[gTransitionId(this->model)].df_argument, sizeof (char *));
-    switch (distr)
-    {
-    case Exp: this->setLambda(atof(argument));
-        this->setDistr(Exp);
-        break;
-    case Gamma: this->setLambda(atof(argument));
-        this->setDistr(Gamma);
-        break;
-    case Uni:
-        argFinder = strtok(argument,",");
-        if (argFinder == NULL) {
-            guic->addError(QString("ATransition #%1 : %2 has an invalid cumulative distribution function (cdf) for uni{a,b}, since this requires two arguments.").arg(gTransitionId(this->model)+1).arg(this->model->transitions[gTransitionId(this->model)].id).toStdString());
-            return false;
-        }
-        a = atof(argFinder);
-        argFinder = strtok(NULL,",");
-        if (argFinder == NULL) {
-            guic->addError(QString("BTransition #%1 : %2 has an invalid cumulative distribution function (cdf) for uni{a,b}, since this requires two arguments.").arg(gTransitionId(this->model)+1).arg(this->model->transitions[gTransitionId(this->model)].id).toStdString());
-            return false;
-        }
-        this->setAB(a,atof(argFinder));
-        this->setDistr(Uni);
-        break;
-    case Gen:
-        this->setF(evaluator_create (argument));
-        this->setDistr(Gen);
-        break;
-    case FoldedNorm:
-        argFinder = strtok(argument,",");
-        if (argFinder == NULL) {
-            guic->addError(QString("Transition #%1 : %2 has an invalid cumulative distribution function (cdf) for norm{mu,sigma}, since this requires two arguments.").arg(gTransitionId(this->model)+1).arg(this->model->transitions[gTransitionId(this->model)].id).toStdString());
-            return false;
-        }
-        this->setMu(atof(argFinder));
-        argFinder = strtok(NULL,",");
-        if (argFinder == NULL) {
-            guic->addError(QString("Transition #%1 : %2 has an invalid cumulative distribution function (cdf) for norm{mu,sigma}, since this requires two arguments.").arg(gTransitionId(this->model)+1).arg(this->model->transitions[gTransitionId(this->model)].id).toStdString());
-            return false;
-        }
-        this->setSigma(atof(argFinder));
-        this->setDistr(FoldedNorm);
-        break;
-    case Norm:
-        argFinder = strtok(argument,",");
-        if (argFinder == NULL) {
-            guic->addError(QString("Transition #%1 : %2 has an invalid cumulative distribution function (cdf) for norm{mu,sigma}, since this requires two arguments.").arg(gTransitionId(this->model)+1).arg(this->model->transitions[gTransitionId(this->model)].id).toStdString());
-            return false;
-        }
-        this->setMu(atof(argFinder));
-        argFinder = strtok(NULL,",");
-        if (argFinder == NULL) {
-            guic->addError(QString("Transition #%1 : %2 has an invalid cumulative distribution function (cdf) for norm{mu,sigma}, since this requires two arguments.").arg(gTransitionId(this->model)+1).arg(this->model->transitions[gTransitionId(this->model)].id).toStdString());
-            return false;
-        }
-        this->setSigma(atof(argFinder));
-        this->setDistr(Norm);
-        break;
-    case Dtrm:
-        this->setDtrm(atof(argument));
-        this->setDistr(Dtrm);
-        break;
-    }
-
-    return true;
+    delete this->distribution;
+    this->distribution = GeneralDistribution::create(this->model, gTransitionId(this->model), guic);
+    return this->distribution != NULL;
 }
 
 ModelChecker::~ModelChecker() {
-	// TODO Auto-generated destructor stub
+    delete distribution;
 }
 
-IntervalSet* ModelChecker::visitDtrmRegion(DtrmEvent* dtrmRegion, Formula* psi1, Formula* psi2, double t, Interval bound) {
-	if (dtrmRegion->time >= bound.end || dtrmRegion->time >= model->MaxTime || dtrmRegion == NULL)
-		return satSet;
-
-	Direction d1 = UP;
-	Direction d2 = UP;
-	double t1 = INF;
-	double t2 = INF;
-
-	RegionState state1 = geometryHelper->getTimeAndDirection(dtrmRegion, psi1, t1, d1);
-	RegionState state2 = geometryHelper->getTimeAndDirection(dtrmRegion, psi2, t2, d2);
-
-	if (!debugImage.empty()){
-		geometryHelper->drawVerticalLine(debugImage, t1, d1, scale, cv::Scalar(0, 0, 255));
-		geometryHelper->drawVerticalLine(debugImage, t2, d2, scale, cv::Scalar(255, 255, 0));
-		cv::Mat flipped;
-		cv::flip(debugImage, flipped, 0);
-        cv::imshow("temp", flipped);
-		cv::waitKey(0);
-
-	}
-
-
-	if (state2 != NONE && d2 == DOWN){
-		satSet = satSet->unionWith(Interval(dtrmRegion->time, model->MaxTime));
-		return satSet;
+/*
+ * psi1 has to hold from the start of the region on, and the until is satisfied from the first time psi2 holds while it
+ * does. Paths that leave the region before psi1 stops holding are continued in the stochastic regions. Atomic operands
+ * take this step as well, so an operand gives the same result as any equivalent boolean combination, also where it
+ * holds throughout a region at a constant level.
+ */
+void ModelChecker::visitDtrmRegion(DtrmEvent* dtrmRegion, Formula* psi1, Formula* psi2, double t, Interval bound) {
+	if (dtrmRegion == NULL || dtrmRegion->time >= bound.end || dtrmRegion->time >= model->MaxTime)
+		return;
+
+	IntervalSet* psi1Times = geometryHelper->getTimeIntervals(dtrmRegion, psi1);
+	IntervalSet* psi2Times = geometryHelper->getTimeIntervals(dtrmRegion, psi2);
+	psi1Times->removeRedundency();
+	psi2Times->removeRedundency();
+
+	double psi1End = dtrmRegion->time;
+	if (!psi1Times->isEmpty() && IS_ZERO(psi1Times->intervals.front().start - dtrmRegion->time))
+		psi1End = psi1Times->intervals.front().end;
+
+	if (!psi2Times->isEmpty() && psi2Times->intervals.front().start <= psi1End)
+		satSet->intervals.push_back(Interval(psi2Times->intervals.front().start, model->MaxTime));
+	else if (IS_ZERO(psi1End - dtrmRegion->nextDtrmEvent->time))
+		visitDtrmRegion(dtrmRegion->nextDtrmEvent, psi1, psi2, t, bound);
+
+	if (psi1End > dtrmRegion->time){
+		IntervalSet* iSet = new IntervalSet();
+		iSet->intervals.push_back(Interval(dtrmRegion->time, psi1End));
+		IntervalSet* potentialSatSet = iSet->minus(satSet);
+
+		for (unsigned int i =0; i < dtrmRegion->nextRegions->size(); i++)
+			untilRoots.push_back(std::make_pair(dtrmRegion->nextRegions->at(i), *potentialSatSet));
+
+		delete potentialSatSet;
+		delete iSet;
 	}
 
-	if (state1 != ENTIRE && d1 == UP)
-		return NULL;
-
-	if (state2 != NONE && t2 <= t1)
-		satSet = satSet->unionWith(Interval(t2, model->MaxTime));
-	else if(state1 == ENTIRE && (state2 != NONE && d2 == UP))
-		satSet = satSet->unionWith(Interval(t2, model->MaxTime));
-	else if(state1 == ENTIRE)
-        satSet = satSet->unionWith(visitDtrmRegion(dtrmRegion->nextDtrmEvent, psi1, psi2, t, bound));
-
-	IntervalSet* iSet = new IntervalSet();
-    iSet->intervals.push_back(Interval(dtrmRegion->time, (state1 == ENTIRE)? dtrmRegion->nextDtrmEvent->time : t1));
-	iSet = iSet->minus(satSet);
-
-    for (unsigned int i =0; i < dtrmRegion->nextRegions->size(); i++)
-        satSet = satSet->unionWith(visitStocRegion(dtrmRegion->nextRegions->at(i), psi1, psi2, iSet, t, bound));
-
-	return satSet;
-
+	delete psi1Times;
+	delete psi2Times;
 }
 
+/*
+ * The deterministic regions are followed on the calling thread; they give the roots of the traversal of the stochastic
+ * regions, together with the stochastic regions at the check time.
+ */
 bool ModelChecker::until(IntervalSet *&res, Formula* psi1, Formula* psi2, Interval bound) {
+	UntilCache untilCache;
+	return until(res, psi1, psi2, bound, &untilCache);
+}
+
+bool ModelChecker::until(IntervalSet *&res, Formula* psi1, Formula* psi2, Interval bound, UntilCache* untilCache) {
 	// TODO: Currently I have assumed that the given bound starts at 0 ie. T_1 = 0.
     // TODO: Traverse through the formulas retrieving the polygons. Then in the end retrieve the intervalset.
 
+    if (!geometryHelper->isAreaFormula(psi1) || !geometryHelper->isAreaFormula(psi2)) {
+        guic->addError("The operands of an until formula can only be boolean combinations of atomic formulas.");
+        return false;
+    }
+
     satSet = new IntervalSet();
 
     double t = ttc; // - std->getTrEnabledTime();
@@ -231,24 +98,69 @@ bool ModelChecker::until(IntervalSet *&res, Formula* psi1, Formula* psi2, Interv
 	for (unsigned int i = 0; i < std->dtrmEventList.size() - 1; i++){
         //std::cout << i << std::endl;
         if (std->dtrmEventList[i]->time <= ttc && std->dtrmEventList[i]->nextDtrmEvent->time > ttc){
-			satSet = satSet->unionWith(visitDtrmRegion(std->dtrmEventList[i], psi1, psi2,t, bound));
+			visitDtrmRegion(std->dtrmEventList[i], psi1, psi2, t, bound);
 			break;
 		}
 	}
 
-	//iterating over all stochastic regions.
-	for (unsigned int i = 0; i < std->regionList.size(); i++){
-		if (std->regionList[i]->intersect(timeLine, p1, p2)){
-			IntervalSet* potSet = new IntervalSet();
-			potSet->intervals.push_back(Interval(p1.X, p2.X));
-
-			satSet = satSet->unionWith(visitStocRegion(std->regionList[i], psi1, psi2, potSet, t, bound));
+	//iterating over the stochastic regions around the check time.
+	std::vector<unsigned int> candidates;
+	untilCache->getRegionsAt(candidates, std->regionList, t);
+	for (unsigned int k = 0; k < candidates.size(); k++){
+		Region *region = std->regionList[candidates[k]];
+		if (region->intersect(timeLine, p1, p2)){
+			IntervalSet potSet;
+			potSet.intervals.push_back(Interval(p1.X, p2.X));
+			untilRoots.push_back(std::make_pair(region, potSet));
 		}
 	}
+
+	traverseStocRegions(psi1, psi2, bound, untilCache);
+	untilRoots.clear();
+
+    satSet->removeRedundency();
     res = satSet;
     return true;
 }
 
+/*
+ * Traverses the stochastic regions from the roots of until into satSet. The roots are split into contiguous chunks,
+ * since neighbouring roots mostly reach the same regions, and the chunks are traversed on a thread pool with a
+ * satisfaction set each. A region reached from roots of different chunks is visited by each of them (its polygons are
+ * shared through the cache), so there are a few chunks per thread at most. With a debug image, the polygons are drawn
+ * on the calling thread in one traversal.
+ */
+void ModelChecker::traverseStocRegions(Formula* psi1, Formula* psi2, Interval bound, UntilCache* untilCache) {
+	int threads = QThread::idealThreadCount();
+	if (threads < 1 || !debugImage.empty()) threads = 1;
+	unsigned int traversalCount = std::min(untilRoots.size() / MIN_UNTIL_ROOTS_PER_TRAVERSAL, (size_t) 4 * threads);
+	if (traversalCount < 1) traversalCount = 1;
+
+	std::vector<UntilTraversal*> traversals;
+	for (unsigned int k = 0; k < traversalCount; k++) {
+		UntilTraversal *traversal = new UntilTraversal(geometryHelper, untilCache, psi1, psi2, bound);
+		if (!debugImage.empty()) traversal->setDebugImage(&debugImage, scale);
+		for (unsigned int i = k * untilRoots.size() / traversalCount; i < (k + 1) * untilRoots.size() / traversalCount; i++)
+			traversal->enqueue(untilRoots[i].first, &untilRoots[i].second);
+		traversals.push_back(traversal);
+	}
+
+	if (traversalCount == 1) {
+		traversals[0]->run();
+	} else {
+		QThreadPool pool;
+		pool.setMaxThreadCount(threads);
+		for (unsigned int k = 0; k < traversalCount; k++)
+			pool.start(traversals[k]);
+		pool.waitForDone();
+	}
+
+	for (unsigned int k = 0; k < traversalCount; k++) {
+		satSet->append(&traversals[k]->getSatSet());
+		delete traversals[k];
+	}
+}
+
 //IntervalSet* ModelChecker::tempUntil(Formula* psi1, Formula* psi2, Interval bound, double time) {
 //    // TODO: Currently I have assumed that the given bound starts at 0 ie. T_1 = 0.
 
@@ -307,8 +219,10 @@ bool ModelChecker::iSetNeg(IntervalSet *&res, IntervalSet* iset1) {
     //std::cout << "IntervalSet 1 : ";
     //iset1->print(std::cout);
     //std::cout << std::endl;
-    if(!iSetTT(res)) return false;
-    res->minus(iset1);
+    IntervalSet *all;
+    if(!iSetTT(all)) return false;
+    res = all->minus(iset1);
+    delete all;
     //std::cout << "IntervalSet result NEG : ";
     //res->print(std::cout);
     //std::cout << std::endl;
@@ -340,27 +254,214 @@ bool ModelChecker::iSetAtomCont(IntervalSet *&res, AtomContFormula* psi1) {
 }
 
 double ModelChecker::calcProb(IntervalSet* iSet, double shift) {
-    double prob = 0;
-    for(std::vector<Interval>::size_type i = 0; i != iSet->intervals.size(); i++) {
-        switch (this->distr)
-        {
-        case Exp: prob += ( this->scdfExp(iSet->intervals[i].end - shift) - this->scdfExp(iSet->intervals[i].start - shift));
-        break;
-        case Uni: prob += ( this->scdfUni(iSet->intervals[i].end - shift) - this->scdfUni(iSet->intervals[i].start - shift));
-        break;
-        case Gen: prob += ( this->scdfGen(iSet->intervals[i].end - shift) - this->scdfGen(iSet->intervals[i].start - shift));
-        break;
-        case Gamma: prob += ( this->scdfGamma(iSet->intervals[i].end - shift) - this->scdfGamma(iSet->intervals[i].start - shift));
-        break;
-        case Norm: prob += ( this->scdfNormal(iSet->intervals[i].end - shift) - this->scdfNormal(iSet->intervals[i].start - shift));
-        break;
-        case FoldedNorm: prob += ( this->scdfFoldedNormal(iSet->intervals[i].end - shift) - this->scdfFoldedNormal(iSet->intervals[i].start - shift));
-        break;
-        case Dtrm: prob += ( this->scdfDtrm(iSet->intervals[i].end - shift) - this->scdfDtrm(iSet->intervals[i].start - shift));
-        break;
+    if (this->distribution == NULL)
+        return 0;
+    return this->distribution->calcProb(iSet, shift);
+}
+
+double ModelChecker::calcContProbAtTime(double time, int pIndex, double amount) {
+    IntervalSet *iSet = calcAtomContISetAtTime(time, pIndex, amount);
+    double prob = calcProb(iSet, 0.00);
+    delete iSet;
+    return prob;
+}
+
+void ModelChecker::calcProbsAtTime(std::vector<double> &probs, double time, int pIndex, const std::vector<double> &amounts) {
+    probs.resize(amounts.size());
+    for (unsigned int k = 0; k < amounts.size(); k++)
+        probs[k] = calcContProbAtTime(time, pIndex, amounts[k]);
+}
+
+void ModelChecker::calcAdaptiveProbCurve(std::vector<double> &times, std::vector<std::vector<double> > &probs, int pIndex, const std::vector<double> &amounts, double minStep, double tolerance) {
+    std::vector<double> breakpoints;
+    std->getBreakpoints(breakpoints);
+
+    times.clear();
+    probs.clear();
+
+    std::vector<double> pPrev, pCur;
+    for (unsigned int i = 0; i < breakpoints.size(); i++) {
+        calcProbsAtTime(pCur, breakpoints[i], pIndex, amounts);
+        if (i > 0)
+            refineProbCurve(times, probs, breakpoints[i - 1], pPrev, breakpoints[i], pCur, pIndex, amounts, minStep, tolerance);
+        times.push_back(breakpoints[i]);
+        probs.push_back(pCur);
+        pPrev = pCur;
+    }
+}
+
+/*
+ * Adds the samples strictly between t0 and t1 in increasing order. Between two breakpoints the curve is smooth, so
+ * a midpoint that lies on the chord (within tolerance) means the segment needs no further samples.
+ */
+void ModelChecker::refineProbCurve(std::vector<double> &times, std::vector<std::vector<double> > &probs, double t0, const std::vector<double> &p0, double t1, const std::vector<double> &p1, int pIndex, const std::vector<double> &amounts, double minStep, double tolerance) {
+    if (t1 - t0 < 2 * minStep)
+        return;
+
+    double tm = (t0 + t1) / 2;
+    std::vector<double> pm;
+    calcProbsAtTime(pm, tm, pIndex, amounts);
+
+    double deviation = 0;
+    for (unsigned int k = 0; k < amounts.size(); k++)
+        deviation = std::max(deviation, fabs(pm[k] - (p0[k] + p1[k]) / 2));
+    if (deviation <= tolerance)
+        return;
+
+    refineProbCurve(times, probs, t0, p0, tm, pm, pIndex, amounts, minStep, tolerance);
+    times.push_back(tm);
+    probs.push_back(pm);
+    refineProbCurve(times, probs, tm, pm, t1, p1, pIndex, amounts, minStep, tolerance);
+}
+
+void ModelChecker::getContBreakpoints(std::vector<double> &breakpoints, int pIndex, double amount) {
+    std->getBreakpoints(breakpoints);
+
+    double tE = std->getTrEnabledTime();
+    int id = model->places[pIndex].idInMarking;
+    Point p;
+
+    /*
+     * Within a region the level is x = fluid1*s + fluid0 + (t - lowerBoundry(s))*d, so x = amount is a line in the (shifted) s-t frame.
+     * The pieces of the curve change where this line passes a region boundary.
+     */
+    for (unsigned int i = 0; i < std->regionList.size(); i++) {
+        Region *region = std->regionList[i];
+        double d = region->marking->fluidPlaceDeriv[id];
+        double f0 = region->marking->fluid0[id];
+        double f1 = region->marking->fluid1[id];
+        if (IS_ZERO(d) && IS_ZERO(f1))
+            continue;
+
+        Line propLine = IS_ZERO(d) ? Line((amount - f0) / f1) : Line(region->lowerBoundry->a - f1 / d, (amount - f0) / d + region->lowerBoundry->b);
+        if (region->missesBoundingBox(propLine))
+            continue;
+
+        std::vector<Segment*> boundaries;
+        boundaries.push_back(region->lowerBoundry);
+        if (region->leftBoundry != NULL) boundaries.push_back(region->leftBoundry);
+        if (region->rightBoundry != NULL) boundaries.push_back(region->rightBoundry);
+        for (unsigned int j = 0; j < region->eventSegments->size(); j++)
+            boundaries.push_back(region->eventSegments->at(j)->timeSegment);
+
+        for (unsigned int j = 0; j < boundaries.size(); j++) {
+            if (boundaries[j]->intersect(propLine, p))
+                breakpoints.push_back(p.Y + tE);
         }
     }
-    return prob;
+
+    /*
+     * Between two deterministic events the level is fluid0 + (t - time of previous event)*d.
+     */
+    for (unsigned int cc = 0; cc < std->dtrmEventList.size(); cc++) {
+        Marking *marking = std->dtrmEventList[cc]->preRegionMarking;
+        double tPrev = (cc == 0) ? 0 : std->dtrmEventList[cc - 1]->time;
+        double d = marking->fluidPlaceDeriv[id];
+        if (IS_ZERO(d))
+            continue;
+
+        double tCross = tPrev + (amount - marking->fluid0[id]) / d;
+        if (tCross > tPrev && tCross < std->dtrmEventList[cc]->time)
+            breakpoints.push_back(tCross);
+    }
+
+    std::sort(breakpoints.begin(), breakpoints.end());
+
+    unsigned int n = 0;
+    for (unsigned int i = 0; i < breakpoints.size(); i++) {
+        if (breakpoints[i] < 0 || breakpoints[i] > model->MaxTime)
+            continue;
+        if (n > 0 && IS_ZERO(breakpoints[i] - breakpoints[n - 1]))
+            continue;
+        breakpoints[n++] = breakpoints[i];
+    }
+    breakpoints.resize(n);
+}
+
+bool ModelChecker::calcExactProbCurve(std::vector<ProbCurveSegment> &segments, int pIndex, double amount) {
+    std::vector<double> breakpoints;
+    getContBreakpoints(breakpoints, pIndex, amount);
+
+    segments.clear();
+    for (unsigned int i = 1; i < breakpoints.size(); i++) {
+        if (!fitProbCurveSegment(segments, breakpoints[i - 1], breakpoints[i], pIndex, amount, 0))
+            return false;
+    }
+    return true;
+}
+
+/*
+ * The affine bounds are fitted through samples just inside both ends of the piece, and checked at several interior
+ * points. A kink anywhere in the piece moves the bounds off the line through the ends, so a failing check means a
+ * breakpoint was missed, in which case the piece is split in two. An unbounded end has to be unbounded, with the same
+ * sign, at all samples.
+ */
+bool ModelChecker::fitProbCurveSegment(std::vector<ProbCurveSegment> &segments, double tStart, double tEnd, int pIndex, double amount, int depth) {
+    const int maxDepth = 30;
+    const double fitPrec = 1.0e-7;
+    // The fractions of the piece at which it is sampled: the two fit points, then the check points
+    static const int SAMPLES = 5;
+    static const double fractions[SAMPLES] = {1.0e-6, 1 - 1.0e-6, 0.25, 0.5, 0.75};
+
+    if (tEnd - tStart < ZERO_PREC)
+        return true;
+
+    double times[SAMPLES];
+    IntervalSet *iSets[SAMPLES];
+    for (int k = 0; k < SAMPLES; k++) {
+        times[k] = tStart + fractions[k] * (tEnd - tStart);
+        iSets[k] = calcAtomContISetAtTime(times[k], pIndex, amount);
+    }
+
+    ProbCurveSegment segment;
+    segment.tStart = tStart;
+    segment.tEnd = tEnd;
+
+    bool fits = true;
+    for (int k = 1; k < SAMPLES; k++) {
+        fits = fits && iSets[k]->intervals.size() == iSets[0]->intervals.size();
+    }
+    for (unsigned int i = 0; fits && i < iSets[0]->intervals.size(); i++) {
+        double slope[2], intercept[2];
+        for (int e = 0; fits && e < 2; e++) {
+            double ends[SAMPLES];
+            for (int k = 0; k < SAMPLES; k++) {
+                ends[k] = e == 0 ? iSets[k]->intervals[i].start : iSets[k]->intervals[i].end;
+            }
+
+            if (isinf(ends[0])) {
+                slope[e] = 0;
+                intercept[e] = ends[0];
+                for (int k = 1; k < SAMPLES; k++) {
+                    fits = fits && ends[k] == ends[0];
+                }
+            } else {
+                slope[e] = (ends[1] - ends[0]) / (times[1] - times[0]);
+                intercept[e] = ends[0] - slope[e] * times[0];
+                for (int k = 1; k < SAMPLES; k++) {
+                    fits = fits && !isinf(ends[k]) && fabs(slope[e] * times[k] + intercept[e] - ends[k]) <= fitPrec * (1 + fabs(ends[k]));
+                }
+            }
+        }
+        if (fits) {
+            AffineInterval interval = {slope[0], intercept[0], slope[1], intercept[1]};
+            segment.intervals.push_back(interval);
+        }
+    }
+
+    for (int k = 0; k < SAMPLES; k++) {
+        delete iSets[k];
+    }
+
+    if (fits) {
+        segments.push_back(segment);
+        return true;
+    }
+    if (depth >= maxDepth)
+        return false;
+    double tm = (tStart + tEnd) / 2;
+    return fitProbCurveSegment(segments, tStart, tm, pIndex, amount, depth + 1) &&
+           fitProbCurveSegment(segments, tm, tEnd, pIndex, amount, depth + 1);
 }
 
 bool ModelChecker::parseFML(Formula *&fullFML, QString rawFormula) {
@@ -369,21 +470,19 @@ bool ModelChecker::parseFML(Formula *&fullFML, QString rawFormula) {
      * Use Flex + Bison
      * Flex (Lexer) : Scans the lines and transforms it into tokens.
      * Bison (Parser) : Creates the datastructure of the AST and gives initial values to the different type of formulas.
+     * The lexer and the parser keep all their state in the context, so every formula is parsed on its own.
      */
-    struct yy_buffer_state* bufferState;
-    bufferState = yy_scan_string(rawFormula.toUtf8().data());
-    yyparse();
-    yy_delete_buffer(bufferState);
-//    yylex_destroy();
-    reset_lexer();
-
-    if (getColError() == -1) {
+    QByteArray utf8Formula = rawFormula.toUtf8();
+    FormulaParseContext context;
+    parseFormula(utf8Formula.data(), &context);
+
+    if (context.errorColumn == -1) {
         //guic->addText("The formula is succesfully parsed.");
     } else {
-        guic->addError(QString("Syntax error for character %1 in formula %2: The formula could not be parsed.").arg(getColError()).arg(rawFormula).toStdString());
+        guic->addError(QString("Syntax error for character %1 in formula %2: The formula could not be parsed.").arg(context.errorColumn).arg(rawFormula).toStdString());
         return false;
     }
-    fullFML = parser_results();
+    fullFML = context.formula;
 
 return true;
 }
@@ -393,11 +492,11 @@ bool ModelChecker::traverseFML(bool &res, Formula *fullFML) {
      * TODO: Traverse through the STL formula
      * Strategies is post-order
      */
-    IntervalSet *iSetLeft = new IntervalSet();
-    IntervalSet *iSetRight = new IntervalSet();
+    IntervalSet *iSetLeft = 0;
+    IntervalSet *iSetRight = 0;
     res = false;
     if (fullFML->getLeftChild() != 0) { if (!traverseISetFML(iSetLeft,fullFML->getLeftChild())) return false; }
-    if (fullFML->getRightChild() != 0) { if (!traverseISetFML(iSetRight,fullFML->getRightChild())) return false; }
+    if (fullFML->getRightChild() != 0) { if (!traverseISetFML(iSetRight,fullFML->getRightChild())) { delete iSetLeft; return false; } }
 
     /*
      * Actual actions of the formulas
@@ -406,108 +505,164 @@ bool ModelChecker::traverseFML(bool &res, Formula *fullFML) {
         double resProb = calcProb(iSetLeft,0.00);
         std::cout << "Probability:" << resProb << std::endl;
         guic->addText(QString("Probability : %1").arg(resProb).toStdString());
-        switch (((ProbFormula*)fullFML)->getOp())
-        {
-        case LEQ :
-            res = (resProb <= ((ProbFormula*)fullFML)->getProb());
-            break;
-        case LESSER :
-            res = (resProb < ((ProbFormula*)fullFML)->getProb());
-            break;
-        case GREATER :
-            res = (resProb > ((ProbFormula*)fullFML)->getProb());
-            break;
-        case GEQ :
-            res = (resProb >= ((ProbFormula*)fullFML)->getProb());
-            break;
-        }
+        res = probSatisfies(resProb, (ProbFormula*)fullFML);
     }
     delete iSetLeft;
     delete iSetRight;
     return true;
 }
 
+bool ModelChecker::probSatisfies(double prob, ProbFormula *probFML) {
+    switch (probFML->getOp())
+    {
+    case LEQ :
+        return (prob <= probFML->getProb());
+    case LESSER :
+        return (prob < probFML->getProb());
+    case GREATER :
+        return (prob > probFML->getProb());
+    case GEQ :
+        return (prob >= probFML->getProb());
+    }
+    return false;
+}
+
 bool ModelChecker::traverseISetFML(IntervalSet *&res, Formula *fullFML) {
+    FormulaPlan plan(fullFML);
+    return evaluatePlan(res, plan);
+}
+
+bool ModelChecker::evaluatePlan(IntervalSet *&res, FormulaPlan &plan) {
+    res = 0;
+    if (!evaluatePlan(plan) || plan.getRoot() == -1) return false;
+    res = new IntervalSet(*plan.getCached(plan.getRoot()));
+    return true;
+}
+
+bool ModelChecker::evaluatePlan(FormulaPlan &plan) {
+    plan.setCheckTime(ttc);
+
     /*
-     * TODO: Traverse through the STL formula
-     * Strategies is post-order
+    * Since parser does not know anything about the model the placeIndeces need to be discovered.
+    */
+    for (unsigned int k = 0; k < plan.getAtoms().size(); k++) {
+        Formula *atom = plan.getAtoms()[k];
+        if (atom->getType() == DISCRETE && !((AtomDisFormula*)atom)->setPlaceIndex(model)) {
+            guic->addError(QString("There is an incorrect fluid place name called '%1' in your formula.").arg(((AtomDisFormula*)atom)->getPlaceName()).toStdString());
+            return false;
+        }
+        if (atom->getType() == CONTINUOUS && !((AtomContFormula*)atom)->setPlaceIndex(model)) {
+            guic->addError(QString("There is an incorrect fluid place name called '%1' in your formula.").arg(((AtomContFormula*)atom)->getPlaceName()).toStdString());
+            return false;
+        }
+    }
+
+    /*
+     * The atomic formulas are evaluated together, in one pass over the regions.
      */
-    res = 0;
-    IntervalSet *iSetLeft = new IntervalSet();
-    IntervalSet *iSetRight = new IntervalSet();
-    if (fullFML->getLeftChild() != 0) { if (!traverseISetFML(iSetLeft, fullFML->getLeftChild())) return false; }
-    if (fullFML->getRightChild() != 0) { if (!traverseISetFML(iSetRight,fullFML->getRightChild())) return false; }
+    std::vector<int> atomNodes;
+    std::vector<Formula*> atoms;
+    for (int node = 0; node < plan.getNodeCount(); node++) {
+        const FormulaPlan::PlanNode &planNode = plan.getNode(node);
+        if (!planNode.needed || plan.getCached(node) != 0) continue;
+        if (planNode.type != DISCRETE && planNode.type != CONTINUOUS) continue;
+        atomNodes.push_back(node);
+        atoms.push_back(planNode.formula);
+    }
+    AtomBitmaps atomBitmaps;
+    std::vector<RegionBitmap> bitmaps(plan.getNodeCount());
+    if (!atoms.empty()) {
+        std::vector<IntervalSet*> iSets;
+        calcAtomISetsAtTime(iSets, ttc, atoms, &atomBitmaps);
+        for (unsigned int k = 0; k < atomNodes.size(); k++) {
+            plan.setCached(atomNodes[k], iSets[k]);
+            if (atomBitmaps.whole[k]) bitmaps[atomNodes[k]] = atomBitmaps.holds[k];
+        }
+    }
+
     /*
-     * Actual actions of the formulas
+     * The children of a node precede it, so a single pass in order evaluates every other needed node once. A node
+     * that has a bitmap only gets a satisfaction set if it is a formula of the plan or when a parent needs it.
      */
+    for (int node = 0; node < plan.getNodeCount(); node++) {
+        const FormulaPlan::PlanNode &planNode = plan.getNode(node);
+        if (!planNode.needed || plan.getCached(node) != 0) continue;
 
-    if (iSetLeft == 0 || iSetRight == 0) {
-        return false;
+        if (!atoms.empty() && evaluateBitmap(bitmaps, planNode, node, atomBitmaps.cells.size())) {
+            if (planNode.formulaRoot) getNodeISet(plan, node, bitmaps, atomBitmaps.cells);
+            continue;
+        }
+
+        Formula *fullFML = planNode.formula;
+        IntervalSet *iSet = 0;
+        switch (planNode.type)
+        {
+        case TT: if(!iSetTT(iSet)) return false;
+        break;
+        case AND:
+            if (planNode.left != -1 && planNode.right != -1) {
+                IntervalSet *left = getNodeISet(plan, planNode.left, bitmaps, atomBitmaps.cells);
+                IntervalSet *right = getNodeISet(plan, planNode.right, bitmaps, atomBitmaps.cells);
+                if(!iSetAnd(iSet,left,right)) return false;
+            }
+        break;
+        case NEG:
+            if (planNode.left != -1) {
+                if (!iSetNeg(iSet,getNodeISet(plan, planNode.left, bitmaps, atomBitmaps.cells))) return false;
+            }
+        break;
+        case UNTIL:
+            if (planNode.left != -1 && planNode.right != -1) {
+                Interval bound = ((UntilFormula*)fullFML)->getBound();
+                /*
+                 * Start the Until procedure with polygons.
+                 */
+                if(!until(iSet,fullFML->getLeftChild(),fullFML->getRightChild(),bound,plan.getUntilCache(node))) return false;
+            }
+        break;
+        default:
+            guic->addError("An unknown formula is detected.");
+        break;
+        }
+
+        if (iSet == 0) return false;
+        plan.setCached(node, iSet);
     }
+    return true;
+}
 
-    switch (fullFML->getType())
+bool ModelChecker::evaluateBitmap(std::vector<RegionBitmap> &bitmaps, const FormulaPlan::PlanNode &planNode, int node, unsigned int cellCount) {
+    switch (planNode.type)
     {
-    case DISCRETE:
-        /*
-        * Since parser does not know anything about the model the placeIndeces need to be discovered.
-        */
-        if (((AtomDisFormula*)fullFML)->setPlaceIndex(model)) {
-            if(!iSetAtomDis(res,(AtomDisFormula*)fullFML)) return false;
-        } else {
-            guic->addError(QString("There is an incorrect fluid place name called '%1' in your formula.").arg(((AtomDisFormula*)fullFML)->getPlaceName()).toStdString());
-            res = 0;
-        }
-    break;
-    case CONTINUOUS:
-        /*
-        * Since parser does not know anything about the model the placeIndeces need to be discovered.
-        */
-        if (((AtomContFormula*)fullFML)->setPlaceIndex(model)) {
-            if (!iSetAtomCont(res,(AtomContFormula*)fullFML)) return false;
-        } else {
-            guic->addError(QString("There is an incorrect fluid place name called '%1' in your formula.").arg(((AtomContFormula*)fullFML)->getPlaceName()).toStdString());
-            res = 0;
-        }
-    break;
-    case TT: if(!iSetTT(res)) return false;
-    break;
+    case TT:
+        bitmaps[node] = RegionBitmap(cellCount);
+        bitmaps[node].setAll();
+        return true;
     case AND:
-        if (fullFML->getLeftChild() != 0 && fullFML->getRightChild() != 0) {
-            IntervalSet *iSetLeft = new IntervalSet();
-            if(!traverseISetFML(iSetLeft,fullFML->getLeftChild())) return false;
-            IntervalSet *iSetRight = new IntervalSet();
-            if(!traverseISetFML(iSetRight,fullFML->getRightChild())) return false;
-            if(!iSetAnd(res,iSetLeft,iSetRight)) return false;
-            delete iSetLeft;
-            delete iSetRight;
-        }
-    break;
+        if (planNode.left == -1 || planNode.right == -1) return false;
+        if (bitmaps[planNode.left].getSize() == 0 || bitmaps[planNode.right].getSize() == 0) return false;
+        bitmaps[node] = bitmaps[planNode.left];
+        bitmaps[node].andWith(bitmaps[planNode.right]);
+        return true;
     case NEG:
-        if (fullFML->getLeftChild() != 0) {
-            IntervalSet *iSetLeft = new IntervalSet();
-            if(!traverseISetFML(iSetLeft,fullFML->getLeftChild())) return false;
-            if (!iSetNeg(res,iSetLeft)) return false;
-            delete iSetLeft;
-        }
-    break;
-    case UNTIL:
-        if (fullFML->getLeftChild() != 0 && fullFML->getRightChild() != 0) {
-            Interval bound = ((UntilFormula*)fullFML)->getBound();
-            /*
-             * Start the Until procedure with polygons.
-             */
-            if(!until(res,fullFML->getLeftChild(),fullFML->getRightChild(),bound)) return false;
-        }
-    break;
+        if (planNode.left == -1 || bitmaps[planNode.left].getSize() == 0) return false;
+        bitmaps[node] = bitmaps[planNode.left];
+        bitmaps[node].negate();
+        return true;
     default:
-        guic->addError("An unknown formula is detected.");
-        res = 0;
-    break;
+        return false;
     }
+}
 
-    delete iSetLeft;
-    delete iSetRight;
-    return res;
+IntervalSet *ModelChecker::getNodeISet(FormulaPlan &plan, int node, const std::vector<RegionBitmap> &bitmaps, const std::vector<Interval> &cells) {
+    if (plan.getCached(node) == 0 && bitmaps[node].getSize() != 0) {
+        IntervalSet *iSet = new IntervalSet();
+        for (unsigned int c = 0; c < cells.size(); c++) {
+            if (bitmaps[node].test(c)) iSet->intervals.push_back(cells[c]);
+        }
+        plan.setCached(node, iSet);
+    }
+    return plan.getCached(node);
 }
 
 IntervalSet* ModelChecker::calcAtomDisISetAtTime(double time, int pIndex, double amount) {
@@ -601,6 +756,96 @@ IntervalSet* ModelChecker::calcAtomContISetAtTime(double time, int pIndex, doubl
     return iSet;
 }
 
+/*
+ * The regions the time segment crosses are found first, so that the bitmaps know the number of cells.
+ */
+void ModelChecker::calcAtomISetsAtTime(std::vector<IntervalSet*> &iSets, double time, const std::vector<Formula*> &atoms, AtomBitmaps *bitmaps) {
+    TimedDiagram *diagram = TimedDiagram::getInstance();
+    double s1, s2;
+    Point p1, p2;
+
+    iSets.resize(atoms.size());
+    for (unsigned int k = 0; k < atoms.size(); k++)
+        iSets[k] = new IntervalSet();
+
+    // The ends of the part of the time segment in a region are kept in the order in which Region::intersect gives them
+    std::vector<Region*> cellRegions;
+    std::vector<std::pair<double, double> > cellEnds;
+    std::vector<Interval> cells;
+    double sFrameTime = time - diagram->getTrEnabledTime();
+    if (time > diagram->getTrEnabledTime()) {
+        //stochastic part, in the frame with origin at (gTrEnabledTime, gTrEnabledTime) as in calcAtomContISetAtTime.
+        Segment timeSeg(0, sFrameTime , 0, model->MaxTime - diagram->getTrEnabledTime());
+        for (unsigned int i = 0; i < diagram->regionList.size(); i++) {
+            Region *region = diagram->regionList[i];
+            if (!region->intersect(timeSeg, p1, p2)) continue;
+            cellRegions.push_back(region);
+            cellEnds.push_back(std::make_pair(p1.X, p2.X));
+            cells.push_back(Interval(p1.X, p2.X));
+        }
+    }
+
+    if (bitmaps != NULL) {
+        bitmaps->holds.assign(atoms.size(), RegionBitmap(cells.size() + 1));
+        bitmaps->whole.assign(atoms.size(), true);
+    }
+
+    for (unsigned int c = 0; c < cells.size(); c++) {
+        Region *region = cellRegions[c];
+        double t0 = sFrameTime - region->lowerBoundry->b;
+        double t1 = - region->lowerBoundry->a;
+        for (unsigned int k = 0; k < atoms.size(); k++) {
+            s1 = cellEnds[c].first; s2 = cellEnds[c].second;
+            bool holds;
+            if (atoms[k]->getType() == DISCRETE) {
+                AtomDisFormula *atom = (AtomDisFormula*)atoms[k];
+                holds = region->marking->tokens[model->places[atom->getPlaceIndex()].idInMarking] == atom->getN();
+            } else {
+                AtomContFormula *atom = (AtomContFormula*)atoms[k];
+                holds = this->propertyXleqCTest(model, region->marking, t0, t1, s1, s2, atom->getPlaceIndex(), atom->getC());
+            }
+            if (!holds) continue;
+            iSets[k]->intervals.push_back(Interval(s1, s2));
+            if (bitmaps != NULL) {
+                bitmaps->holds[k].set(c);
+                if (s1 != cellEnds[c].first || s2 != cellEnds[c].second) bitmaps->whole[k] = false;
+            }
+        }
+    }
+
+    //determinestic part after g-transition firing
+    int cc;
+    for (cc = 0; (unsigned)cc < diagram->dtrmEventList.size() && time > diagram->dtrmEventList[cc]->time ; cc++);
+    Marking *marking = diagram->dtrmEventList[cc]->preRegionMarking;
+    double t = (cc == 0) ? time : time - diagram->dtrmEventList[cc - 1]->time;
+    double shift = time > diagram->getTrEnabledTime() ? diagram->getTrEnabledTime() : 0;
+
+    double dtrmStart = time > diagram->getTrEnabledTime() ? time : 0;
+    if (bitmaps != NULL) {
+        bitmaps->cells = cells;
+        bitmaps->cells.push_back(Interval(dtrmStart - shift, INFINITY));
+    }
+
+    for (unsigned int k = 0; k < atoms.size(); k++) {
+        s1 = dtrmStart;
+        s2 = INFINITY;
+        bool holds;
+        if (atoms[k]->getType() == DISCRETE) {
+            AtomDisFormula *atom = (AtomDisFormula*)atoms[k];
+            holds = marking->tokens[model->places[atom->getPlaceIndex()].idInMarking] == atom->getN();
+        } else {
+            AtomContFormula *atom = (AtomContFormula*)atoms[k];
+            holds = this->propertyXleqCTest(model, marking, t , 0, s1, s2, atom->getPlaceIndex(), atom->getC());
+        }
+        if (!holds) continue;
+        iSets[k]->intervals.push_back(Interval(s1 - shift, s2 - shift));
+        if (bitmaps != NULL) {
+            bitmaps->holds[k].set(cells.size());
+            if (s1 != dtrmStart || s2 != INFINITY) bitmaps->whole[k] = false;
+        }
+    }
+}
+
 bool ModelChecker::propertyXleqCTest(Model* model, Marking* marking, double t0, double t1, double &s1, double &s2, int pIndex, double amount) {
     /**
      * fluid level in a place is (as+b) + (t1s+t0)d. t1s+t0 is time that has passed after entering this region.
@@ -627,130 +872,4 @@ bool ModelChecker::propertyXleqCTest(Model* model, Marking* marking, double t0,
     return false;
 }
 
-/*
- * The exponential probability density function.
- */
-double ModelChecker::scdfExp(double s){
-    return s != INFINITY ? (1 - exp(-this->lambda*s)) : 1;
-}
-
-/*
- * The uniform probability density function.
- */
-double ModelChecker::scdfUni(double s){
-    double res;
-    if (s < this->a) {
-        res = 0;
-    } else if (s >= this->a && s < this->b) {
-        res = ((s-this->a)/(this->b-this->a));
-    } else if (s >= this->b || s == INFINITY){
-        res = 1;
-    }
-    return res;
-}
-
-/* The general probability density function defined by user.
-The math library supports the following functionalities:
- *
- * -> e (e), log2(e) (log2e), log10(e) (log10e), ln(2) (ln2), ln(10) (ln10), pi (pi),
- * pi / 2 (pi_2), pi / 4 (pi_4), 1 / pi (1_pi), 2 / pi (2_pi), 2 / sqrt(pi) (2_sqrtpi),
- * sqrt(2) (sqrt) and sqrt(1 / 2) (sqrt1_2).
- * -> exponential (exp), logarithmic (log), square root (sqrt), sine (sin), cosine (cos),
- * tangent (tan), cotangent (cot), secant (sec), cosecant (csc), inverse sine (asin),
- * inverse cosine (acos), inverse tangent (atan), inverse cotangent (acot),
- * inverse secant (asec), inverse cosecant (acsc), hyperbolic sine (sinh),
- * cosine (cosh), hyperbolic tangent (tanh), hyperbolic cotangent (coth),
- * hyperbolic secant (sech), hyperbolic cosecant (csch), hyperbolic inverse sine (asinh),
- * hyperbolic inverse cosine (acosh), hyperbolic inverse tangent (atanh),
- * hyperbolic inverse cotangent (acoth), hyperbolic inverse secant (asech),
- * hyperbolic inverse cosecant (acsch), absolute value (abs),
- * Heaviside step function (step) with value 1 defined for x = 0,
- * Dirac delta function with infinity (delta) and not-a-number (nandelta)
- * values defined for x = 0, and error function (erf).
- * -> unary minus ('-'),addition ('+'), subtraction ('+'), multiplication ('*'),
- * division multiplication ('/') and exponentiation ('^')
- * -> Parenthesis ('(' and ')') could be used to change priority order
- *
- * For more details visit: http://www.gnu.org/software/libmatheval/manual/libmatheval.html
- */
-double ModelChecker::scdfGen(double s){
-    char *names[] = { "s" };
-    double values[] = { s };
-
-    return s != INFINITY ? evaluator_evaluate (this->f, sizeof(names)/sizeof(names[0]), names, values) : 1;
-}
-
-int ModelChecker::scdfGammaFact(int n){
-    if (n == 0)
-        return 1;
-    else
-        return n*scdfGammaFact(n-1);
-}
-
-double ModelChecker::scdfGamma(double s){
-    double res = 0;
-    if (s != INFINITY) {
-        double sum = 0;
-        for (int i = 0; i < this->K; i++){
-            sum += (1/scdfGammaFact(i))*pow((s/this->lambda), i)*exp(-s/this->lambda);
-        }
-        res = 1 - sum;
-    } else {
-        res = 1;
-    }
-    return res;
-}
-
-double ModelChecker::scdfNormal(double s){
-    return s != INFINITY ? .5*(1 + erf((s - this->mu)/(sqrt(2.0*this->sigma*this->sigma)))) : 1;
-}
-
-//double scdfTruncatedNormal(double s, FunctionVars* fv){
-//    return s != INFINITY ? (scdfNormal(((s-fv->mu)/fv->sigma),fv) - scdfNormal((fv->mu/fv->sigma),fv))/(1-scdfNormal((fv->mu/fv->sigma)),fv): 1;
-//}
-
-double ModelChecker::scdfFoldedNormal(double s){
-    return s != INFINITY ? .5*(erf((s + this->mu)/(sqrt(2)*this->sigma)) + erf((s - this->mu)/(sqrt(2)*this->sigma))) : 1;
-}
-
-double ModelChecker::scdfDtrm(double s){
-    return (s < this->dtrm) ? 0 : 1;
-}
-
-double ModelChecker::calculateDistributionValue(int distr, char* argument, double randomValue) {
-    switch(distr) {
-        case Exp:
-            return (-1 * log(randomValue)) / atof(argument);
-
-        case Uni:
-            {
-                char *argCopy = new char[strlen(argument)];
-                strcpy(argCopy, argument);
-                char* argFinder = strtok(argCopy, ",");
-                if(argFinder == NULL) {
-                    guic->addError("Invalid first argument for uniform distribution.");
-                    return -1;
-                }
-                double a = atof(argFinder);
-                argFinder = strtok(NULL, ",");
-                if(argFinder == NULL) {
-                    guic->addError("Invalid second argument for uniform distribution.");
-                    return -1;
-                }
-                double b = atof(argFinder);
-                delete argCopy;
-                return a + (b - a) * randomValue;
-            }
-
-        case Dtrm:
-            return atof(argument);
-
-        // TODO: add Gen, Gamma, Norm and FoldedNorm distributions
-
-        default:
-            guic->addError("There is a non-supported distribution for DES in your model.");
-            return -1;
-    }
-}
-
 }
@@ -14,6 +14,10 @@
 #include "TimedDiagram.h"
 #include "GeometryHelper.h"
 #include "DFPN2.h"
+#include "GeneralDistribution.h"
+#include "FormulaPlan.h"
+#include "RegionBitmap.h"
+#include "UntilTraversal.h"
 #include <math.h>
 #include <QString>
 #include <string.h>
@@ -22,21 +26,40 @@ extern "C" {
 #include <matheval.h>
 }
 
-#define yyconst const
 #define STR_EQUAL 0
-typedef struct yy_buffer_state *YY_BUFFER_STATE;
-
-extern int yyparse();
-extern YY_BUFFER_STATE yy_scan_string (yyconst char *yy_str);
-extern class model::Formula *PARSER_FML;
-extern int yylex_destroy (void );
-extern model::Formula* parser_results();
-extern void reset_lexer(void);
-extern int getColError();
-extern void yy_delete_buffer (YY_BUFFER_STATE  b );
 
 namespace model {
 
+/**
+ * One integration interval of the probability curve, with both bounds affine in the check time t:
+ * \f$ [loSlope \cdot t + loIntercept, hiSlope \cdot t + hiIntercept]\f$. An unbounded end has slope 0 and intercept
+ * -INFINITY or INFINITY.
+ */
+struct AffineInterval {
+    double loSlope, loIntercept;
+    double hiSlope, hiIntercept;
+};
+
+/**
+ * A piece of the exact probability curve. For tStart < t < tEnd the probability is
+ * \f$ \sum_i F(hi_i(t)) - F(lo_i(t))\f$, with F the cdf of the general transition.
+ */
+struct ProbCurveSegment {
+    double tStart, tEnd;
+    std::vector<AffineInterval> intervals;
+};
+
+/**
+ * The atomic formulas at a check time as bitmaps over the cells of the s-axis: the parts of the time segment in the
+ * stochastic regions it crosses, followed by the deterministic part after them. An atom is constant in a cell unless
+ * it is continuous and its level reaches the amount inside the cell, in which case its bitmap is not whole.
+ */
+struct AtomBitmaps {
+    std::vector<Interval> cells;
+    std::vector<RegionBitmap> holds; // per atom, the cells in which it holds
+    std::vector<bool> whole; // per atom, whether it holds in the whole of every cell in which it holds
+};
+
 class ModelChecker {
 
 private:
@@ -48,28 +71,50 @@ private:
     Logger *guic;
 
     /*
-     * Helper variables for the spdf functions
+     * The distribution of the general transition, created by setVariables.
+     */
+    GeneralDistribution *distribution;
+
+    /*
+     * The roots of the traversal of the stochastic regions in until: the regions that are entered at the check time or
+     * after a deterministic event, with their potential satisfaction sets.
+     */
+    std::vector<std::pair<Region*, IntervalSet> > untilRoots;
+
+    // The fewest roots per traversal for which until is split over threads
+    static const unsigned int MIN_UNTIL_ROOTS_PER_TRAVERSAL = 16;
+
+    /*
+     * Follows the deterministic regions from the check time for until, by the times at which the operands hold in them.
+     */
+    void visitDtrmRegion(DtrmEvent* dtrmRegion, Formula* psi1, Formula* psi2, double t, Interval bound);
+    void traverseStocRegions(Formula* psi1, Formula* psi2, Interval bound, UntilCache* untilCache);
+
+    /*
+     * Evaluates a TT, AND or NEG node on the bitmaps of its children, if they have one. A node without a bitmap has
+     * one of size 0.
      */
-    double mu;
-    double lambda;
-    double a,b;
-    void *f;
-    double sigma;
-    int K;
-    double dtrm;
-    Distribution distr;
+    bool evaluateBitmap(std::vector<RegionBitmap> &bitmaps, const FormulaPlan::PlanNode &planNode, int node, unsigned int cellCount);
+    /*
+     * The satisfaction set of a node, which is built from its bitmap over the cells if it is not cached yet.
+     */
+    IntervalSet *getNodeISet(FormulaPlan &plan, int node, const std::vector<RegionBitmap> &bitmaps, const std::vector<Interval> &cells);
 
-    IntervalSet* visitStocRegion(Region* region, Formula* psi1, Formula* psi2, IntervalSet* potentialSatSet, double t, Interval bound);
-	IntervalSet* visitDtrmRegion(DtrmEvent* dtrmRegion, Formula* psi1, Formula* psi2, double t, Interval bound);
+    void calcProbsAtTime(std::vector<double> &probs, double time, int pIndex, const std::vector<double> &amounts);
+    bool fitProbCurveSegment(std::vector<ProbCurveSegment> &segments, double tStart, double tEnd, int pIndex, double amount, int depth);
+    void refineProbCurve(std::vector<double> &times, std::vector<std::vector<double> > &probs, double t0, const std::vector<double> &p0, double t1, const std::vector<double> &p1, int pIndex, const std::vector<double> &amounts, double minStep, double tolerance);
 
 public:
 	cv::Mat debugImage;
 	int scale;
 
-    ModelChecker(Model* model, TimedDiagram* std, Logger* guic) {this->model = model; this->std = std; this->guic = guic; geometryHelper = new GeometryHelper(model);};
-    ModelChecker(Model* model, TimedDiagram* std, Logger* guic, double ttc) {this->model = model; this->std = std; this->guic = guic; this->ttc = ttc; geometryHelper = new GeometryHelper(model);};
+    ModelChecker(Model* model, TimedDiagram* std, Logger* guic) {this->model = model; this->std = std; this->guic = guic; geometryHelper = new GeometryHelper(model); distribution = NULL;};
+    ModelChecker(Model* model, TimedDiagram* std, Logger* guic, double ttc) {this->model = model; this->std = std; this->guic = guic; this->ttc = ttc; geometryHelper = new GeometryHelper(model); distribution = NULL;};
 	virtual ~ModelChecker();
 
+    void setCheckTime(double ttc) { this->ttc = ttc; }
+    double getCheckTime() { return this->ttc; }
+
     /*
      * Functions that will calculate the intervalsets by traversal.
      */
@@ -80,20 +125,18 @@ public:
     bool iSetAtomCont(IntervalSet *&res, AtomContFormula* psi1);
 
     /*
-     * The limitations of the until function, due to the clipping of polygons is
-     * that only one atomic formula can be compared to another atomic formula
+     * The operands of until are boolean combinations of atomic formulas and true; an until in an operand is not
+     * supported. In the stochastic regions atomic operands are clipped as convex polygons, combinations as areas of
+     * ClipperLib polygons; in the deterministic regions both are sets of times.
      */
     bool until(IntervalSet *&satSet, Formula* psi1, Formula* psi2, Interval bound);
-
-    IntervalSet* tempUntil(Formula* psi1, Formula* psi2, Interval bound, double time);
-
     /*
-     * Helper function for the until formula
+     * As until, with the polygons of the regions and the regions at the check time taken from a cache, which can be
+     * shared by the check times of a time sweep on the same STD.
      */
-    Polygon* polyNeg(Polygon* poly1);
-    Polygon* polyAnd(Polygon* poly1, Polygon* poly2);
-    Polygon* polyAtomDis(Formula* psi1);
-    Polygon* polyAtomCont(Formula* psi1);
+    bool until(IntervalSet *&satSet, Formula* psi1, Formula* psi2, Interval bound, UntilCache* untilCache);
+
+    IntervalSet* tempUntil(Formula* psi1, Formula* psi2, Interval bound, double time);
 
     /**
      * @brief calcAtomDisISetAtAtTime calculates the intersection at a specific time to check.
@@ -113,6 +156,16 @@ public:
      */
     IntervalSet* calcAtomContISetAtTime(double time, int pIndex, double amount);
 
+    /**
+     * @brief calcAtomISetsAtTime calculates the intervalsets of several atomic formulas at once, in a single pass over
+     * the regions. For each atom the result is the same as that of calcAtomDisISetAtTime or calcAtomContISetAtTime.
+     * @param iSets Output: the intervalset of every atom, owned by the caller.
+     * @param time The time for which probability calculation is being done.
+     * @param atoms The atomic formulas, of type DISCRETE or CONTINUOUS and with their place index set.
+     * @param bitmaps Output if not NULL: the atoms as bitmaps over the cells in which they are evaluated.
+     */
+    void calcAtomISetsAtTime(std::vector<IntervalSet*> &iSets, double time, const std::vector<Formula*> &atoms, AtomBitmaps *bitmaps = NULL);
+
     /**
      * @brief calcProb calculates the probabilities for an intervalset
      * @param iSet The intervalset to integrate over
@@ -122,48 +175,86 @@ public:
      */
     double calcProb(IntervalSet* iSet, double shift);
 
+    /**
+     * @brief calcContProbAtTime calculates the probability that the fluid level of a continuous place is at most amount.
+     * @param time The time for which probability calculation is being done.
+     * @param pIndex The index number of the continuous place.
+     * @param amount The amount of to compare with.
+     * @return The probability \f$ P(x_{pIndex} \leq amount)\f$ at the given time.
+     */
+    double calcContProbAtTime(double time, int pIndex, double amount);
+
+    /**
+     * @brief calcAdaptiveProbCurve samples \f$ P(x_{pIndex} \leq c)\f$ over [0, MaxTime] for every c in amounts.
+     * The curve is evaluated exactly at the breakpoints of the STD (see TimedDiagram::getBreakpoints) and only refined
+     * by bisection in between where the curve deviates from the straight line through its end points.
+     * @param times Output: the sampled times, in increasing order.
+     * @param probs Output: for every sampled time the probabilities, one per amount.
+     * @param pIndex The index number of the continuous place.
+     * @param amounts The amounts to compare with.
+     * @param minStep The smallest time step the refinement may take.
+     * @param tolerance The maximal allowed deviation from linear interpolation between two samples.
+     */
+    void calcAdaptiveProbCurve(std::vector<double> &times, std::vector<std::vector<double> > &probs, int pIndex, const std::vector<double> &amounts, double minStep, double tolerance);
+
+    /**
+     * @brief getContBreakpoints gives the times at which \f$ P(x_{pIndex} \leq amount)\f$ can change its form. These are the
+     * breakpoints of the STD plus the times at which the line \f$ x_{pIndex} = amount\f$ crosses a region boundary.
+     * @param breakpoints Output list, sorted and without duplicates.
+     * @param pIndex The index number of the continuous place.
+     * @param amount The amount of to compare with.
+     */
+    void getContBreakpoints(std::vector<double> &breakpoints, int pIndex, double amount);
+
+    /**
+     * @brief calcExactProbCurve calculates the exact piecewise representation of \f$ P(x_{pIndex} \leq amount)\f$ over [0, MaxTime].
+     * Between two breakpoints the satisfaction set consists of the same intervals, with bounds affine in t.
+     * @param segments Output: the pieces of the curve, in increasing order of time.
+     * @param pIndex The index number of the continuous place.
+     * @param amount The amount of to compare with.
+     * @return false if the affine form of a piece could not be determined.
+     */
+    bool calcExactProbCurve(std::vector<ProbCurveSegment> &segments, int pIndex, double amount);
+
     bool compareProbs(double calculatedProb, double probInput);
 
     bool parseFML(Formula *&fullFML, QString rawFormula);
     bool traverseFML(bool &res, Formula *fullFML);
     bool traverseISetFML(IntervalSet *&res, Formula *fullFML);
 
+    /**
+     * @brief evaluatePlan Calculates the satisfaction set of the root of a plan at the time to check. Every needed node
+     * is evaluated once and cached in the plan, so the subformulas a formula shares are only evaluated once.
+     * @param res Output: the satisfaction set, owned by the caller.
+     * @param plan The plan of the formula, its cache is reused if it belongs to the same time to check.
+     * @return false if a subformula cannot be evaluated, the error is reported to the logger.
+     */
+    bool evaluatePlan(IntervalSet *&res, FormulaPlan &plan);
+
+    /**
+     * @brief evaluatePlan Caches the satisfaction sets of all the formulas of a plan at the time to check. Boolean
+     * combinations of atoms that hold in whole cells are evaluated on bitmaps over the cells (see AtomBitmaps), so
+     * their satisfaction sets are only built for the formulas of the plan and the operands of nodes that need them.
+     * @return false if a subformula cannot be evaluated, the error is reported to the logger.
+     */
+    bool evaluatePlan(FormulaPlan &plan);
+
+    /**
+     * @brief probSatisfies Compares a probability with the bound of a probability formula.
+     */
+    bool probSatisfies(double prob, ProbFormula *probFML);
+
     /*
      * Helper functions as in DFPN2, although this one is more generalised independant.
      */
     bool propertyXleqCTest(Model* model, Marking* marking, double t0, double t1, double &s1, double &s2, int pIndex, double amount);
 
+    /**
+     * @brief setVariables Creates the distribution of the general transition from its df_argument.
+     * @return false if the argument is invalid, the error is reported to the logger.
+     */
     bool setVariables();
-    void setLambda(double lambda) { this->lambda = lambda; }
-    void setAB(double a, double b) { this->a = a; this->b = b; }
-    void setMu(double mu) { this->mu = mu; }
-    void setF(void *f) { this->f = f; }
-    void setSigma(double sigma) { this->sigma = sigma; }
-    void setK(int K) { this->K = K; }
-    void setDtrm(double dtrm) { this->dtrm = dtrm; }
-    void setDistr(Distribution distr) { this->distr = distr; }
-
-    double getLambda() { return this->lambda; }
-    double getA() { return this->a; }
-    double getB() { return this->b; }
-    double getMu() { return this->mu; }
-    void* getF() { return this->f; }
-    double getSigma() { return this->sigma; }
-    int getK() { return this->K; }
-    int getDtrm() { return this->dtrm; }
-
-    Distribution getDistr() { return this->distr; }
-
-    double scdfExp(double s);
-    double scdfUni(double s);
-    double scdfGen(double s);
-    int scdfGammaFact(int n);
-    double scdfGamma(double s);
-    double scdfNormal(double s);
-    double scdfFoldedNormal(double s);
-    double scdfDtrm(double s);
-
-    double calculateDistributionValue(int dist, char* argument, double randomValue);
+    GeneralDistribution *getDistribution() { return this->distribution; }
 };
 
 }
@@ -7,37 +7,193 @@
 
 #include "Polygon.h"
 
+#include <algorithm>
+#include <math.h>
+
 namespace model {
 
+namespace {
+
+/*
+ * The distance of p to the left of the line from a to b, negative to the right of it.
+ */
+double leftDistance(const Point &a, const Point &b, const Point &p) {
+	double dx = b.X - a.X, dy = b.Y - a.Y;
+	return (dx * (p.Y - a.Y) - dy * (p.X - a.X)) / sqrt(dx * dx + dy * dy);
+}
+
+bool samePoint(const Point &p1, const Point &p2) {
+	return IS_ZERO(p1.X - p2.X) && IS_ZERO(p1.Y - p2.Y);
+}
+
+/*
+ * Orders points by their angle around a center.
+ */
+struct AngleOrder {
+	double X, Y;
+
+	bool operator()(const Point &p1, const Point &p2) const {
+		return atan2(p1.Y - Y, p1.X - X) < atan2(p2.Y - Y, p2.X - X);
+	}
+};
+
+}
+
 Polygon::Polygon() {
-	segments = new std::vector<Segment*>();
 }
 
 void Polygon::print() {
-	for (unsigned int i = 0; i < segments->size(); i++){
-		std::cout <<  "(" <<segments->at(i)->p1.X << ", " << segments->at(i)->p1.Y << ") " <<
-				", (" <<segments->at(i)->p2.X << ", " << segments->at(i)->p2.Y << ")" << std::endl;
+	for (unsigned int i = 0; i < vertices.size(); i++){
+		std::cout <<  "(" << vertices[i].X << ", " << vertices[i].Y << ") ";
 	}
+	std::cout << std::endl;
 }
 
 Polygon::~Polygon() {
-    delete segments;
 }
 
-bool Polygon::intersect(Line* l, Point& p1, Point& p2) {
-	int intCnt = 0;
-	Point p;
+void Polygon::setVertices(const std::vector<Point> &points) {
+	vertices.clear();
+	for (unsigned int i = 0; i < points.size(); i++){
+		bool duplicate = false;
+		for (unsigned int j = 0; j < vertices.size() && !duplicate; j++)
+			duplicate = samePoint(points[i], vertices[j]);
+		if (!duplicate) vertices.push_back(points[i]);
+	}
+	if (vertices.empty()) return;
+
+	AngleOrder order;
+	order.X = order.Y = 0;
+	for (unsigned int i = 0; i < vertices.size(); i++){
+		order.X += vertices[i].X / vertices.size();
+		order.Y += vertices[i].Y / vertices.size();
+	}
+	std::sort(vertices.begin(), vertices.end(), order);
+	collapse();
+}
+
+void Polygon::clip(Line &line, bool up) {
+	// Above a line is to the left of it going right, and for a vertical line to the left of it going up
+	Point a, b;
+	if (line.a == INF){
+		a = Point(line.X, 0);
+		b = Point(line.X, 1);
+	}else{
+		a = Point(0, line.b);
+		b = Point(1, line.a + line.b);
+	}
+	if (up) clipLeftOf(a, b);
+	else clipLeftOf(b, a);
+}
+
+void Polygon::clip(Polygon &poly) {
+	if (&poly == this) return;
+	std::vector<Point> halfPlanes;
+	poly.getHalfPlanes(halfPlanes);
+	if (halfPlanes.empty()) vertices.clear();
+	for (unsigned int i = 0; i < halfPlanes.size() && !vertices.empty(); i += 2)
+		clipLeftOf(halfPlanes[i], halfPlanes[i + 1]);
+}
+
+void Polygon::getHalfPlanes(std::vector<Point> &halfPlanes) {
+	const unsigned int n = vertices.size();
+	halfPlanes.clear();
+	if (n == 2){
+		const Point &v0 = vertices[0];
+		const Point &v1 = vertices[1];
+		double dx = v1.X - v0.X, dy = v1.Y - v0.Y;
+		halfPlanes.push_back(v0);
+		halfPlanes.push_back(v1);
+		halfPlanes.push_back(v1);
+		halfPlanes.push_back(v0);
+		halfPlanes.push_back(v0);
+		halfPlanes.push_back(Point(v0.X + dy, v0.Y - dx));
+		halfPlanes.push_back(v1);
+		halfPlanes.push_back(Point(v1.X - dy, v1.Y + dx));
+	}else if (n > 2){
+		for (unsigned int i = 0; i < n; i++){
+			halfPlanes.push_back(vertices[i]);
+			halfPlanes.push_back(vertices[(i + 1) % n]);
+		}
+	}
+}
+
+/*
+ * The vertices lie on one line if they are all within the precision of the line through the two that are farthest
+ * apart in s (or in t if they have the same s).
+ */
+void Polygon::collapse() {
+	if (vertices.size() < 3) return;
+
+	unsigned int first = 0, last = 0;
+	for (unsigned int i = 1; i < vertices.size(); i++){
+		const Point &v = vertices[i];
+		if (v.X < vertices[first].X || (v.X == vertices[first].X && v.Y < vertices[first].Y)) first = i;
+		if (v.X > vertices[last].X || (v.X == vertices[last].X && v.Y > vertices[last].Y)) last = i;
+	}
+	for (unsigned int i = 0; i < vertices.size(); i++){
+		if (fabs(leftDistance(vertices[first], vertices[last], vertices[i])) > ZERO_PREC) return;
+	}
+
+	Point p1 = vertices[first], p2 = vertices[last];
+	vertices.clear();
+	vertices.push_back(p1);
+	vertices.push_back(p2);
+}
+
+/*
+ * Sutherland-Hodgman for one half-plane: a vertex is kept if it is inside, and where an edge crosses the line the
+ * crossing is added.
+ */
+void Polygon::clipLeftOf(const Point &a, const Point &b) {
+	const unsigned int n = vertices.size();
+	if (n == 0 || samePoint(a, b)) return;
 
-    for (int i = 0; (unsigned)i < this->segments->size() && intCnt < 2; i++){
-		if (this->segments->at(i)->intersect(*l, p)){
-			if (intCnt == 0) p1 = p;
-			if (intCnt == 1) p2 = p;
-			intCnt++;
+	buffer.swap(vertices);
+	vertices.clear();
+	double dCur = leftDistance(a, b, buffer[n - 1]);
+	for (unsigned int i = 0; i < n; i++){
+		const Point &cur = buffer[(i + n - 1) % n];
+		const Point &next = buffer[i];
+		double dNext = leftDistance(a, b, next);
+		if ((dCur > ZERO_PREC && dNext < -ZERO_PREC) || (dCur < -ZERO_PREC && dNext > ZERO_PREC)){
+			double u = dCur / (dCur - dNext);
+			Point crossing(cur.X + u * (next.X - cur.X), cur.Y + u * (next.Y - cur.Y));
+			if (vertices.empty() || !samePoint(vertices.back(), crossing)) vertices.push_back(crossing);
 		}
+		if (dNext >= -ZERO_PREC && (vertices.empty() || !samePoint(vertices.back(), next)))
+			vertices.push_back(next);
+		dCur = dNext;
 	}
+	while (vertices.size() > 1 && samePoint(vertices.front(), vertices.back()))
+		vertices.pop_back();
+	collapse();
+}
 
-	if (intCnt < 2) return false;
-	else return true;
+/*
+ * Cyrus-Beck: every edge either lets the segment enter or leave the polygon where it crosses, or keeps all or none of it.
+ */
+bool Polygon::clipSegment(Point &p1, Point &p2, double &u0, double &u1) {
+	std::vector<Point> halfPlanes;
+	getHalfPlanes(halfPlanes);
+	if (halfPlanes.empty()) return false;
+
+	u0 = 0;
+	u1 = 1;
+	for (unsigned int i = 0; i < halfPlanes.size(); i += 2){
+		const Point &a = halfPlanes[i];
+		const Point &b = halfPlanes[i + 1];
+		if (samePoint(a, b)) continue;
+		double d1 = leftDistance(a, b, p1);
+		double d2 = leftDistance(a, b, p2);
+		if (d1 < -ZERO_PREC && d2 < -ZERO_PREC) return false;
+		if (d1 >= -ZERO_PREC && d2 >= -ZERO_PREC) continue;
+		double u = d1 / (d1 - d2);
+		if (d1 < -ZERO_PREC) u0 = std::max(u0, u);
+		else u1 = std::min(u1, u);
+		if (u0 > u1) return false;
+	}
+	return true;
 }
 
 }
@@ -18,17 +18,64 @@ namespace model {
  * Assumptions:
  * 	1) A polygon is consisted of one property line and the region's boundaries.
  * 	2) Polygons are convex.
+ *
+ * The polygon is stored as its vertices in counter-clockwise order in the (s, t) plane. Since it is convex, cutting off
+ * a half-plane (Sutherland-Hodgman) and clipping a segment against it (Cyrus-Beck) take one pass over the vertices.
+ * A polygon without area, such as the edge of a region that is left after cropping at its lower boundary, is kept as
+ * its two end points: the bound of an until is closed, so the paths that only touch it count.
  */
 class Polygon {
 
 public:
-	std::vector<Segment*>* segments;
+	std::vector<Point> vertices;
 
 	void print();
 	Polygon();
 	virtual ~Polygon();
 
-	bool intersect(Line* l, Point &p1, Point &p2);
+	/*
+	 * Sorts points that span a convex polygon counter-clockwise, dropping duplicates.
+	 */
+	void setVertices(const std::vector<Point> &points);
+
+	bool isEmpty() { return vertices.empty(); }
+
+	/*
+	 * Keeps the part of the polygon above the line, in the sense of Line::isUp (left of it for a vertical line), or
+	 * below it. Points within the precision of the line are kept on both sides.
+	 */
+	void clip(Line &line, bool up);
+
+	/*
+	 * Keeps the part of the polygon inside the convex polygon poly.
+	 */
+	void clip(Polygon &poly);
+
+	/*
+	 * The parameters [u0, u1] of the part of the segment from p1 to p2 inside the polygon, as p1 + u (p2 - p1).
+	 * Returns false if the segment misses the polygon.
+	 */
+	bool clipSegment(Point &p1, Point &p2, double &u0, double &u1);
+
+private:
+	// The vertices before the last clip, kept to reuse their memory
+	std::vector<Point> buffer;
+
+	/*
+	 * Keeps the part of the polygon to the left of the line from a to b.
+	 */
+	void clipLeftOf(const Point &a, const Point &b);
+
+	/*
+	 * The polygon as an intersection of half-planes, each to the left of a line from the first point to the second.
+	 * These are the edges, or for a polygon without area its line (from both sides) and the perpendiculars at its ends.
+	 */
+	void getHalfPlanes(std::vector<Point> &halfPlanes);
+
+	/*
+	 * Reduces vertices that lie on one line to the two ends of that line.
+	 */
+	void collapse();
 };
 
 }
@@ -0,0 +1,103 @@
+/**
+ * @file RandomStream.h
+ * @brief Counter-based random numbers (Philox4x32-10), so every simulation run has its own reproducible stream.
+ */
+
+#ifndef RANDOMSTREAM_H
+#define RANDOMSTREAM_H
+
+#include <stdint.h>
+
+namespace model {
+
+/**
+ * @brief The Philox4x32 class is the Philox4x32-10 generator of Salmon et al., "Parallel random numbers: as easy as
+ * 1, 2, 3" (SC'11). It is a keyed bijection of a 128 bit counter, so any element of any stream can be computed
+ * directly, without state shared between threads.
+ */
+class Philox4x32
+{
+public:
+    /**
+     * @brief generate Computes the random block of a counter.
+     * @param counter The 128 bit counter, as four words.
+     * @param key The 64 bit key, as two words.
+     * @param out Output: four independent uniformly distributed words.
+     */
+    static void generate(const uint32_t counter[4], const uint32_t key[2], uint32_t out[4]) {
+        uint32_t c0 = counter[0], c1 = counter[1], c2 = counter[2], c3 = counter[3];
+        uint32_t k0 = key[0], k1 = key[1];
+
+        for (int round = 0; round < ROUNDS; round++) {
+            uint64_t p0 = (uint64_t)MULTIPLIER_0 * c0;
+            uint64_t p1 = (uint64_t)MULTIPLIER_1 * c2;
+            c0 = (uint32_t)(p1 >> 32) ^ c1 ^ k0;
+            c1 = (uint32_t)p1;
+            c2 = (uint32_t)(p0 >> 32) ^ c3 ^ k1;
+            c3 = (uint32_t)p0;
+            k0 += WEYL_0;
+            k1 += WEYL_1;
+        }
+
+        out[0] = c0; out[1] = c1; out[2] = c2; out[3] = c3;
+    }
+
+private:
+    static const int ROUNDS = 10;
+    static const uint32_t MULTIPLIER_0 = 0xD2511F53u;
+    static const uint32_t MULTIPLIER_1 = 0xCD9E8D57u;
+    static const uint32_t WEYL_0 = 0x9E3779B9u;
+    static const uint32_t WEYL_1 = 0xBB67AE85u;
+};
+
+/**
+ * @brief The RandomStream class gives the uniform random numbers of one stream, e.g. one simulation run.
+ * The seed is the key of the generator, the stream number the upper half of the counter and the position in
+ * the stream the lower half. The numbers of a stream therefore only depend on the seed and the stream number,
+ * not on the thread or the order in which the streams are used.
+ */
+class RandomStream
+{
+public:
+    RandomStream(uint64_t seed, uint64_t stream) {
+        key[0] = (uint32_t)seed;
+        key[1] = (uint32_t)(seed >> 32);
+        counter[0] = 0;
+        counter[1] = 0;
+        counter[2] = (uint32_t)stream;
+        counter[3] = (uint32_t)(stream >> 32);
+        used = 4;
+    }
+
+    /**
+     * @brief nextUniform Draws the next number of the stream.
+     * @return A uniformly distributed number with 53 random bits in the open interval (0,1), so that e.g. log(u)
+     * is always finite.
+     */
+    double nextUniform() {
+        uint64_t hi = nextWord();
+        uint64_t lo = nextWord();
+        uint64_t x = (hi << 21) ^ (lo >> 11);
+        return (x + 0.5) * (1.0 / 9007199254740992.0);
+    }
+
+private:
+    uint32_t key[2];
+    uint32_t counter[4];
+    uint32_t block[4];
+    int used; // the number of words of block already returned
+
+    uint32_t nextWord() {
+        if (used == 4) {
+            Philox4x32::generate(counter, key, block);
+            if (++counter[0] == 0)
+                counter[1]++;
+            used = 0;
+        }
+        return block[used++];
+    }
+};
+
+}
+
+#endif // RANDOMSTREAM_H
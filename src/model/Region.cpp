@@ -7,8 +7,20 @@
 
 #include "Region.h"
 
+#include <algorithm>
+
 namespace model {
 
+namespace {
+
+/*
+ * The margin of the bounding box, wider than the rounding errors of the boundary tests, so that the box only rejects
+ * regions that these tests would not find anyway.
+ */
+const double BOX_MARGIN = 1e-6;
+
+}
+
 Region::Region(std::vector<StochasticEvent*> * eventList, Segment * lowerBoundray) {
     successors = new std::vector<Region*>();
 	eventSegments = eventList;
@@ -25,9 +37,42 @@ Region::Region(std::vector<StochasticEvent*> * eventList, Segment * lowerBoundra
 			this->rightBoundry = new Segment(lowerBoundray->p2, eventSegments->at(i)->timeSegment->p2);
         }
 	}
+	computeOutline();
+}
+
+/*
+ * The bounding box is taken from the ends of the boundaries, before the outline merges those that are within the
+ * precision of each other, so that it contains every point at which the boundary tests can find the region.
+ */
+void Region::computeOutline() {
+	std::vector<Point> points;
+	for (unsigned int i = 0; i < eventSegments->size(); i++){
+		points.push_back(eventSegments->at(i)->timeSegment->p1);
+		points.push_back(eventSegments->at(i)->timeSegment->p2);
+	}
+	Segment* boundaries[] = {leftBoundry, rightBoundry, lowerBoundry};
+	for (unsigned int i = 0; i < 3; i++){
+		if (boundaries[i] == NULL) continue;
+		points.push_back(boundaries[i]->p1);
+		points.push_back(boundaries[i]->p2);
+	}
+	outline.setVertices(points);
+
+	minS = minT = INF;
+	maxS = maxT = -INF;
+	for (unsigned int i = 0; i < points.size(); i++){
+		minS = std::min(minS, points[i].X);
+		maxS = std::max(maxS, points[i].X);
+		minT = std::min(minT, points[i].Y);
+		maxT = std::max(maxT, points[i].Y);
+	}
 }
 
 Region::~Region() {
+    // The events and the lower boundary are owned by the TimedDiagram
+    delete eventSegments;
+    delete leftBoundry;
+    delete rightBoundry;
     delete successors;
 }
 
@@ -50,7 +95,24 @@ void Region::print(std::ostream &out) {
 	}
 }
 
+bool Region::missesBoundingBox(Segment& s){
+	return std::max(s.p1.X, s.p2.X) < minS - BOX_MARGIN || std::min(s.p1.X, s.p2.X) > maxS + BOX_MARGIN ||
+			std::max(s.p1.Y, s.p2.Y) < minT - BOX_MARGIN || std::min(s.p1.Y, s.p2.Y) > maxT + BOX_MARGIN;
+}
+
+bool Region::missesBoundingBox(Line& l){
+	if (l.a == INF)
+		return l.X < minS - BOX_MARGIN || l.X > maxS + BOX_MARGIN;
+
+	// The line is linear in s, so over the box it is between its values at the sides
+	double y1 = l.getY(minS), y2 = l.getY(maxS);
+	return std::max(y1, y2) < minT - BOX_MARGIN || std::min(y1, y2) > maxT + BOX_MARGIN;
+}
+
 bool Region::intersect(Segment& s, Point &p1, Point &p2){
+	if (missesBoundingBox(s))
+		return false;
+
 	// Our regions are convex so they will have at most 2 intersection points.
 	int intCnt = 0;
 	Point p;
@@ -86,6 +148,9 @@ bool Region::intersect(Segment& s, Point &p1, Point &p2){
 }
 
 bool Region::intersect(Line& s, Point &p1, Point &p2){
+	if (missesBoundingBox(s))
+		return false;
+
 	// Our regions are convex so they will have at most 2 intersection points.
 	int intCnt = 0;
 	Point p;
@@ -13,6 +13,7 @@
 
 #include "Line.h"
 #include "Event.h"
+#include "Polygon.h"
 
 namespace model {
 
@@ -35,6 +36,13 @@ public:
 	Segment* leftBoundry;
 	Segment* rightBoundry;
 
+	/**
+	 * The outline of the region, its vertices in counter-clockwise order, and its bounding box in (s, t). They are
+	 * computed once, when the region is created by TimedDiagram::createAddRegions; the boundaries do not change after.
+	 */
+	Polygon outline;
+	double minS, maxS, minT, maxT;
+
 	/**
 	 * Each region should have a time bias. which means this is belong to which segment of main stochastic and determinestic line. 
 	 * 
@@ -49,8 +57,22 @@ public:
 
 	void print(std::ostream &out);
 
+	/**
+	 * Whether the segment or line surely misses the region because it misses its bounding box. Otherwise it may still
+	 * miss the region.
+	 */
+	bool missesBoundingBox(Segment& s);
+	bool missesBoundingBox(Line& l);
+
+	/**
+	 * The points where the segment or line crosses the boundaries of the region. A segment or line that misses the
+	 * bounding box is rejected before the boundaries are tested.
+	 */
 	bool intersect(Segment& s, Point &p1, Point &p2);
 	bool intersect(Line& s, Point &p1, Point &p2);
+
+private:
+	void computeOutline();
 };
 
 }
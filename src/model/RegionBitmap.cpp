@@ -0,0 +1,35 @@
+/**
+ * @file RegionBitmap.cpp
+ * @brief A set of numbered cells, such as the regions at a check time, as a bitmap.
+ */
+
+#include "RegionBitmap.h"
+
+namespace model {
+
+RegionBitmap::RegionBitmap(unsigned int size) : words((size + WORD_BITS - 1) / WORD_BITS, 0UL), size(size) {
+}
+
+void RegionBitmap::setAll() {
+    for (unsigned int i = 0; i < words.size(); i++)
+        words[i] = ~0UL;
+    clearPadding();
+}
+
+void RegionBitmap::andWith(const RegionBitmap &other) {
+    for (unsigned int i = 0; i < words.size(); i++)
+        words[i] &= other.words[i];
+}
+
+void RegionBitmap::negate() {
+    for (unsigned int i = 0; i < words.size(); i++)
+        words[i] = ~words[i];
+    clearPadding();
+}
+
+void RegionBitmap::clearPadding() {
+    if (size % WORD_BITS != 0)
+        words.back() &= (1UL << (size % WORD_BITS)) - 1;
+}
+
+}
@@ -0,0 +1,53 @@
+/**
+ * @file RegionBitmap.h
+ * @brief A set of numbered cells, such as the regions at a check time, as a bitmap.
+ */
+
+#ifndef REGIONBITMAP_H
+#define REGIONBITMAP_H
+
+#include <climits>
+#include <vector>
+
+namespace model {
+
+/**
+ * @brief The RegionBitmap class is a set of the cells 0 to size - 1, one bit per cell. The boolean operations on two
+ * bitmaps of the same size work on a machine word of cells at a time.
+ */
+class RegionBitmap
+{
+public:
+    RegionBitmap() : size(0) {}
+    explicit RegionBitmap(unsigned int size);
+
+    unsigned int getSize() const { return size; }
+
+    void set(unsigned int index) { words[index / WORD_BITS] |= 1UL << (index % WORD_BITS); }
+    bool test(unsigned int index) const { return (words[index / WORD_BITS] >> (index % WORD_BITS)) & 1UL; }
+
+    void setAll();
+
+    /**
+     * @brief andWith Keeps the cells that are also in other, which has the same size.
+     */
+    void andWith(const RegionBitmap &other);
+
+    /**
+     * @brief negate Replaces the set by the cells that are not in it.
+     */
+    void negate();
+
+private:
+    static const unsigned int WORD_BITS = sizeof(unsigned long) * CHAR_BIT;
+
+    std::vector<unsigned long> words;
+    unsigned int size;
+
+    // The bits after the last cell are kept 0
+    void clearPadding();
+};
+
+}
+
+#endif // REGIONBITMAP_H
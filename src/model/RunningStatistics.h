@@ -0,0 +1,99 @@
+/**
+ * @file RunningStatistics.h
+ * @brief The running mean and variance of the samples of a simulation estimator.
+ */
+
+#ifndef RUNNINGSTATISTICS_H
+#define RUNNINGSTATISTICS_H
+
+#include <math.h>
+
+namespace model {
+
+/**
+ * @brief The RunningStatistics class keeps the number of samples, their mean and the sum of squared deviations
+ * with Welford's update, which does not suffer from the cancellation of the textbook formula.
+ * Statistics of disjoint sets of samples are combined by merge (Chan et al.), so every thread can keep its own.
+ */
+class RunningStatistics
+{
+public:
+    RunningStatistics() : count(0), mean(0), m2(0) {}
+
+    void add(double x) {
+        count++;
+        double delta = x - mean;
+        mean += delta / count;
+        m2 += delta * (x - mean);
+    }
+
+    void merge(const RunningStatistics &other) {
+        if (other.count == 0)
+            return;
+        if (count == 0) {
+            *this = other;
+            return;
+        }
+        long long total = count + other.count;
+        double delta = other.mean - mean;
+        mean += delta * other.count / total;
+        m2 += other.m2 + delta * delta * ((double)count * other.count / total);
+        count = total;
+    }
+
+    long long getCount() const { return count; }
+    double getMean() const { return mean; }
+
+    /**
+     * @brief getVariance The unbiased sample variance.
+     */
+    double getVariance() const { return count > 1 ? m2 / (count - 1) : 0; }
+
+    /**
+     * @brief getHalfWidth The half-width of the normal confidence interval of the mean, see also getInterval.
+     * @param z The quantile of the standard normal distribution of the confidence level, e.g. 1.96 for 95%.
+     */
+    double getHalfWidth(double z) const { return count > 0 ? z * sqrt(getVariance() / count) : INFINITY; }
+
+    /**
+     * @brief getInterval The confidence interval of a probability of which the samples are estimates. The normal
+     * interval has width 0 when the samples do not vary, e.g. when no run satisfied the property, so the interval is
+     * the Wilson score interval for indicator samples. Otherwise it is the normal interval, which is widened to
+     * z^2 / (runs + z^2) on either side of the mean when the samples do not vary: the width of the Wilson interval of
+     * runs indicators that are all 0, which is about the rule of three (3 / runs) at 95%. Weighted samples can exceed
+     * 1, so the interval is not clipped to [0, 1] here.
+     * @param z The quantile of the confidence level.
+     * @param runs The number of runs of the samples.
+     * @param indicators Whether every sample is whether one run satisfied the property.
+     */
+    void getInterval(double z, long long runs, bool indicators, double &lower, double &upper) const {
+        if (count == 0) {
+            lower = -INFINITY;
+            upper = INFINITY;
+            return;
+        }
+
+        double center = mean;
+        double halfWidth;
+        if (indicators) {
+            double shrink = 1 / (1 + z * z / count);
+            center = shrink * (mean + z * z / (2 * count));
+            halfWidth = shrink * z * sqrt(mean * (1 - mean) / count + z * z / (4.0 * count * count));
+        } else if (m2 > 0) {
+            halfWidth = getHalfWidth(z);
+        } else {
+            halfWidth = z * z / (runs + z * z);
+        }
+        lower = center - halfWidth;
+        upper = center + halfWidth;
+    }
+
+private:
+    long long count;
+    double mean;
+    double m2;
+};
+
+}
+
+#endif // RUNNINGSTATISTICS_H
@@ -0,0 +1,223 @@
+/**
+ * @file Simulator.cpp
+ * @brief Discrete event simulation of single trajectories of an HPnG.
+ */
+
+#include "Simulator.h"
+
+#include <QString>
+#include <algorithm>
+
+namespace model {
+
+Simulator::Simulator(Model *model, Logger *guic) {
+    this->model = model;
+    this->guic = guic;
+    this->marking = allocMarking(model);
+    this->time = 0;
+}
+
+Simulator::~Simulator() {
+    freeMarking(marking);
+}
+
+void Simulator::reset(Marking *initialMarking) {
+    for (int i = 0; i < model->N_discretePlaces; i++)
+        marking->tokens[i] = initialMarking->tokens[i];
+    for (int i = 0; i < model->N_fluidPlaces; i++) {
+        marking->fluid0[i] = initialMarking->fluid0[i];
+        marking->fluid1[i] = 0;
+    }
+    for (int i = 0; i < model->N_determTransitions; i++) {
+        marking->clock0[i] = initialMarking->clock0[i];
+        marking->clock1[i] = 0;
+    }
+    for (int i = 0; i < model->N_generalTransitions; i++) {
+        marking->generalHasFired[i] = initialMarking->generalHasFired[i];
+        marking->generalDisabled[i] = initialMarking->generalDisabled[i];
+    }
+    time = 0;
+}
+
+void Simulator::save(SimulationState &state) const {
+    state.time = time;
+    state.tokens.assign(marking->tokens, marking->tokens + model->N_discretePlaces);
+    state.fluid.assign(marking->fluid0, marking->fluid0 + model->N_fluidPlaces);
+    state.clocks.assign(marking->clock0, marking->clock0 + model->N_determTransitions);
+    state.generalHasFired.assign(marking->generalHasFired, marking->generalHasFired + model->N_generalTransitions);
+    state.generalDisabled.assign(marking->generalDisabled, marking->generalDisabled + model->N_generalTransitions);
+}
+
+void Simulator::restore(const SimulationState &state) {
+    std::copy(state.tokens.begin(), state.tokens.end(), marking->tokens);
+    std::copy(state.fluid.begin(), state.fluid.end(), marking->fluid0);
+    std::copy(state.clocks.begin(), state.clocks.end(), marking->clock0);
+    std::copy(state.generalHasFired.begin(), state.generalHasFired.end(), marking->generalHasFired);
+    std::copy(state.generalDisabled.begin(), state.generalDisabled.end(), marking->generalDisabled);
+    time = state.time;
+}
+
+/*
+ * Returns the time until the next event, with the same precedence as SegmentizeDtrmRegion: an enabled immediate
+ * transition fires at once, otherwise the earliest transition and then the earliest fluid boundary is taken.
+ * If nothing can happen anymore, eventType is MAX_TIME_REACHED and INF is returned.
+ */
+double Simulator::nextEvent(double time, const std::vector<double> &delays, int &eventId, EventType &eventType) {
+    double firstT = INF;
+    eventId = -1;
+    eventType = MAX_TIME_REACHED;
+
+    for (int i = 0; i < model->N_transitions; i++) {
+        if (marking->enabling[i] != 1)
+            continue;
+
+        double dt;
+        switch (model->transitions[i].type) {
+        case TT_IMMEDIATE:
+            eventId = i;
+            eventType = TRANSITION;
+            return 0;
+        case TT_DETERMINISTIC:
+            dt = model->transitions[i].time - marking->clock0[model->transitions[i].idInMarking];
+            break;
+        case TT_GENERAL:
+            if (marking->generalHasFired[model->transitions[i].idInMarking])
+                continue;
+            // The delay counts the enabled time only.
+            dt = delays[model->transitions[i].idInMarking] - (time - marking->generalDisabled[model->transitions[i].idInMarking]);
+            break;
+        default:
+            continue;
+        }
+
+        if (dt < 0)
+            dt = 0;
+        if (dt < firstT) {
+            firstT = dt;
+            eventId = i;
+            eventType = TRANSITION;
+        }
+    }
+
+    for (int i = 0; i < model->N_places; i++) {
+        if (model->places[i].type != PT_FLUID)
+            continue;
+
+        double f = marking->fluid0[model->places[i].idInMarking];
+        double d = marking->fluidPlaceDeriv[model->places[i].idInMarking];
+
+        //if drift is close to zero nothing changes.
+        if (IS_ZERO(d))
+            continue;
+
+        double dt = (d > 0) ? (model->places[i].f_bound - f) / d : -f / d;
+        if (dt < 0)
+            dt = 0;
+        if (dt < firstT) {
+            firstT = dt;
+            eventId = i;
+            eventType = (d > 0) ? PLACE_UPPER_BOUNDRY : PLACE_LOWER_BOUNDRY;
+        }
+    }
+
+    return firstT;
+}
+
+/*
+ * Advances the marking in place by dt time units, like advanceMarking does for a copy.
+ */
+void Simulator::advance(double dt) {
+    for (int i = 0; i < model->N_fluidPlaces; i++)
+        marking->fluid0[i] += marking->fluidPlaceDeriv[i] * dt;
+
+    for (int i = 0; i < model->N_transitions; i++) {
+        Transition &transition = model->transitions[i];
+        if (transition.type == TT_DETERMINISTIC && marking->enabling[i] == 1)
+            marking->clock0[transition.idInMarking] += dt;
+        if (transition.type == TT_GENERAL && marking->enabling[i] == 0 && !marking->generalHasFired[transition.idInMarking])
+            marking->generalDisabled[transition.idInMarking] += dt;
+    }
+}
+
+bool Simulator::simulate(Marking *initialMarking, const std::vector<double> &delays, const std::vector<double> &times, int pIndex, std::vector<double> &levels) {
+    reset(initialMarking);
+    bool crossed;
+    return run(delays, times, pIndex, 0, 0, levels, crossed);
+}
+
+bool Simulator::run(const std::vector<double> &delays, const std::vector<double> &times, int pIndex, int direction, double threshold, std::vector<double> &levels, bool &crossed) {
+    levels.resize(times.size());
+    crossed = false;
+
+    int place = model->places[pIndex].idInMarking;
+    unsigned int next = std::lower_bound(times.begin(), times.end(), time) - times.begin();
+    int eventsAtOnce = 0;
+
+    while (next < times.size()) {
+        // setActFluidRate lowers the actual rates where fluid is shared, so it has to start from the nominal rates.
+        for (int i = 0; i < model->N_transitions; i++) {
+            if (model->transitions[i].type == TT_FLUID)
+                marking->actFluidRate[model->transitions[i].idInMarking] = model->transitions[i].flowRate;
+        }
+        checkEnabled(model, marking);
+        setActFluidRate(model, marking, 0);
+
+        int eventId;
+        EventType eventType;
+        double dt = nextEvent(time, delays, eventId, eventType);
+
+        if (direction != 0) {
+            // The time until the level reaches the threshold, if that happens before the event
+            double f = marking->fluid0[place];
+            double d = marking->fluidPlaceDeriv[place];
+            double toThreshold = INF;
+            if ((direction < 0 && f <= threshold) || (direction > 0 && f >= threshold))
+                toThreshold = 0;
+            else if (!IS_ZERO(d) && (d < 0) == (direction < 0))
+                toThreshold = (threshold - f) / d;
+
+            if (toThreshold <= dt && time + toThreshold <= times.back()) {
+                while (next < times.size() && times[next] <= time + toThreshold) {
+                    levels[next] = f + d * (times[next] - time);
+                    next++;
+                }
+                advance(toThreshold);
+                time += toThreshold;
+                marking->fluid0[place] = threshold;
+                crossed = true;
+                return true;
+            }
+        }
+
+        // The fluid levels are linear until the event.
+        while (next < times.size() && (eventType == MAX_TIME_REACHED || times[next] <= time + dt)) {
+            levels[next] = marking->fluid0[place] + marking->fluidPlaceDeriv[place] * (times[next] - time);
+            next++;
+        }
+        if (eventType == MAX_TIME_REACHED)
+            break;
+
+        if (dt > 0) {
+            eventsAtOnce = 0;
+        } else if (++eventsAtOnce > MAX_EVENTS_AT_ONCE) {
+            guic->addError(QString("The simulation does not progress beyond time %1, since events keep occurring at the same time.").arg(time).toStdString());
+            return false;
+        }
+
+        advance(dt);
+        time += dt;
+
+        if (eventType == TRANSITION) {
+            fireTransition(model, marking, eventId);
+            if (model->transitions[eventId].type == TT_GENERAL)
+                marking->generalHasFired[model->transitions[eventId].idInMarking] = 1;
+        } else {
+            // Put the level exactly on the boundary, so setActFluidRate recognizes it.
+            marking->fluid0[model->places[eventId].idInMarking] = (eventType == PLACE_UPPER_BOUNDRY) ? model->places[eventId].f_bound : 0;
+        }
+    }
+
+    return true;
+}
+
+}
@@ -0,0 +1,146 @@
+/**
+ * @file Simulator.h
+ * @brief Discrete event simulation of single trajectories of an HPnG.
+ */
+
+#ifndef SIMULATOR_H
+#define SIMULATOR_H
+
+#include "DFPN2.h"
+#include "Event.h"
+#include "Logger.h"
+
+#include <vector>
+#include <stdint.h>
+
+namespace model {
+
+/**
+ * @brief The SimulationOptions struct configures how the runs of a DES are executed.
+ */
+struct SimulationOptions
+{
+    SimulationOptions() : randomSeed(true), seed(0), threads(0), halfWidth(0), confidenceLevel(0.95), batchRuns(1000),
+                          antithetic(false), commonRandomNumbers(false), importanceExponent(1),
+                          quasiMonteCarlo(false), replicates(16), splittingLevels(0), splittingEffort(1000),
+                          conditionalMonteCarlo(false) {}
+
+    bool randomSeed; // draw a new seed from /dev/urandom, which is reported so the result can be reproduced
+    uint64_t seed; // the seed of the random streams if randomSeed is false
+    int threads; // the number of threads, or 0 for one per core
+
+    // Sequential mode: instead of a fixed number of runs, runs are added in batches until the confidence interval of
+    // every point is at most halfWidth wide on each side, or the number of runs reaches the maximum.
+    double halfWidth; // the target half-width, or 0 for a fixed number of runs
+    double confidenceLevel; // the confidence level of the intervals, e.g. 0.95
+    int batchRuns; // the number of runs between two checks of the intervals, which is also the minimum
+
+    // Variance reduction, see DESWorker in Facade.cpp.
+    bool antithetic; // simulate pairs of runs with the random numbers v and 1 - v
+    bool commonRandomNumbers; // use the same runs for all constants, instead of new runs for each constant
+    double importanceExponent; // tilt the random numbers of the general transitions to v^(1/alpha), 1 for none
+
+    // Quasi-Monte Carlo: the random numbers of the general transitions are the points of a Sobol sequence, and the
+    // error is estimated from independently shifted replicates of it, so the runs are divided over the replicates. The
+    // interval takes the Student t quantile of replicates - 1 degrees of freedom, which is wide for few replicates.
+    bool quasiMonteCarlo;
+    int replicates;
+
+    // Multilevel splitting (fixed effort) for a rare threshold of the fluid level: the levels between the initial level and
+    // the constant are passed in splittingLevels stages of splittingEffort runs each, 0 levels for plain runs.
+    int splittingLevels;
+    int splittingEffort;
+
+    // Conditional Monte Carlo for several general transitions: only the delays of all but the first general transition
+    // are drawn, and the probability given these delays is computed exactly from the STD of the first one.
+    bool conditionalMonteCarlo;
+};
+
+/**
+ * @brief The SimulationState struct is a copy of the state of a trajectory, from which it can be continued.
+ */
+struct SimulationState
+{
+    double time;
+    std::vector<int> tokens;
+    std::vector<double> fluid;
+    std::vector<double> clocks;
+    std::vector<int> generalHasFired;
+    std::vector<double> generalDisabled;
+};
+
+/**
+ * @brief The Simulator class advances one concrete trajectory of the model with given firing delays of the general
+ * transitions. In every step it determines the earliest of the possible next events (an enabled immediate transition,
+ * a deterministic transition whose clock expires, a general transition whose delay is reached, or a fluid place that
+ * reaches its lower or upper boundary), advances the marking in place to that event and fires it.
+ * The enabling and the fluid rates are computed by checkEnabled and setActFluidRate, exactly as in the STD.
+ *
+ * Like in the STD, a general transition fires at most once. Its delay counts the time it has been enabled,
+ * i.e. the time it was disabled before firing is added (Marking::generalDisabled).
+ */
+class Simulator
+{
+public:
+    Simulator(Model *model, Logger *guic);
+    virtual ~Simulator();
+
+    /**
+     * @brief simulate Simulates one trajectory from the initial marking and records the fluid level of a place.
+     * @param initialMarking The marking at time 0, it is not changed.
+     * @param delays The firing delay of each general transition, indexed by its idInMarking.
+     * @param times The time points to record, in increasing order.
+     * @param pIndex The index of the fluid place to record.
+     * @param levels Output: the fluid level of the place at each of the time points.
+     * @return false if the trajectory does not progress in time (e.g. a loop of immediate transitions).
+     */
+    bool simulate(Marking *initialMarking, const std::vector<double> &delays, const std::vector<double> &times, int pIndex, std::vector<double> &levels);
+
+    /**
+     * @brief reset Starts a trajectory in the initial marking at time 0.
+     */
+    void reset(Marking *initialMarking);
+
+    void save(SimulationState &state) const;
+    void restore(const SimulationState &state);
+
+    double getTime() const { return time; }
+
+    /**
+     * @brief getEnabledTime The time a general transition has been enabled so far.
+     * @param generalIndex The idInMarking of the general transition.
+     */
+    double getEnabledTime(int generalIndex) const { return time - marking->generalDisabled[generalIndex]; }
+    bool hasFired(int generalIndex) const { return marking->generalHasFired[generalIndex] != 0; }
+
+    /**
+     * @brief run Continues the trajectory until the last time point, or until the fluid level of the place crosses a
+     * threshold. Then the level is exactly the threshold and the trajectory can be saved and continued.
+     * @param delays The firing delay of each general transition, indexed by its idInMarking. A delay counts from the
+     * time the transition was first enabled, so it has to be at least getEnabledTime.
+     * @param times The time points to record, in increasing order. Only the points from the current time are recorded.
+     * @param pIndex The index of the fluid place to record.
+     * @param direction -1 to stop when the level is at most the threshold, 1 when it is at least the threshold,
+     * or 0 to run until the last time point.
+     * @param threshold The threshold of the level.
+     * @param levels Output: the fluid level of the place at each of the recorded time points.
+     * @param crossed Output: whether the threshold was reached, at or before the last time point.
+     * @return false if the trajectory does not progress in time (e.g. a loop of immediate transitions).
+     */
+    bool run(const std::vector<double> &delays, const std::vector<double> &times, int pIndex, int direction, double threshold, std::vector<double> &levels, bool &crossed);
+
+private:
+    static const int MAX_EVENTS_AT_ONCE = 100000;
+
+    Model *model;
+    Logger *guic;
+    Marking *marking; // the state of the trajectory, reused for every run
+    double time;
+
+    double nextEvent(double time, const std::vector<double> &delays, int &eventId, EventType &eventType);
+    void advance(double dt);
+};
+
+}
+
+#endif // SIMULATOR_H
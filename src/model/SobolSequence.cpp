@@ -0,0 +1,95 @@
+/**
+ * @file SobolSequence.cpp
+ * @brief The Sobol low discrepancy sequence, used by the DES for quasi-Monte Carlo sampling of the general transitions.
+ */
+
+#include "SobolSequence.h"
+
+namespace model {
+
+namespace {
+
+/*
+ * The primitive polynomials and initial direction numbers of the dimensions 2 to MAX_DIMENSION of new-joe-kuo-6.21201:
+ * the degree s, the coefficients a of the polynomial between the leading and the constant term, and m_1 ... m_s.
+ * The first dimension is the van der Corput sequence.
+ */
+struct DirectionData {
+    int s;
+    unsigned int a;
+    unsigned int m[7];
+};
+
+const DirectionData directionData[SobolSequence::MAX_DIMENSION - 1] = {
+    { 1, 0,  { 1 } },
+    { 2, 1,  { 1, 3 } },
+    { 3, 1,  { 1, 3, 1 } },
+    { 3, 2,  { 1, 1, 1 } },
+    { 4, 1,  { 1, 1, 3, 3 } },
+    { 4, 4,  { 1, 3, 5, 13 } },
+    { 5, 2,  { 1, 1, 5, 5, 17 } },
+    { 5, 4,  { 1, 1, 5, 5, 5 } },
+    { 5, 7,  { 1, 1, 7, 11, 19 } },
+    { 5, 11, { 1, 1, 5, 1, 1 } },
+    { 5, 13, { 1, 1, 1, 3, 11 } },
+    { 5, 14, { 1, 3, 5, 5, 31 } },
+    { 6, 1,  { 1, 3, 3, 9, 7, 49 } },
+    { 6, 13, { 1, 1, 1, 15, 21, 21 } },
+    { 6, 16, { 1, 3, 1, 13, 27, 49 } },
+    { 6, 19, { 1, 1, 1, 15, 7, 5 } },
+    { 6, 22, { 1, 3, 1, 15, 13, 25 } },
+    { 6, 25, { 1, 1, 5, 5, 19, 61 } },
+    { 7, 1,  { 1, 3, 7, 11, 23, 15, 103 } },
+    { 7, 4,  { 1, 3, 7, 13, 13, 15, 69 } }
+};
+
+}
+
+const int SobolSequence::MAX_DIMENSION;
+const int SobolSequence::BITS;
+
+SobolSequence::SobolSequence() : dimension(0) {
+}
+
+bool SobolSequence::setDimension(int dimension) {
+    if (dimension < 1 || dimension > MAX_DIMENSION)
+        return false;
+
+    this->dimension = dimension;
+    directions.assign(dimension * BITS, 0);
+
+    for (int b = 0; b < BITS; b++)
+        directions[b] = 1u << (BITS - 1 - b);
+
+    for (int j = 1; j < dimension; j++) {
+        const DirectionData &data = directionData[j - 1];
+        uint32_t *v = &directions[j * BITS];
+
+        for (int b = 0; b < data.s; b++)
+            v[b] = data.m[b] << (BITS - 1 - b);
+
+        // v_b = a_1 v_{b-1} ^ ... ^ a_{s-1} v_{b-s+1} ^ v_{b-s} ^ (v_{b-s} >> s)
+        for (int b = data.s; b < BITS; b++) {
+            v[b] = v[b - data.s] ^ (v[b - data.s] >> data.s);
+            for (int k = 1; k < data.s; k++) {
+                if ((data.a >> (data.s - 1 - k)) & 1)
+                    v[b] ^= v[b - k];
+            }
+        }
+    }
+    return true;
+}
+
+void SobolSequence::point(uint32_t index, uint32_t *x) const {
+    for (int j = 0; j < dimension; j++) {
+        const uint32_t *v = &directions[j * BITS];
+        uint32_t value = 0;
+        for (int b = 0; b < BITS && (index >> b) != 0; b++) {
+            if ((index >> b) & 1)
+                value ^= v[b];
+        }
+        x[j] = value;
+    }
+}
+
+}
@@ -0,0 +1,50 @@
+/**
+ * @file SobolSequence.h
+ * @brief The Sobol low discrepancy sequence, used by the DES for quasi-Monte Carlo sampling of the general transitions.
+ */
+
+#ifndef SOBOLSEQUENCE_H
+#define SOBOLSEQUENCE_H
+
+#include <stdint.h>
+#include <vector>
+
+namespace model {
+
+/**
+ * @brief The SobolSequence class gives the points of the Sobol sequence with the direction numbers of Joe and Kuo
+ * (new-joe-kuo-6.21201), as 32 bit integers per coordinate. The points are given in their natural order, so that
+ * the first 2^m points are a (t,m,s)-net, i.e. the same set as the first 2^m points in Gray code order.
+ * A random digital shift (an XOR of every coordinate with a random word) keeps these properties and makes every
+ * point uniformly distributed, so independent shifts give independent replicates for error estimation.
+ */
+class SobolSequence
+{
+public:
+    static const int MAX_DIMENSION = 21;
+    static const int BITS = 32;
+
+    SobolSequence();
+
+    /**
+     * @brief setDimension Computes the direction numbers of the first dimension coordinates.
+     * @return false if the dimension is not in [1, MAX_DIMENSION].
+     */
+    bool setDimension(int dimension);
+    int getDimension() const { return dimension; }
+
+    /**
+     * @brief point Computes a point of the sequence.
+     * @param index The index of the point, starting at 0.
+     * @param x Output: the dimension coordinates, the coordinate as a fraction of 2^32.
+     */
+    void point(uint32_t index, uint32_t *x) const;
+
+private:
+    int dimension;
+    std::vector<uint32_t> directions; // the BITS direction numbers of every coordinate
+};
+
+}
+
+#endif // SOBOLSEQUENCE_H
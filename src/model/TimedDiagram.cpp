@@ -24,6 +24,14 @@ void TimedDiagram::clear(){
         delete *it;
     }
 	regionList.clear();
+    for(std::vector<StochasticEvent*>::iterator it = allocatedEvents.begin(); it != allocatedEvents.end(); ++it) {
+        delete *it;
+    }
+    allocatedEvents.clear();
+    for(std::vector<Segment*>::iterator it = allocatedSegments.begin(); it != allocatedSegments.end(); ++it) {
+        delete *it;
+    }
+    allocatedSegments.clear();
 	//instance == NULL;
 }
 
@@ -94,6 +102,8 @@ void TimedDiagram::generateDiagram(Marking* initialMarking) {
 
         Segment* tsLine = new Segment(startPoint, endPoint);
 		StochasticEvent* initEvent = new StochasticEvent(tsLine, TRANSITION);
+        allocatedSegments.push_back(tsLine);
+        allocatedEvents.push_back(initEvent);
 		initEvent->id = gTransitionId(model);
 		initEvent->preRegionMarking = dtrmEventList[j]->postRegionMarking;
         initEvent->preDtrmEvent = dtrmEventList[j];
@@ -276,11 +286,35 @@ void TimedDiagram::segmentizeStochasticRegion(Marking* marking, StochasticEvent*
 
 	Segment* eventLine = eventSeg->timeSegment;
     //std::cout << "P2 : " << eventLine->p2.X << " P1: "<< eventLine->p1.X << std::endl;
-	if (eventLine->p2.Y > model->MaxTime || eventLine->p2.X > model->MaxTime) {
+	if (std::min(eventLine->p1.Y, eventLine->p2.Y) > model->MaxTime || eventLine->p1.X > model->MaxTime) {
         //std::cout << ("\n Maximum time reached") << std::endl;
 		return;
 	}
 
+	/*
+	 * If the event only happens before MaxTime for a part of the s-interval, that part is segmentized. Dropping the
+	 * whole event would leave the s for which it happens before MaxTime without a region after it.
+	 */
+	if (std::max(eventLine->p1.Y, eventLine->p2.Y) > model->MaxTime || eventLine->p2.X > model->MaxTime) {
+		double start = eventLine->p1.X;
+		double end = std::min(eventLine->p2.X, model->MaxTime);
+		if (eventLine->p1.Y > model->MaxTime)
+			start = (model->MaxTime - eventLine->b) / eventLine->a;
+		else if (eventLine->p2.Y > model->MaxTime)
+			end = std::min(end, (model->MaxTime - eventLine->b) / eventLine->a);
+		if (end - start <= ZERO_PREC)
+			return;
+
+		StochasticEvent* clippedEvent = new StochasticEvent(eventSeg);
+		clippedEvent->timeSegment = new Segment(eventLine->a, eventLine->b, start, end);
+		allocatedEvents.push_back(clippedEvent);
+		allocatedSegments.push_back(clippedEvent->timeSegment);
+		clippedEvent->preRegion = eventSeg->preRegion;
+		clippedEvent->preDtrmEvent = eventSeg->preDtrmEvent;
+		eventSeg = clippedEvent;
+		eventLine = clippedEvent->timeSegment;
+	}
+
 	double start = eventLine->p1.X ;
 	double end = eventLine->p2.X;
 
@@ -324,7 +358,7 @@ void TimedDiagram::segmentizeStochasticRegion(Marking* marking, StochasticEvent*
 
 		if ((model->transitions[i].type == TT_IMMEDIATE)) {
 			if (firstT > 0.0) {
-                firstT = 0.0;Region
+                firstT = 0.0;
 				enabledTransitionCache[0] = i;
 				cntFirst = 1;
 				hasImmediateEnabled = 1;
@@ -364,6 +398,8 @@ void TimedDiagram::segmentizeStochasticRegion(Marking* marking, StochasticEvent*
 				model->transitions[trId].time + eventLine->b - b /*+ timeBias*/,
 				start, end);
 			StochasticEvent* detTransEvent = new StochasticEvent(detTransSeg, TRANSITION);
+			allocatedSegments.push_back(detTransSeg);
+			allocatedEvents.push_back(detTransEvent);
 			detTransEvent->id = enabledTransitionCache[i];
 			detTransEvent->preRegionMarking = marking;
 //            detTransSeg->print();
@@ -407,6 +443,7 @@ void TimedDiagram::segmentizeStochasticRegion(Marking* marking, StochasticEvent*
 				double d = drift[model->places[i].idInMarking];
 
 				StochasticEvent* placeEvent = new StochasticEvent();
+				allocatedEvents.push_back(placeEvent);
 				Segment* placeSeg;
 				if (d > ZERO_PREC) {
 
@@ -435,6 +472,7 @@ void TimedDiagram::segmentizeStochasticRegion(Marking* marking, StochasticEvent*
 				}
 
 				placeEvent->timeSegment = placeSeg;
+				allocatedSegments.push_back(placeSeg);
 				
 				placeEvent->id = i;
 				placeEvent->preRegionMarking= marking;
@@ -449,9 +487,6 @@ void TimedDiagram::segmentizeStochasticRegion(Marking* marking, StochasticEvent*
 			std::vector<StochasticEvent*> *nextEvents = new std::vector<StochasticEvent*>();
 			computeNextEvents(potentialEvents, eventLine, nextEvents);
 
-			potentialEvents->clear();
-			delete potentialEvents;
-
             //STDRegion* region = new STDRegion(nextEvents, eventLine);
 			//region->marking = marking;
 			//region->timeBias = timeBias;
@@ -487,10 +522,14 @@ void TimedDiagram::segmentizeStochasticRegion(Marking* marking, StochasticEvent*
 
                 segmentizeStochasticRegion(newMarking, nextEvents->at(i), timeBias);
 			}
+			// The regions have their own lists of the events
+			delete nextEvents;
 		} else {
 
 			Segment* maxSeg = new Segment(0, model->MaxTime, eventLine->p1.X, eventLine->p2.X);
 			StochasticEvent* maxTimeReached = new StochasticEvent(maxSeg, MAX_TIME_REACHED);
+			allocatedSegments.push_back(maxSeg);
+			allocatedEvents.push_back(maxTimeReached);
 			maxTimeReached->preRegionMarking = marking;
 			maxTimeReached->postRegionMarking = marking;
 			maxTimeReached->id = -1;
@@ -510,14 +549,16 @@ void TimedDiagram::segmentizeStochasticRegion(Marking* marking, StochasticEvent*
 
 	}
 
+	delete potentialEvents;
+	delete[] enabledTransitionCache;
 }
 
 void TimedDiagram::computeNextEvents(std::vector<StochasticEvent*> * potentialEvents, Segment *uSegment, std::vector<StochasticEvent*> *nextEvents) {
 
 	std::sort(potentialEvents->begin(), potentialEvents->end(),
 		StochasticEvent::greaterSlopeFirst);
-	Segment* workingSeg = new Segment(uSegment->p1, uSegment->p2);
-	minLines(potentialEvents, workingSeg, nextEvents);
+	Segment workingSeg(uSegment->p1, uSegment->p2);
+	minLines(potentialEvents, &workingSeg, nextEvents);
 }
 
 void TimedDiagram::minLines(std::vector<StochasticEvent*> * potentialEvents, Segment *uSegment, std::vector<StochasticEvent*> * nextEvents){
@@ -561,6 +602,8 @@ void TimedDiagram::minLines(std::vector<StochasticEvent*> * potentialEvents, Seg
 
 		StochasticEvent* sEvent = new StochasticEvent(potentialEvents->at(crntIndex));
 		sEvent->timeSegment = newSegment;
+		allocatedSegments.push_back(newSegment);
+		allocatedEvents.push_back(sEvent);
 
 		nextEvents->push_back(sEvent);
 
@@ -612,6 +655,7 @@ void TimedDiagram::createAddRegions(std::vector<StochasticEvent*> * eventList, S
 				events->push_back(eventList->at(j));
 
 			Segment* lb = new Segment(p1, p2);
+			allocatedSegments.push_back(lb);
             Region* region = new Region(events, lb);
 			region->marking = marking;
 
@@ -692,6 +736,42 @@ double TimedDiagram::calProbAtTime(double time, double (*sPdfInt)(double), bool
 	return prob;
 }
 
+void TimedDiagram::getBreakpoints(std::vector<double> &breakpoints){
+	breakpoints.clear();
+	breakpoints.push_back(0);
+	breakpoints.push_back(model->MaxTime);
+	breakpoints.push_back(gTrEnabledTime);
+
+	for (int i = 0; (unsigned)i < dtrmEventList.size(); i++)
+		breakpoints.push_back(dtrmEventList[i]->time);
+
+	/**
+	 * Regions are stored in the frame with origin at (gTrEnabledTime, gTrEnabledTime), so every vertex is shifted back.
+	 */
+	for (int i = 0; (unsigned)i < regionList.size(); i++){
+		Region* region = regionList[i];
+		breakpoints.push_back(region->lowerBoundry->p1.Y + gTrEnabledTime);
+		breakpoints.push_back(region->lowerBoundry->p2.Y + gTrEnabledTime);
+		for (int j = 0; (unsigned)j < region->eventSegments->size(); j++){
+			breakpoints.push_back(region->eventSegments->at(j)->timeSegment->p1.Y + gTrEnabledTime);
+			breakpoints.push_back(region->eventSegments->at(j)->timeSegment->p2.Y + gTrEnabledTime);
+		}
+	}
+
+	std::sort(breakpoints.begin(), breakpoints.end());
+
+	//remove everything outside [0, MaxTime] and merge points which are numerically the same.
+	unsigned int n = 0;
+	for (int i = 0; (unsigned)i < breakpoints.size(); i++){
+		if (breakpoints[i] < 0 || breakpoints[i] > model->MaxTime)
+			continue;
+		if (n > 0 && IS_ZERO(breakpoints[i] - breakpoints[n - 1]))
+			continue;
+		breakpoints[n++] = breakpoints[i];
+	}
+	breakpoints.resize(n);
+}
+
 void TimedDiagram::saveDiagram(std::string filename){
 
 	const int row = model->MaxTime * scale;
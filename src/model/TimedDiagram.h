@@ -78,6 +78,15 @@ public:
 		return gTrEnabledTime;
 	}
 
+	/**
+	 * @param breakpoints Output list, sorted and without duplicates.
+	 *
+	 * \brief Collects the times in [0, MaxTime] at which a probability curve computed on this diagram can have a kink,
+	 * i.e. the deterministic event times and the t-coordinates of all region vertices (in the main frame).
+	 * Between two consecutive breakpoints the same set of regions is cut by the line \f$ t = const\f$.
+	 */
+	void getBreakpoints(std::vector<double> &breakpoints);
+
 	int getNumberOfRegions(){return regionList.size() + dtrmEventList.size();};
 
 	Model* model;
@@ -105,6 +114,13 @@ private:
      */
     double gTrEnabledTime;
 
+    /**
+     * The events and segments of the stochastic part are shared between regions and with the events they are copied
+     * from, so they are kept here and deleted by clear, like the markings in the register of DFPN2.
+     */
+    std::vector<StochasticEvent*> allocatedEvents;
+    std::vector<Segment*> allocatedSegments;
+
 	void minLines(std::vector<StochasticEvent*> * potentialEvents, Segment* uSegment, std::vector<StochasticEvent*> * nextEvents);
     void createAddRegions(std::vector<StochasticEvent*> * eventList, StochasticEvent * preEvent, Marking* marking);
 
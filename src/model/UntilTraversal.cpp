@@ -0,0 +1,233 @@
+/**
+ * @file UntilTraversal.cpp
+ * @brief The traversal of the stochastic regions of the STD for a time-bounded until.
+ */
+
+#include "UntilTraversal.h"
+
+namespace model {
+
+namespace {
+
+/*
+ * The s-intervals of the part of a segment in an operand, which has a polygon or an area.
+ */
+IntervalSet *getIntersectionIntervals(GeometryHelper *geometryHelper, Polygon *poly, ClipperLib::Polygons *area, Segment *segment) {
+    if (poly != NULL) return geometryHelper->getIntersectionIntervals(poly, segment);
+    if (area != NULL) return geometryHelper->getIntersectionIntervals(*area, segment);
+    return NULL;
+}
+
+}
+
+const double UntilCache::SPAN_MARGIN = 1e-9;
+
+UntilCache::~UntilCache() {
+    for (std::map<Region*, RegionPolygons>::iterator it = polygons.begin(); it != polygons.end(); ++it) {
+        delete it->second.psi1Poly;
+        delete it->second.psi2Poly;
+        delete it->second.psi1Area;
+        delete it->second.psi2Area;
+        delete it->second.psi12Int;
+    }
+}
+
+/*
+ * The polygons are created without holding the lock. If another thread created them for the same region in the
+ * meantime, its polygons are kept and these are dropped.
+ */
+UntilCache::RegionPolygons UntilCache::getPolygons(GeometryHelper *geometryHelper, Region *region, Formula *psi1, Formula *psi2, Interval bound) {
+    {
+        QMutexLocker locker(&mutex);
+        std::map<Region*, RegionPolygons>::iterator it = polygons.find(region);
+        if (it != polygons.end()) return it->second;
+    }
+
+    RegionPolygons created;
+    created.psi1Poly = created.psi2Poly = NULL;
+    created.psi1Area = created.psi2Area = NULL;
+    if (geometryHelper->isConvexFormula(psi1)) created.psi1Poly = createPolygon(geometryHelper, region, psi1, bound);
+    else created.psi1Area = createArea(geometryHelper, region, psi1, bound);
+    if (geometryHelper->isConvexFormula(psi2)) created.psi2Poly = createPolygon(geometryHelper, region, psi2, bound);
+    else created.psi2Area = createArea(geometryHelper, region, psi2, bound);
+
+    created.psi12Int = NULL;
+    if (created.psi1Poly != NULL && created.psi2Poly != NULL) {
+        created.psi12Int = geometryHelper->getIntersectionIntervals(created.psi1Poly, created.psi2Poly);
+    } else if ((created.psi1Poly != NULL || created.psi1Area != NULL) && (created.psi2Poly != NULL || created.psi2Area != NULL)) {
+        ClipperLib::Polygons area1, area2;
+        if (created.psi1Poly != NULL) geometryHelper->toArea(area1, created.psi1Poly);
+        else area1 = *created.psi1Area;
+        if (created.psi2Poly != NULL) geometryHelper->toArea(area2, created.psi2Poly);
+        else area2 = *created.psi2Area;
+        created.psi12Int = geometryHelper->getIntersectionIntervals(area1, area2);
+    }
+
+    QMutexLocker locker(&mutex);
+    std::pair<std::map<Region*, RegionPolygons>::iterator, bool> inserted = polygons.insert(std::make_pair(region, created));
+    if (!inserted.second) {
+        delete created.psi1Poly;
+        delete created.psi2Poly;
+        delete created.psi1Area;
+        delete created.psi2Area;
+        delete created.psi12Int;
+    }
+    return inserted.first->second;
+}
+
+/*
+ * The spans are sorted by their start, so the regions that start by t are a prefix, of which those that have not ended
+ * before t are taken.
+ */
+void UntilCache::getRegionsAt(std::vector<unsigned int> &indices, const std::vector<Region*> &regions, double t) {
+    if (!hasSpans) {
+        hasSpans = true;
+        spans.resize(regions.size());
+        for (unsigned int i = 0; i < regions.size(); i++) {
+            spans[i].start = regions[i]->minT;
+            spans[i].end = regions[i]->maxT;
+            spans[i].index = i;
+        }
+        std::sort(spans.begin(), spans.end());
+    }
+
+    indices.clear();
+    for (unsigned int k = 0; k < spans.size() && spans[k].start <= t + SPAN_MARGIN; k++) {
+        if (spans[k].end >= t - SPAN_MARGIN) indices.push_back(spans[k].index);
+    }
+    std::sort(indices.begin(), indices.end());
+}
+
+Polygon *UntilCache::createPolygon(GeometryHelper *geometryHelper, Region *region, Formula *psi, Interval bound) {
+    Polygon *poly = geometryHelper->createPolygon(region, psi);
+    Polygon *cropped = geometryHelper->cropPolygon(poly, bound.end, DOWN);
+    // The polygon is cropped in place, NULL is returned if nothing is left of it
+    if (cropped != poly) delete poly;
+    return cropped;
+}
+
+ClipperLib::Polygons *UntilCache::createArea(GeometryHelper *geometryHelper, Region *region, Formula *psi, Interval bound) {
+    ClipperLib::Polygons *area = new ClipperLib::Polygons();
+    geometryHelper->createArea(*area, region, psi);
+    // An area has no part without width, so it keeps a sliver above the end of the bound for the paths that reach it there
+    geometryHelper->cropArea(*area, bound.end + GeometryHelper::AREA_PREC, DOWN);
+    if (area->empty()) {
+        delete area;
+        return NULL;
+    }
+    return area;
+}
+
+UntilTraversal::UntilTraversal(GeometryHelper *geometryHelper, UntilCache *untilCache, Formula *psi1, Formula *psi2, Interval bound)
+    : geometryHelper(geometryHelper), untilCache(untilCache), psi1(psi1), psi2(psi2), bound(bound), debugImage(NULL), scale(1) {
+    setAutoDelete(false);
+}
+
+/*
+ * Only the part that was not already propagated through the region is added, and the region is queued by the time at
+ * which the first of the new paths enters it. The successors of a region are entered later, so a region reached from
+ * several predecessors is mostly visited once.
+ */
+void UntilTraversal::enqueue(Region *region, IntervalSet *potentialSatSet) {
+    UntilRegionState &state = states[region];
+    IntervalSet *newPart = potentialSatSet->minus(&state.propagated);
+    if (!newPart->isEmpty()) {
+        state.pending.append(newPart);
+        double s = newPart->intervals.front().start;
+        queue.push(std::make_pair(region->lowerBoundry->getY(s), region));
+    }
+    delete newPart;
+}
+
+void UntilTraversal::run() {
+    while (!queue.empty()) {
+        Region *region = queue.top().second;
+        queue.pop();
+        if (!states[region].pending.isEmpty())
+            visit(region);
+    }
+}
+
+/*
+ * Propagates the pending part of the potential satisfaction set of a region. It satisfies the until where it meets
+ * psi2, and continues to the successors through the part of psi1 it leaves the region in.
+ */
+void UntilTraversal::visit(Region *region) {
+    //TODO:[IMPORTANT assumption] t=0 and bound = [0, MAX_TIME]
+    UntilRegionState &state = states[region];
+
+    IntervalSet *potentialSatSet = new IntervalSet(state.pending);
+    potentialSatSet->removeRedundency();
+    state.pending.clear();
+    state.propagated.append(potentialSatSet);
+    state.propagated.removeRedundency();
+
+    UntilCache::RegionPolygons polygons = untilCache->getPolygons(geometryHelper, region, psi1, psi2, bound);
+    if (debugImage != NULL && !debugImage->empty()) {
+        if (polygons.psi1Poly != NULL) geometryHelper->drawPolygon(*debugImage, polygons.psi1Poly, scale, cv::Scalar(0, 0, 255));
+        if (polygons.psi2Poly != NULL) geometryHelper->drawPolygon(*debugImage, polygons.psi2Poly, scale, cv::Scalar(255, 255, 0));
+        if (polygons.psi1Area != NULL) geometryHelper->drawArea(*debugImage, *polygons.psi1Area, scale, cv::Scalar(0, 0, 255));
+        if (polygons.psi2Area != NULL) geometryHelper->drawArea(*debugImage, *polygons.psi2Area, scale, cv::Scalar(255, 255, 0));
+        cv::Mat flipped;
+        cv::flip(*debugImage, flipped, 0);
+        cv::imshow("test", flipped);
+        cv::waitKey(0);
+    }
+    Polygon *psi1_poly = polygons.psi1Poly;
+    Polygon *psi2_poly = polygons.psi2Poly;
+
+    // First interval set.
+    if (psi2_poly != NULL || polygons.psi2Area != NULL) {
+        for (unsigned int i = 0; i < potentialSatSet->intervals.size(); i++) {
+            Point p1(potentialSatSet->intervals.at(i).start, region->lowerBoundry->getY(potentialSatSet->intervals.at(i).start));
+            Point p2(potentialSatSet->intervals.at(i).end, region->lowerBoundry->getY(potentialSatSet->intervals.at(i).end));
+            Segment seg(p1, p2);
+
+            IntervalSet *psi2_Int = getIntersectionIntervals(geometryHelper, psi2_poly, polygons.psi2Area, &seg);
+            satSet.append(psi2_Int);
+            delete psi2_Int;
+        }
+    }
+
+    if (psi1_poly != NULL || polygons.psi1Area != NULL) {
+        IntervalSet *psi1_Int = new IntervalSet();
+        // Second interval set.
+        for (unsigned int i = 0; i < potentialSatSet->intervals.size(); i++) {
+            Point p1(potentialSatSet->intervals.at(i).start, region->lowerBoundry->getY(potentialSatSet->intervals.at(i).start));
+            Point p2(potentialSatSet->intervals.at(i).end, region->lowerBoundry->getY(potentialSatSet->intervals.at(i).end));
+            Segment seg(p1, p2);
+
+            IntervalSet *segInt = getIntersectionIntervals(geometryHelper, psi1_poly, polygons.psi1Area, &seg);
+            psi1_Int->append(segInt);
+            delete segInt;
+            // In general case here the psi1_poly should be reformed.
+        }
+        psi1_Int->removeRedundency();
+
+        if (polygons.psi12Int != NULL) {
+            IntervalSet *psi12_sat = psi1_Int->intersect(polygons.psi12Int);
+            satSet.append(psi12_sat);
+            delete psi12_sat;
+        }
+
+        // Third set of intervals.
+        satSet.removeRedundency();
+        for (unsigned int i = 0; i < region->successors->size(); i++) {
+            IntervalSet *potPsi1_int = getIntersectionIntervals(geometryHelper, psi1_poly, polygons.psi1Area, region->successors->at(i)->lowerBoundry);
+            if (potPsi1_int != NULL) {
+                IntervalSet *notSat = potPsi1_int->minus(&satSet);
+                IntervalSet *potential = notSat->intersect(psi1_Int);
+                if (!potential->isEmpty())
+                    enqueue(region->successors->at(i), potential);
+                delete potential;
+                delete notSat;
+                delete potPsi1_int;
+            }
+        }
+        delete psi1_Int;
+    }
+
+    delete potentialSatSet;
+}
+
+}
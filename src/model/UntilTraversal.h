@@ -0,0 +1,148 @@
+/**
+ * @file UntilTraversal.h
+ * @brief The traversal of the stochastic regions of the STD for a time-bounded until.
+ */
+
+#ifndef UNTILTRAVERSAL_H
+#define UNTILTRAVERSAL_H
+
+#include "Formula.h"
+#include "GeometryHelper.h"
+#include "IntervalSet.h"
+#include "Region.h"
+
+#include <QMutex>
+#include <QRunnable>
+#include <algorithm>
+#include <map>
+#include <queue>
+#include <vector>
+
+namespace model {
+
+/**
+ * @brief The UntilCache class keeps the parts of one until that do not depend on the check time, so that they are shared
+ * by all check times on one STD: the psi1 and psi2 polygons of the regions and the intervals where they meet (they are
+ * cropped at the end of the bound), and the time spans of the regions, by which the regions at a check time are found.
+ * An operand that is a boolean combination has an area of ClipperLib polygons instead of a convex polygon.
+ */
+class UntilCache
+{
+public:
+    struct RegionPolygons {
+        Polygon *psi1Poly;
+        Polygon *psi2Poly;
+        ClipperLib::Polygons *psi1Area;
+        ClipperLib::Polygons *psi2Area;
+        IntervalSet *psi12Int;
+    };
+
+    UntilCache() : hasSpans(false) {}
+    virtual ~UntilCache();
+
+    /**
+     * @brief getPolygons The polygons of a region, which are created on first use. The cache keeps ownership of them.
+     * It may be called by several threads at once.
+     */
+    RegionPolygons getPolygons(GeometryHelper *geometryHelper, Region *region, Formula *psi1, Formula *psi2, Interval bound);
+
+    /**
+     * @brief getRegionsAt The indices of the regions whose time span contains the time t, in increasing order. These
+     * include all regions that the line of time t intersects. The spans are computed at the first call, so the regions
+     * have to be the same at every call.
+     */
+    void getRegionsAt(std::vector<unsigned int> &indices, const std::vector<Region*> &regions, double t);
+
+private:
+    // The margin of a time span, so that the regions the line touches at the ends of their spans are included
+    static const double SPAN_MARGIN;
+
+    /*
+     * The time span of a region: the t-range of its bounding box.
+     */
+    struct RegionSpan {
+        double start, end;
+        unsigned int index;
+
+        bool operator<(const RegionSpan &other) const { return start < other.start; }
+    };
+
+    std::map<Region*, RegionPolygons> polygons;
+    QMutex mutex;
+    std::vector<RegionSpan> spans; // by start
+    bool hasSpans;
+
+    static Polygon *createPolygon(GeometryHelper *geometryHelper, Region *region, Formula *psi, Interval bound);
+    static ClipperLib::Polygons *createArea(GeometryHelper *geometryHelper, Region *region, Formula *psi, Interval bound);
+
+    // A cache is only shared by reference
+    UntilCache(const UntilCache &);
+    UntilCache &operator=(const UntilCache &);
+};
+
+/**
+ * @brief The UntilTraversal class follows the paths of psi1 U psi2 through the stochastic regions, starting from root
+ * regions with a potential satisfaction set each: the s-values for which the path has satisfied psi1 so far and enters
+ * the region. A region reached from several predecessors is visited with the union of their potential satisfaction
+ * sets, and its polygons are taken from a cache.
+ *
+ * A traversal only reads the STD and has its own satisfaction set, so traversals of disjoint sets of roots can run on
+ * the threads of a pool; the union of their satisfaction sets is that of one traversal of all roots.
+ */
+class UntilTraversal : public QRunnable
+{
+public:
+    UntilTraversal(GeometryHelper *geometryHelper, UntilCache *untilCache, Formula *psi1, Formula *psi2, Interval bound);
+
+    /**
+     * @brief enqueue Adds a potential satisfaction set to a region, to be propagated by run.
+     */
+    void enqueue(Region *region, IntervalSet *potentialSatSet);
+
+    /**
+     * @brief run Visits the regions until no potential satisfaction set is left.
+     */
+    void run();
+
+    /**
+     * @brief setDebugImage Draws the polygons of the visited regions, which has to be done on the GUI thread.
+     */
+    void setDebugImage(cv::Mat *image, int scale) { debugImage = image; this->scale = scale; }
+
+    /**
+     * @brief getSatSet The s-values of the paths from the roots that satisfy the until, not merged (see removeRedundency).
+     */
+    const IntervalSet &getSatSet() const { return satSet; }
+
+private:
+    /*
+     * The state of a region: the part of its potential satisfaction set that still has to be propagated, and the part
+     * that already was.
+     */
+    struct UntilRegionState {
+        IntervalSet pending;
+        IntervalSet propagated;
+    };
+
+    GeometryHelper *geometryHelper;
+    UntilCache *untilCache;
+    Formula *psi1;
+    Formula *psi2;
+    Interval bound;
+    cv::Mat *debugImage;
+    int scale;
+
+    /*
+     * The states of the regions reached so far, and the regions with a pending potential satisfaction set by the time
+     * at which their paths enter them, earliest first. A region can be in the queue more than once.
+     */
+    std::map<Region*, UntilRegionState> states;
+    std::priority_queue<std::pair<double, Region*>, std::vector<std::pair<double, Region*> >, std::greater<std::pair<double, Region*> > > queue;
+    IntervalSet satSet;
+
+    void visit(Region *region);
+};
+
+}
+
+#endif // UNTILTRAVERSAL_H
@@ -1,21 +1,22 @@
-/* A Bison parser, made by GNU Bison 2.5.  */
+/* A Bison parser, made by GNU Bison 3.8.2.  */
 
 /* Bison interface for Yacc-like parsers in C
-   
-      Copyright (C) 1984, 1989-1990, 2000-2011 Free Software Foundation, Inc.
-   
+
+   Copyright (C) 1984, 1989-1990, 2000-2015, 2018-2021 Free Software Foundation,
+   Inc.
+
    This program is free software: you can redistribute it and/or modify
    it under the terms of the GNU General Public License as published by
    the Free Software Foundation, either version 3 of the License, or
    (at your option) any later version.
-   
+
    This program is distributed in the hope that it will be useful,
    but WITHOUT ANY WARRANTY; without even the implied warranty of
    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
    GNU General Public License for more details.
-   
+
    You should have received a copy of the GNU General Public License
-   along with this program.  If not, see <http://www.gnu.org/licenses/>.  */
+   along with this program.  If not, see <https://www.gnu.org/licenses/>.  */
 
 /* As a special exception, you may create a larger work that contains
    part or all of the Bison parser skeleton and distribute that work
@@ -26,59 +27,115 @@
    special exception, which will cause the skeleton and the resulting
    Bison output files to be licensed under the GNU General Public
    License without this special exception.
-   
+
    This special exception was added by the Free Software Foundation in
    version 2.2 of Bison.  */
 
+/* DO NOT RELY ON FEATURES THAT ARE NOT DOCUMENTED in the manual,
+   especially those whose name start with YY_ or yy_.  They are
+   private implementation details that can be changed or removed.  */
 
-/* Tokens.  */
-#ifndef YYTOKENTYPE
-# define YYTOKENTYPE
-   /* Put the tokens into the symbol table, so that GDB and other debuggers
-      know about them.  */
-   enum yytokentype {
-     DOUBLE = 258,
-     VARIABLE = 259,
-     S_PR = 260,
-     S_LEQ = 261,
-     S_LESSER = 262,
-     S_GREATER = 263,
-     S_GEQ = 264,
-     LPAREN = 265,
-     RPAREN = 266,
-     S_NEG = 267,
-     S_AND = 268,
-     S_UNTIL = 269,
-     LCOLON = 270,
-     RCOLON = 271,
-     COMMA = 272,
-     S_FLUID = 273,
-     S_DISCRETE = 274,
-     S_EQUALS = 275,
-     S_TRUE = 276,
-     S_OR = 277
-   };
+#ifndef YY_YY_PARSER_BISON_CLASS_TAB_H_INCLUDED
+# define YY_YY_PARSER_BISON_CLASS_TAB_H_INCLUDED
+/* Debug traces.  */
+#ifndef YYDEBUG
+# define YYDEBUG 0
+#endif
+#if YYDEBUG
+extern int yydebug;
+#endif
+/* "%code requires" blocks.  */
+#line 19 "parser_bison_class.y"
+
+#include "Formula.h"
+
+#ifndef YY_TYPEDEF_YY_SCANNER_T
+#define YY_TYPEDEF_YY_SCANNER_T
+typedef void* yyscan_t;
 #endif
 
+/**
+ * @brief The FormulaParseContext struct is the state of the parse of one formula that the scanner and the parser
+ * share: the column the scanner is at, and the results, which are the AST of the formula and the column of the first
+ * syntax error (-1 if there was none).
+ */
+struct FormulaParseContext {
+	int column;
+	int errorColumn;
+	model::Formula *formula;
+
+	FormulaParseContext() : column(1), errorColumn(-1), formula(NULL) {}
+};
 
+#line 71 "parser_bison_class.tab.h"
 
+/* Token kinds.  */
+#ifndef YYTOKENTYPE
+# define YYTOKENTYPE
+  enum yytokentype
+  {
+    YYEMPTY = -2,
+    YYEOF = 0,                     /* "end of file"  */
+    YYerror = 256,                 /* error  */
+    YYUNDEF = 257,                 /* "invalid token"  */
+    DOUBLE = 258,                  /* DOUBLE  */
+    VARIABLE = 259,                /* VARIABLE  */
+    S_PR = 260,                    /* S_PR  */
+    S_LEQ = 261,                   /* S_LEQ  */
+    S_LESSER = 262,                /* S_LESSER  */
+    S_GREATER = 263,               /* S_GREATER  */
+    S_GEQ = 264,                   /* S_GEQ  */
+    LPAREN = 265,                  /* LPAREN  */
+    RPAREN = 266,                  /* RPAREN  */
+    S_NEG = 267,                   /* S_NEG  */
+    S_AND = 268,                   /* S_AND  */
+    S_UNTIL = 269,                 /* S_UNTIL  */
+    LCOLON = 270,                  /* LCOLON  */
+    RCOLON = 271,                  /* RCOLON  */
+    COMMA = 272,                   /* COMMA  */
+    S_FLUID = 273,                 /* S_FLUID  */
+    S_DISCRETE = 274,              /* S_DISCRETE  */
+    S_EQUALS = 275,                /* S_EQUALS  */
+    S_TRUE = 276,                  /* S_TRUE  */
+    S_OR = 277                     /* S_OR  */
+  };
+  typedef enum yytokentype yytoken_kind_t;
+#endif
+
+/* Value type.  */
 #if ! defined YYSTYPE && ! defined YYSTYPE_IS_DECLARED
-typedef union YYSTYPE
+union YYSTYPE
 {
+#line 63 "parser_bison_class.y"
+ double dval; char *sval; model::Formula *fml; 
 
-/* Line 2068 of yacc.c  */
-#line 28 "parser_bison_class.y"
- double dval; int ivar; class Formula *fml; 
-
+#line 113 "parser_bison_class.tab.h"
 
-/* Line 2068 of yacc.c  */
-#line 76 "parser_bison_class.tab.h"
-} YYSTYPE;
+};
+typedef union YYSTYPE YYSTYPE;
 # define YYSTYPE_IS_TRIVIAL 1
-# define yystype YYSTYPE /* obsolescent; will be withdrawn */
 # define YYSTYPE_IS_DECLARED 1
 #endif
 
-extern YYSTYPE yylval;
 
 
+
+int yyparse (yyscan_t scanner, FormulaParseContext *context);
+
+/* "%code provides" blocks.  */
+#line 41 "parser_bison_class.y"
+
+/**
+ * @brief parseFormula Parses the formula into the context.
+ * @return 0 if the formula was parsed, otherwise the context has the column of the error.
+ */
+int parseFormula(const char *formula, FormulaParseContext *context);
+
+/**
+ * @brief deleteFormula Deletes a formula, its subformulas and the place names of its atoms.
+ */
+void deleteFormula(model::Formula *formula);
+
+#line 140 "parser_bison_class.tab.h"
+
+#endif /* !YY_YY_PARSER_BISON_CLASS_TAB_H_INCLUDED  */
@@ -4,36 +4,74 @@
  * @author B.F. Postema
  * @brief The parser for retrieving the STL formulas
  * The parser retrieves STL formulas as AST generated by flex/parser_bison_class.y in combination with Bison.
+ * The parser is pure and is driven by parseFormula (see lexer.l), so all the state of a parse is in its reentrant
+ * scanner and its FormulaParseContext.
  */
 #include <stdlib.h>
 #include <stdio.h>
 #include <string.h>
-#include <iostream>  
-#include "Formula.h"
+#include <iostream>
 #include "IntervalSet.h"
 
 using namespace model;
+%}
 
-	int yylex(void);
-	void yyerror(char *s);
-        int yyparse();
-        Formula* parser_results();
+%code requires {
+#include "Formula.h"
 
-#define NVARS 100
-char *vars[NVARS]; double vals[NVARS]; int nvars=0;
+#ifndef YY_TYPEDEF_YY_SCANNER_T
+#define YY_TYPEDEF_YY_SCANNER_T
+typedef void* yyscan_t;
+#endif
 
-class Formula *PARSER_FML;
-%}
+/**
+ * @brief The FormulaParseContext struct is the state of the parse of one formula that the scanner and the parser
+ * share: the column the scanner is at, and the results, which are the AST of the formula and the column of the first
+ * syntax error (-1 if there was none).
+ */
+struct FormulaParseContext {
+	int column;
+	int errorColumn;
+	model::Formula *formula;
+
+	FormulaParseContext() : column(1), errorColumn(-1), formula(NULL) {}
+};
+}
 
-%union { double dval; int ivar; class Formula *fml; }
+%code provides {
+/**
+ * @brief parseFormula Parses the formula into the context.
+ * @return 0 if the formula was parsed, otherwise the context has the column of the error.
+ */
+int parseFormula(const char *formula, FormulaParseContext *context);
+
+/**
+ * @brief deleteFormula Deletes a formula, its subformulas and the place names of its atoms.
+ */
+void deleteFormula(model::Formula *formula);
+}
+
+%code {
+	int yylex(YYSTYPE *yylval_param, yyscan_t yyscanner);
+	void yyerror(yyscan_t scanner, FormulaParseContext *context, const char *s);
+}
+
+%define api.pure full
+%lex-param { yyscan_t scanner }
+%parse-param { yyscan_t scanner } { FormulaParseContext *context }
+
+%union { double dval; char *sval; model::Formula *fml; }
 
 %token <dval> DOUBLE
-%token <ivar> VARIABLE
+%token <sval> VARIABLE
 %type <fml> expr
 %type <fml> atomdisexpr
 %type <fml> atomcontexpr
 %type <fml> trueexpr
 
+%destructor { free($$); } <sval>
+%destructor { deleteFormula($$); } <fml>
+
 %token	S_PR
 %token 	S_LEQ S_LESSER S_GREATER S_GEQ
 %token	LPAREN RPAREN
@@ -60,37 +98,37 @@ class Formula *PARSER_FML;
 %start main;
 
 main : S_PR S_LEQ DOUBLE LPAREN expr RPAREN {
-	PARSER_FML = new ProbFormula($5,0,$3,LEQ);
-	
+	context->formula = new ProbFormula($5,0,$3,LEQ);
+
 	std::cout << "Probability <= Formula detected." << std::endl;
 }
      | S_PR S_LESSER DOUBLE LPAREN expr RPAREN {
-	PARSER_FML = new ProbFormula($5,0,$3,LESSER);
+	context->formula = new ProbFormula($5,0,$3,LESSER);
 	std::cout << "Probability < Formula detected." << std::endl;
 }
      | S_PR S_GREATER DOUBLE LPAREN expr RPAREN {
-	PARSER_FML = new ProbFormula($5,0,$3,GREATER);
+	context->formula = new ProbFormula($5,0,$3,GREATER);
 	std::cout << "Probability > Formula detected." << std::endl;
 }
      | S_PR S_GEQ DOUBLE LPAREN expr RPAREN {
-	PARSER_FML = new ProbFormula($5,0,$3,GEQ);
+	context->formula = new ProbFormula($5,0,$3,GEQ);
 	std::cout << "Probability >= Formula detected." << std::endl;
 };
 
 expr : expr S_AND expr {
 	$$ = new AndFormula($1,$3);
-	
+
 	std::cout << "And Formula detected." << std::endl;
 }
      | S_NEG expr {
         $$ = new NegFormula($2,0);
-	
+
 	std::cout << "Negation Formula detected." << std::endl;
 }
      | expr S_UNTIL LCOLON DOUBLE COMMA DOUBLE RCOLON expr  {
 	Interval bound = Interval($4,$6);
 	$$ = new UntilFormula($1,$8,bound);
-	
+
 	std::cout << "Until Formula detected." << std::endl;
 }
 
@@ -99,15 +137,15 @@ expr : expr S_AND expr {
      | trueexpr { $$=$1; }
      | LPAREN expr RPAREN {$$=$2; };
 
-atomdisexpr : S_DISCRETE VARIABLE S_EQUALS DOUBLE { 
-        $$ = new AtomDisFormula(0,0,vars[$2],$4);
+atomdisexpr : S_DISCRETE VARIABLE S_EQUALS DOUBLE {
+        $$ = new AtomDisFormula(0,0,$2,$4);
 
-        std::cout << "Atom Discrete Formula detected." << vars[$2] << std::endl;
+        std::cout << "Atom Discrete Formula detected." << $2 << std::endl;
 };
-atomcontexpr : S_FLUID VARIABLE S_LEQ DOUBLE { 
-        $$ = new AtomContFormula(0,0,vars[$2],$4);
-	
-        std::cout << "Atom Continuous Formula detected." << vars[$2] << std::endl;
+atomcontexpr : S_FLUID VARIABLE S_LEQ DOUBLE {
+        $$ = new AtomContFormula(0,0,$2,$4);
+
+        std::cout << "Atom Continuous Formula detected." << $2 << std::endl;
 };
 trueexpr : S_TRUE {
         $$ = new TrueFormula(0,0);
@@ -117,29 +155,14 @@ trueexpr : S_TRUE {
 
 %%
 
-int varindex(char *var)
+void deleteFormula(model::Formula *formula)
 {
-int i;
-for (i=0; i<nvars; i++)
-if (strcmp(var,vars[i])==0) return i;
-vars[nvars] = strdup(var);
-return nvars++;
+	if (formula == NULL) return;
+	deleteFormula(formula->getLeftChild());
+	deleteFormula(formula->getRightChild());
+	if (formula->getType() == DISCRETE)
+		free(static_cast<AtomDisFormula *>(formula)->getPlaceName());
+	else if (formula->getType() == CONTINUOUS)
+		free(static_cast<AtomContFormula *>(formula)->getPlaceName());
+	delete formula;
 }
-
-/* Called by yyparse on error. */
-void yyerror (char const *s)
-{
-fprintf (stderr, "Parser error: %s\n", s);
-}
-
-Formula* parser_results() {
-    return PARSER_FML;
-}
-/*
-int main(void)
-{
-yyparse();
-return 0;
-}
-*/
-
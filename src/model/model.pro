@@ -29,6 +29,11 @@ INCLUDEPATH += ../includes_64/opencv \
 
 
 SOURCES +=  DFPN2.cpp\
+            CdfKernels.cpp\
+            CompiledExpression.cpp\
+            ConditionalDiagram.cpp\
+            FormulaPlan.cpp\
+            GeneralDistribution.cpp\
             GeometryHelper.cpp\
             IntervalSet.cpp\
             Line.cpp\
@@ -36,23 +41,40 @@ SOURCES +=  DFPN2.cpp\
             Polygon.cpp\
             TimedDiagram.cpp\
             Region.cpp\
+            RegionBitmap.cpp\
+            Simulator.cpp\
+            SobolSequence.cpp\
+            UntilTraversal.cpp\
             Facade.cpp\
+            clipper/clipper.cpp\
             flex/fmll.cpp\
             flex/fmly.cpp\
 
 
 HEADERS +=  DFPN2.h\
+            CdfKernels.h\
+            CompiledExpression.h\
+            ConditionalDiagram.h\
             Event.h\
             Formula.h\
+            FormulaPlan.h\
+            GeneralDistribution.h\
             GeometryHelper.h\
             IntervalSet.h\
             Line.h\
             ModelChecker.h\
             Polygon.h\
+            RandomStream.h\
+            RunningStatistics.h\
             TimedDiagram.h\
             Region.h\
+            RegionBitmap.h\
+            Simulator.h\
+            SobolSequence.h\
+            UntilTraversal.h\
             Facade.h\
             Logger.h\
+            clipper/clipper.hpp\
             flex/parser_bison_class.tab.h\
 
 OTHER_FILES +=  flex/parser_bison_class.y\
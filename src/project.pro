@@ -7,6 +7,7 @@
 
 TEMPLATE = subdirs
 SUBDIRS =   model \
+            tests \
 #            view
 
 # ordered takes care of the compilation order of the directories.
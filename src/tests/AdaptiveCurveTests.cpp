@@ -0,0 +1,125 @@
+/**
+ * @file AdaptiveCurveTests.cpp
+ * @brief Adaptive time sampling (ModelChecker::calcAdaptiveProbCurve and the ADAPTIVE_STEP simulation) against the
+ * closed form of the pump models, see PumpModel.h.
+ */
+
+#include "PumpModel.h"
+
+#include <algorithm>
+#include <cmath>
+
+using namespace model;
+
+namespace tests {
+
+namespace {
+
+const double MAX_TIME = 10;
+const double MIN_STEP = 0.01;
+const double TOLERANCE = 1e-3;
+
+/*
+ * The time at which the closed form jumps from 1 to F((5 + c)/2) or below, where its value depends on rounding.
+ */
+double pumpJump(double c) {
+    return c < 5 ? c : (5 + c) / 2;
+}
+
+bool contains(const std::vector<double> &times, double t) {
+    for (unsigned int i = 0; i < times.size(); i++) {
+        if (fabs(times[i] - t) < 1e-9)
+            return true;
+    }
+    return false;
+}
+
+void checkAnalyticSampling() {
+    PumpDiagram diagram("pump_exp.hpng", MAX_TIME);
+    if (!CHECK(diagram.isValid()))
+        return;
+
+    std::vector<double> breakpoints;
+    TimedDiagram::getInstance()->getBreakpoints(breakpoints);
+    CHECK(contains(breakpoints, 5));
+
+    std::vector<double> amounts;
+    amounts.push_back(4);
+    amounts.push_back(6);
+    std::vector<double> times;
+    std::vector<std::vector<double> > probs;
+    diagram.getModelChecker()->calcAdaptiveProbCurve(times, probs, diagram.getPlaceIndex(), amounts, MIN_STEP, TOLERANCE);
+    if (!CHECK(times.size() == probs.size() && times.size() >= breakpoints.size()))
+        return;
+
+    // Every breakpoint of the STD is sampled, in increasing order.
+    CHECK_CLOSE(times.front(), 0, 1e-12);
+    CHECK_CLOSE(times.back(), MAX_TIME, 1e-12);
+    for (unsigned int i = 0; i < breakpoints.size(); i++)
+        CHECK(contains(times, breakpoints[i]));
+    for (unsigned int i = 1; i < times.size(); i++)
+        CHECK(times[i] > times[i - 1]);
+
+    const GeneralDistribution *distribution = diagram.getDistribution();
+    for (unsigned int k = 0; k < amounts.size(); k++) {
+        double c = amounts[k], jump = pumpJump(c);
+        for (unsigned int i = 0; i < times.size(); i++) {
+            if (fabs(times[i] - jump) > 1e-9)
+                CHECK_CLOSE(probs[i][k], pumpProb(distribution, c, times[i]), 1e-9);
+        }
+
+        // Between two samples that were not refined further the curve is within the tolerance of the straight line
+        // through them at the midpoint.
+        for (unsigned int i = 1; i < times.size(); i++) {
+            double t0 = times[i - 1], t1 = times[i], tm = (t0 + t1) / 2;
+            if (t1 - t0 < 2 * MIN_STEP || (t0 <= jump + 1e-9 && t1 >= jump - 1e-9))
+                continue;
+            CHECK(fabs(pumpProb(distribution, c, tm) - (probs[i - 1][k] + probs[i][k]) / 2) <= TOLERANCE);
+        }
+    }
+}
+
+void checkSimulationSampling() {
+    TestLogger logger;
+    Facade facade(QString(modelPath("pump_exp.hpng").c_str()), "reservoir", &logger);
+    SimulationOptions options;
+    options.randomSeed = false;
+    options.seed = 26;
+    facade.setSimulationOptions(options);
+    const double c = 4, tStep = 1;
+    if (!CHECK(facade.showDESProbFunc(c, 20000, tStep, MAX_TIME, ADAPTIVE_STEP)))
+        return;
+
+    std::vector<DESPoint> points;
+    if (!CHECK(readDESIntervals("./output/reservoir_des_2d_adaptive_ci.dat", points)))
+        return;
+
+    // The time steps and the breakpoints of the STD, which the facade has left in the diagram
+    std::vector<double> breakpoints, times;
+    TimedDiagram::getInstance()->getBreakpoints(breakpoints);
+    for (unsigned int i = 0; i < points.size(); i++)
+        times.push_back(points[i].time);
+    for (double t = 0; t <= MAX_TIME; t += tStep)
+        CHECK(contains(times, t));
+    for (unsigned int i = 0; i < breakpoints.size(); i++)
+        CHECK(contains(times, breakpoints[i]));
+    CHECK(contains(times, 5));
+
+    TypedDistribution<ExpPolicy> distribution;
+    distribution.getPolicy().lambda = 0.1;
+    for (unsigned int i = 0; i < points.size(); i++) {
+        if (fabs(points[i].time - pumpJump(c)) < 1e-9)
+            continue;
+        double halfWidth = (points[i].upper - points[i].lower) / 2;
+        CHECK_CLOSE(points[i].probability, pumpProb(&distribution, c, points[i].time), 2 * halfWidth + 1e-12);
+    }
+}
+
+}
+
+void testAdaptiveCurve() {
+    checkAnalyticSampling();
+    checkSimulationSampling();
+}
+
+}
@@ -0,0 +1,113 @@
+/**
+ * @file CdfKernelsTests.cpp
+ * @brief The numerical kernels of CdfKernels.h against reference values computed with scipy.special and scipy.stats.
+ */
+
+#include "TestSuite.h"
+#include "CdfKernels.h"
+
+#include <cmath>
+#include <vector>
+
+using namespace model;
+
+namespace tests {
+
+namespace {
+
+struct GammaReference {
+    double shape, scale, s;
+    double p; // scipy.special.gammainc(shape, s / scale)
+};
+
+/*
+ * The relative error of a probability, or the absolute error for probabilities close to 1, where only the
+ * absolute error of F is meaningful.
+ */
+double probabilityError(double actual, double expected) {
+    return expected < 0.5 ? fabs(actual - expected) / expected : fabs(actual - expected);
+}
+
+}
+
+void testGammaCdf() {
+    // The series (s/scale < shape + 1), the continued fraction and the finite Erlang sum (integer shape up to 20)
+    const GammaReference references[] = {
+        {0.5, 1, 0.01, 0.11246291601828491},
+        {0.5, 1, 2, 0.9544997361036415},
+        {1, 2.5, 1, 0.32967995396436056},
+        {2, 1, 3, 0.8008517265285442},
+        {3, 2, 10, 0.8753479805169189},
+        {3, 1, 1e-3, 1.6654171665278094e-10},
+        {2.5, 4, 1e-4, 9.402991813861876e-13},
+        {7.5, 1, 5, 0.18026008049639844},
+        {7.5, 1, 12, 0.9349065136011695},
+        {12, 1, 1, 8.316107426882326e-10},
+        {12, 1, 30, 0.9999361229746008},
+        {20, 1, 25, 0.8664251659143496},
+        {21, 1, 25, 0.8145076973058583},
+        {25, 1, 20, 0.1567726218262377},
+        {100, 1, 90, 0.15822098918643007},
+        {100, 1, 130, 0.9972495916326934},
+        {0.5, 2.5, 400, 1},
+    };
+    const int n = sizeof(references) / sizeof(references[0]);
+
+    for (int i = 0; i < n; i++) {
+        GammaCdf gamma;
+        CHECK(gamma.setParameters(references[i].shape, references[i].scale));
+        double p = gamma.evaluate(references[i].s);
+        CHECK(probabilityError(p, references[i].p) <= 1e-12);
+
+        // The batch gives the same values.
+        double s[] = {0, references[i].s, INFINITY}, res[3];
+        gamma.evaluate(s, res, 3);
+        CHECK_CLOSE(res[0], 0, 0);
+        CHECK_CLOSE(res[1], p, 0);
+        CHECK_CLOSE(res[2], 1, 0);
+    }
+
+    // The quantile, scipy.stats.gamma.ppf
+    GammaCdf gamma;
+    CHECK(gamma.setParameters(2, 1));
+    CHECK_CLOSE(gamma.quantile(0.5), 1.6783469900166612, 1e-11);
+    CHECK(gamma.setParameters(7.5, 2));
+    CHECK_CLOSE(gamma.quantile(0.9), 22.307129581578693, 1e-10);
+    CHECK(gamma.setParameters(0.5, 1));
+    CHECK_CLOSE(gamma.quantile(0.01), 7.854392895485092e-05, 1e-16);
+    CHECK_CLOSE(gamma.quantile(0.999999), 11.964063488439734, 1e-10);
+    CHECK(gamma.setParameters(3, 2));
+    CHECK_CLOSE(gamma.quantile(1e-6), 0.036508565926558594, 1e-13);
+
+    // Invalid parameters
+    CHECK(!gamma.setParameters(0, 1));
+    CHECK(!gamma.setParameters(1, -1));
+}
+
+void testQuantiles() {
+    // scipy.stats.norm.ppf
+    CHECK_CLOSE(normalQuantile(0.5), 0, 1e-15);
+    CHECK_CLOSE(normalQuantile(0.975), 1.959963984540054, 1e-14);
+    CHECK_CLOSE(normalQuantile(0.025), -1.9599639845400545, 1e-14);
+    CHECK_CLOSE(normalQuantile(0.995), 2.5758293035489004, 1e-14);
+    CHECK_CLOSE(normalQuantile(0.3), -0.5244005127080409, 1e-14);
+    CHECK_CLOSE(normalQuantile(0.9999), 3.719016485455709, 1e-13);
+    CHECK_CLOSE(normalQuantile(1e-10), -6.361340902404056, 1e-13);
+    CHECK_CLOSE(normalQuantile(1 - 1e-9), 5.997807019601637, 1e-13);
+    CHECK_CLOSE(normalQuantile(1 - 1e-15), 7.941444487415979, 1e-13);
+    CHECK(normalQuantile(0) == -INFINITY);
+    CHECK(normalQuantile(1) == INFINITY);
+
+    // scipy.stats.t.ppf
+    CHECK_CLOSE(studentQuantile(0.975, 1), 12.706204736174694, 1e-10);
+    CHECK_CLOSE(studentQuantile(0.995, 1), 63.656741162871526, 1e-9);
+    CHECK_CLOSE(studentQuantile(0.975, 2), 4.302652729749462, 1e-11);
+    CHECK_CLOSE(studentQuantile(0.9, 3), 1.637744353696209, 1e-11);
+    CHECK_CLOSE(studentQuantile(0.025, 4), -2.7764451051977943, 1e-11);
+    CHECK_CLOSE(studentQuantile(0.975, 9), 2.262157162798205, 1e-11);
+    CHECK_CLOSE(studentQuantile(0.975, 30), 2.0422724563012378, 1e-11);
+    CHECK_CLOSE(studentQuantile(0.975, 120), 1.9799304050824402, 1e-11);
+    CHECK_CLOSE(studentQuantile(0.5, 7), 0, 1e-15);
+}
+
+}
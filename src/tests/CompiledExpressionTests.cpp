@@ -0,0 +1,103 @@
+/**
+ * @file CompiledExpressionTests.cpp
+ * @brief The compiled gen{} expressions (CompiledExpression) against libmatheval and against values computed by hand.
+ */
+
+#include "TestSuite.h"
+#include "CompiledExpression.h"
+
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <vector>
+
+extern "C" {
+#include <matheval.h>
+}
+
+using namespace model;
+
+namespace tests {
+
+namespace {
+
+// Not a multiple of the block size of the batch evaluation
+const int VALUES = 1001;
+
+/*
+ * Whether the compiled value is the value of libmatheval, where both may be NaN or the same infinity.
+ */
+bool sameValue(double compiled, double reference) {
+    if (std::isnan(reference))
+        return std::isnan(compiled);
+    return compiled == reference || fabs(compiled - reference) <= 1e-13 * (1 + fabs(reference));
+}
+
+void checkAgainstMatheval(const char *expression) {
+    CompiledExpression compiled;
+    if (!CHECK(compiled.compile(expression)))
+        return;
+    std::vector<char> copy(expression, expression + strlen(expression) + 1);
+    void *evaluator = evaluator_create(&copy[0]);
+    if (!CHECK(evaluator != NULL))
+        return;
+
+    std::vector<double> s(VALUES), res(VALUES);
+    for (int i = 0; i < VALUES; i++)
+        s[i] = -3 + 0.013 * i;
+    compiled.evaluate(&s[0], &res[0], VALUES);
+
+    char *names[] = { (char *)"s" };
+    int mismatches = 0;
+    for (int i = 0; i < VALUES; i++) {
+        double values[] = { s[i] };
+        double reference = evaluator_evaluate(evaluator, 1, names, values);
+        if (!sameValue(compiled.evaluate(s[i]), reference) || !sameValue(res[i], reference))
+            mismatches++;
+    }
+    if (!CHECK(mismatches == 0))
+        fprintf(stderr, "  %d of %d values of %s differ from libmatheval\n", mismatches, VALUES, expression);
+    evaluator_destroy(evaluator);
+}
+
+double evaluate(const char *expression, double s) {
+    CompiledExpression compiled;
+    if (!compiled.compile(expression))
+        return NAN;
+    return compiled.evaluate(s);
+}
+
+}
+
+void testCompiledExpression() {
+    // Every function and constant of the grammar, on negative and positive s
+    const char *expressions[] = {
+        "(1 - exp(-s/10))", "1-exp(-s^2/2)", "-s^2", "2^3^2", "s^-2", "2*-s", "-(s)^2", "1.5e-1*s",
+        "1_pi*s+2_sqrtpi", "e+log2e+log10e+ln2+ln10+pi+pi_2+pi_4+2_pi+sqrt2+sqrt1_2",
+        "sqrt(s)*erf(s/3)+step(s-1)", "abs(-s)/(1+s)", "log(1+s)/ln2",
+        "sin(s)+cos(s)+tan(s)+cot(s)+sec(s)+csc(s)", "asin(s/4)+acos(s/4)+atan(s)+acot(s)+asec(s)+acsc(s)",
+        "sinh(s)+cosh(s)+tanh(s)+coth(s)+sech(s)+csch(s)", "asinh(s)+acosh(s)+atanh(s/4)+acoth(s+4)+asech(s/4)+acsch(s)",
+        "delta(s)+nandelta(s-1)+step(s)"
+    };
+    for (unsigned int i = 0; i < sizeof(expressions) / sizeof(expressions[0]); i++)
+        checkAgainstMatheval(expressions[i]);
+
+    // Precedence and associativity as in libmatheval: ^ is left associative and binds stronger than unary minus
+    CHECK_CLOSE(evaluate("2^3^2", 0), 64, 0);
+    CHECK_CLOSE(evaluate("-s^2", 3), -9, 0);
+    CHECK_CLOSE(evaluate("2*-s", 3), -6, 0);
+    CHECK_CLOSE(evaluate("s^-2", 2), 0.25, 0);
+    CHECK_CLOSE(evaluate("1-2-3", 0), -4, 0);
+    CHECK_CLOSE(evaluate("8/2/4", 0), 1, 0);
+    CHECK_CLOSE(evaluate("(1 - exp(-s/10))", 10), 0.63212055882855767, 1e-16);
+    CHECK_CLOSE(evaluate("step(s)", 0), 1, 0);
+    CHECK_CLOSE(evaluate("erf(s)", 1), 0.84270079294971487, 1e-16);
+
+    // Outside the grammar: left to libmatheval
+    CompiledExpression other;
+    CHECK(!other.compile("x+s"));
+    CHECK(!other.compile("1-exp(-s"));
+    CHECK(!other.compile("foo(s)"));
+}
+
+}
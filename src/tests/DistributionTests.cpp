@@ -0,0 +1,216 @@
+/**
+ * @file DistributionTests.cpp
+ * @brief The distributions of the general transitions (GeneralDistribution.h) against reference values computed with
+ * scipy.stats, the compensated summation of their probabilities, and their quantiles, by which the simulation draws
+ * the delays.
+ */
+
+#include "TestSuite.h"
+#include "GeneralDistribution.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <vector>
+
+using namespace model;
+
+namespace tests {
+
+namespace {
+
+struct DiffReference {
+    double lo, hi;
+    double diff; // F(hi) - F(lo)
+    double tolerance;
+};
+
+/*
+ * Checks cdfDiffs on all references at once, and calcProb on every reference as a set of one interval.
+ */
+void checkDiffs(const GeneralDistribution &distribution, const DiffReference *references, int n) {
+    std::vector<double> lo(n), hi(n), res(n);
+    for (int i = 0; i < n; i++) {
+        lo[i] = references[i].lo;
+        hi[i] = references[i].hi;
+    }
+    distribution.cdfDiffs(&lo[0], &hi[0], &res[0], n);
+
+    for (int i = 0; i < n; i++) {
+        CHECK_CLOSE(res[i], references[i].diff, references[i].tolerance);
+
+        // Shifted by 1
+        IntervalSet iSet;
+        iSet.intervals.push_back(Interval(lo[i] + 1, hi[i] + 1));
+        CHECK_CLOSE(distribution.calcProb(&iSet, 1), references[i].diff, references[i].tolerance);
+    }
+}
+
+void checkCompensatedSums() {
+    // A naive sum loses the 1 against 1e16.
+    const double cancelling[] = {1e16, 1, -1e16};
+    CHECK_CLOSE(neumaierSum(cancelling, 3), 1, 0);
+
+    // A million contributions of 1e-16 to 1 add up to 1e-10, a naive sum adds nothing.
+    std::vector<double> small(1000001, 1e-16);
+    small[0] = 1;
+    CHECK_CLOSE(neumaierSum(&small[0], (int)small.size()), 1.0000000001, 2.3e-16);
+
+    NeumaierSum sum;
+    for (unsigned int i = 0; i < small.size(); i++)
+        sum.add(small[i]);
+    CHECK_CLOSE(sum.result(), 1.0000000001, 2.3e-16);
+
+    // The probabilities of a fine satisfaction set add up to the probability of its hull.
+    TypedDistribution<ExpPolicy> exponential;
+    exponential.getPolicy().lambda = 0.1;
+    IntervalSet fine;
+    const int pieces = 100000;
+    for (int i = 0; i < pieces; i++)
+        fine.intervals.push_back(Interval(30.0 * i / pieces, 30.0 * (i + 1) / pieces));
+    CHECK_CLOSE(exponential.calcProb(&fine, 0), 0.950212931632136, 1e-15);
+}
+
+}
+
+void testDistributionKernels() {
+    checkCompensatedSums();
+
+    // scipy.stats.expon(scale=10)
+    TypedDistribution<ExpPolicy> exponential;
+    exponential.getPolicy().lambda = 0.1;
+    const DiffReference expReferences[] = {
+        {0, 1, 0.09516258196404048, 1e-16},
+        {2.5, 7, 0.28221547927999535, 1e-16},
+        {400, 401, 4.0428436003147137e-19, 1e-30}, // the tail keeps its relative precision
+        {0, INFINITY, 1, 0},
+    };
+    checkDiffs(exponential, expReferences, sizeof(expReferences) / sizeof(expReferences[0]));
+
+    // scipy.stats.uniform(1, 19)
+    TypedDistribution<UniPolicy> uniform;
+    uniform.getPolicy().a = 1;
+    uniform.getPolicy().b = 20;
+    const DiffReference uniReferences[] = {
+        {0, 3, 0.10526315789473684, 1e-16},
+        {2, 25, 0.9473684210526316, 1e-16},
+        {5.5, 5.75, 0.013157894736842118, 1e-16},
+    };
+    checkDiffs(uniform, uniReferences, sizeof(uniReferences) / sizeof(uniReferences[0]));
+
+    // scipy.stats.norm(5, 2), the upper tail from the survival function
+    TypedDistribution<NormalPolicy> normal;
+    normal.getPolicy().mu = 5;
+    normal.getPolicy().sigma = 2;
+    const DiffReference normReferences[] = {
+        {3, 7, 0.6826894921370859, 1e-15},
+        {21, 23, 6.219831985865787e-16, 1e-27},
+        {-20, -11, 6.22096057427174e-16, 1e-15},
+    };
+    checkDiffs(normal, normReferences, sizeof(normReferences) / sizeof(normReferences[0]));
+
+    // scipy.stats.foldnorm(2.5, scale=2), i.e. |N(5, 2)|
+    TypedDistribution<FoldedNormalPolicy> foldedNormal;
+    foldedNormal.getPolicy().mu = 5;
+    foldedNormal.getPolicy().sigma = 2;
+    const DiffReference foldedReferences[] = {
+        {0, 1, 0.021400233916549105, 1e-15},
+        {3, 7, 0.6827211623923314, 1e-15},
+        {2, 30, 0.9334254278101775, 1e-15},
+    };
+    checkDiffs(foldedNormal, foldedReferences, sizeof(foldedReferences) / sizeof(foldedReferences[0]));
+
+    // scipy.stats.gamma(7.5, scale=2)
+    TypedDistribution<GammaPolicy> gamma;
+    CHECK(gamma.getPolicy().gamma.setParameters(7.5, 2));
+    const DiffReference gammaReferences[] = {
+        {0, 10, 0.1802600804963984, 1e-15},
+        {14, 16, 0.14347746826004526, 1e-15},
+        {60, 70, 2.4774141157574095e-07, 1e-15},
+    };
+    checkDiffs(gamma, gammaReferences, sizeof(gammaReferences) / sizeof(gammaReferences[0]));
+
+    // gen{} evaluates the compiled expression over the whole batch.
+    TypedDistribution<GenPolicy> general;
+    const char *expression = "1 - exp(-s/10)";
+    std::vector<char> copy(expression, expression + strlen(expression) + 1);
+    general.getPolicy().f = evaluator_create(&copy[0]);
+    CHECK(general.getPolicy().compiled.compile(expression));
+    const DiffReference genReferences[] = {
+        {0, 1, 0.09516258196404048, 1e-15},
+        {2.5, 7, 0.28221547927999535, 1e-15},
+        {0, INFINITY, 1, 0},
+    };
+    checkDiffs(general, genReferences, sizeof(genReferences) / sizeof(genReferences[0]));
+}
+
+void testDistributionQuantiles() {
+    const double u[] = {1e-9, 0.01, 0.5, 0.975, 1 - 1e-9};
+
+    // scipy.stats.expon(scale=10).ppf
+    TypedDistribution<ExpPolicy> exponential;
+    exponential.getPolicy().lambda = 0.1;
+    CHECK(exponential.prepareQuantile());
+    const double expQuantiles[] = {1.0000000005000001e-08, 0.10050335853501442, 6.931471805599453, 36.888794541139355, 207.23265865228342};
+
+    // scipy.stats.norm(5, 2).ppf
+    TypedDistribution<NormalPolicy> normal;
+    normal.getPolicy().mu = 5;
+    normal.getPolicy().sigma = 2;
+    CHECK(normal.prepareQuantile());
+    const double normQuantiles[] = {-6.995614030015373, 0.3473042519183185, 5.0, 8.919927969080108, 16.995614039203275};
+
+    // scipy.stats.foldnorm(2.5, scale=2).ppf. At 1 - 1e-9 the fold adds less than 1e-27 to the cdf, so the quantile is
+    // the one of N(5, 2) above; scipy is 3e-9 off there.
+    TypedDistribution<FoldedNormalPolicy> foldedNormal;
+    foldedNormal.getPolicy().mu = 5;
+    foldedNormal.getPolicy().sigma = 2;
+    CHECK(foldedNormal.prepareQuantile());
+    const double foldedQuantiles[] = {5.705059478975836e-08, 0.5366038038191326, 5.000001437052514, 8.919927969138346, 16.995614039203275};
+
+    TypedDistribution<UniPolicy> uniform;
+    uniform.getPolicy().a = 1;
+    uniform.getPolicy().b = 20;
+    CHECK(uniform.prepareQuantile());
+
+    for (int i = 0; i < 5; i++) {
+        CHECK_CLOSE(exponential.quantile(u[i]), expQuantiles[i], 1e-12 * expQuantiles[i]);
+        CHECK_CLOSE(normal.quantile(u[i]), normQuantiles[i], 1e-11);
+        CHECK_CLOSE(foldedNormal.quantile(u[i]), foldedQuantiles[i], 1e-9);
+        CHECK_CLOSE(uniform.quantile(u[i]), 1 + 19 * u[i], 1e-14);
+    }
+
+    // gen{} interpolates a table of its quantile, linearly in u and in the tail linearly in log(1 - u). The delays it
+    // draws have a cdf within a small fraction of a table cell (1/4096) of the exact one, and the interpolation in
+    // log(1 - u) is exact for the exponential tail. quantileCdf has to invert the interpolation.
+    TypedDistribution<GenPolicy> general;
+    const char *expression = "1 - exp(-s/10)";
+    std::vector<char> copy(expression, expression + strlen(expression) + 1);
+    general.getPolicy().f = evaluator_create(&copy[0]);
+    general.getPolicy().compiled.compile(expression);
+    if (CHECK(general.prepareQuantile())) {
+        double maxCdfError = 0, maxRoundTripError = 0;
+        for (int i = 1; i < 100000; i++) {
+            double v = i / 100000.0;
+            double q = general.quantile(v);
+            maxCdfError = std::max(maxCdfError, fabs(exponential.cdf(q) - v));
+            maxRoundTripError = std::max(maxRoundTripError, fabs(general.quantileCdf(q) - v));
+        }
+        CHECK(maxCdfError < 3e-5);
+        CHECK(maxRoundTripError < 1e-12);
+        // The tail is only as exact as the cdf 1 - exp(-s/10) in double, which is rounded by 1.1e-16, i.e. by
+        // 10 * 1.1e-16 / (1 - u) in s.
+        CHECK_CLOSE(general.quantile(1 - 1e-6), -10 * log(1e-6), 2e-9);
+        CHECK_CLOSE(general.quantile(u[4]), expQuantiles[4], 2e-6);
+    }
+
+    // A cdf that does not approach 1 has no quantile.
+    TypedDistribution<GenPolicy> defective;
+    const char *defectiveExpression = "0.5 * (1 - exp(-s))";
+    std::vector<char> defectiveCopy(defectiveExpression, defectiveExpression + strlen(defectiveExpression) + 1);
+    defective.getPolicy().f = evaluator_create(&defectiveCopy[0]);
+    defective.getPolicy().compiled.compile(defectiveExpression);
+    CHECK(!defective.prepareQuantile());
+}
+
+}
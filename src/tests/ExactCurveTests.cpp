@@ -0,0 +1,110 @@
+/**
+ * @file ExactCurveTests.cpp
+ * @brief The exact piecewise probability curve (ModelChecker::calcExactProbCurve) against the closed form of the pump
+ * models, see PumpModel.h.
+ */
+
+#include "PumpModel.h"
+
+#include <cmath>
+
+using namespace model;
+
+namespace tests {
+
+namespace {
+
+const double MAX_TIME = 20;
+const double PROB_TOLERANCE = 1e-9;
+
+/*
+ * The probability of the exact curve at t, which is not a breakpoint, or NaN if t is outside every piece.
+ */
+double curveProb(const std::vector<ProbCurveSegment> &segments, const GeneralDistribution *distribution, double t) {
+    for (unsigned int i = 0; i < segments.size(); i++) {
+        if (t <= segments[i].tStart || t >= segments[i].tEnd)
+            continue;
+        double p = 0;
+        for (unsigned int j = 0; j < segments[i].intervals.size(); j++) {
+            const AffineInterval &interval = segments[i].intervals[j];
+            p += distribution->cdf(interval.hiSlope * t + interval.hiIntercept) - distribution->cdf(interval.loSlope * t + interval.loIntercept);
+        }
+        return p;
+    }
+    return NAN;
+}
+
+bool hasBreakpoint(const std::vector<ProbCurveSegment> &segments, double t) {
+    for (unsigned int i = 0; i < segments.size(); i++) {
+        if (fabs(segments[i].tStart - t) < 1e-9 || fabs(segments[i].tEnd - t) < 1e-9)
+            return true;
+    }
+    return false;
+}
+
+void checkPumpModel(const char *name, bool checkKinks) {
+    PumpDiagram diagram(name, MAX_TIME);
+    if (!CHECK(diagram.isValid()))
+        return;
+
+    ModelChecker &modelChecker = *diagram.getModelChecker();
+    const GeneralDistribution *distribution = diagram.getDistribution();
+    int pIndex = diagram.getPlaceIndex();
+
+    const double amounts[] = {4, 6};
+    for (unsigned int k = 0; k < sizeof(amounts) / sizeof(amounts[0]); k++) {
+        double c = amounts[k];
+        std::vector<ProbCurveSegment> segments;
+        if (!CHECK(modelChecker.calcExactProbCurve(segments, pIndex, c)))
+            continue;
+
+        CHECK(!segments.empty());
+        CHECK_CLOSE(segments.front().tStart, 0, 1e-12);
+        CHECK_CLOSE(segments.back().tEnd, MAX_TIME, 1e-12);
+        for (unsigned int i = 1; i < segments.size(); i++)
+            CHECK_CLOSE(segments[i].tStart, segments[i - 1].tEnd, 1e-12);
+
+        // Where the closed form has a kink or a jump the curve needs a breakpoint, unless F is constant there.
+        if (checkKinks) {
+            if (c < 5) {
+                CHECK(hasBreakpoint(segments, c));
+                CHECK(hasBreakpoint(segments, 5));
+            } else {
+                CHECK(hasBreakpoint(segments, (5 + c) / 2));
+            }
+        }
+
+        // Until the level reaches c every s beyond t satisfies it, so the first piece is unbounded above.
+        bool unboundedAbove = false;
+        for (unsigned int j = 0; j < segments.front().intervals.size(); j++) {
+            const AffineInterval &interval = segments.front().intervals[j];
+            CHECK(interval.loIntercept != INFINITY && interval.hiIntercept != -INFINITY);
+            unboundedAbove = unboundedAbove || (interval.hiSlope == 0 && interval.hiIntercept == INFINITY);
+        }
+        CHECK(unboundedAbove);
+
+        // Inside the pieces, including points close to their ends
+        for (unsigned int i = 0; i < segments.size(); i++) {
+            double tStart = segments[i].tStart, tEnd = segments[i].tEnd;
+            for (int j = 0; j <= 16; j++) {
+                double t = tStart + (tEnd - tStart) * (j == 0 ? 1e-6 : (j == 16 ? 1 - 1e-6 : j / 16.0));
+                CHECK_CLOSE(curveProb(segments, distribution, t), pumpProb(distribution, c, t), PROB_TOLERANCE);
+            }
+        }
+
+        // The exact curve agrees with the probability computed at a single time.
+        for (double t = 0.3; t < MAX_TIME; t += 1.1)
+            CHECK_CLOSE(curveProb(segments, distribution, t), modelChecker.calcContProbAtTime(t, pIndex, c), PROB_TOLERANCE);
+    }
+}
+
+}
+
+void testExactCurve() {
+    checkPumpModel("pump_exp.hpng", true);
+    checkPumpModel("pump_uni.hpng", true);
+    // dtrm{7} is constant at c = 4 after t = 4, where the curve may or may not have a breakpoint.
+    checkPumpModel("pump_dtrm.hpng", false);
+}
+
+}
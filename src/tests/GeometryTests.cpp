@@ -0,0 +1,185 @@
+/**
+ * @file GeometryTests.cpp
+ * @brief The areas of the boolean combinations of GeometryHelper (ClipperLib): their scaling to integers, the
+ * tolerance AREA_PREC of their boundaries, their cropping, and the slivers of the regions without area.
+ */
+
+#include "TestSuite.h"
+#include "GeometryHelper.h"
+
+#include <cmath>
+#include <vector>
+
+using namespace model;
+
+namespace tests {
+
+namespace {
+
+/*
+ * Whether the intervals are the single interval [start, end], up to the precision of the areas.
+ */
+bool isInterval(IntervalSet *iSet, double start, double end) {
+    if (iSet == NULL || iSet->intervals.size() != 1)
+        return false;
+    return fabs(iSet->intervals[0].start - start) <= GeometryHelper::AREA_PREC
+            && fabs(iSet->intervals[0].end - end) <= GeometryHelper::AREA_PREC;
+}
+
+bool checkSegment(GeometryHelper &helper, const ClipperLib::Polygons &area, Point p1, Point p2, double start, double end) {
+    Segment segment(p1, p2);
+    IntervalSet *iSet = helper.getIntersectionIntervals(area, &segment);
+    bool same = isInterval(iSet, start, end);
+    delete iSet;
+    return same;
+}
+
+/*
+ * A region made of its lower boundary and the given event segments, as TimedDiagram::createAddRegions makes it.
+ */
+class TestRegion
+{
+public:
+    TestRegion(Point p1, Point p2) : lowerBoundary(p1, p2), region(NULL) {}
+    ~TestRegion() {
+        delete region;
+        for (unsigned int i = 0; i < events.size(); i++) {
+            delete events[i]->timeSegment;
+            delete events[i];
+        }
+    }
+
+    void addEvent(Point p1, Point p2) { events.push_back(new StochasticEvent(new Segment(p1, p2), MAX_TIME_REACHED)); }
+
+    Region *create() {
+        region = new Region(new std::vector<StochasticEvent *>(events), &lowerBoundary);
+        return region;
+    }
+
+private:
+    Segment lowerBoundary;
+    std::vector<StochasticEvent *> events;
+    Region *region;
+
+    TestRegion(const TestRegion &);
+    TestRegion &operator=(const TestRegion &);
+};
+
+}
+
+void testGeometry() {
+    GeometryHelper helper(NULL);
+
+    // A polygon without area is left out, the vertices of the others are rounded to multiples of 1 / CLIPPER_SCALE.
+    Polygon segment;
+    segment.vertices.push_back(Point(0, 0));
+    segment.vertices.push_back(Point(1, 1));
+    ClipperLib::Polygons area;
+    helper.toArea(area, &segment);
+    CHECK(area.empty());
+
+    Polygon triangle;
+    triangle.vertices.push_back(Point(0, 0));
+    triangle.vertices.push_back(Point(1.0000000004, 0));
+    triangle.vertices.push_back(Point(0, 1.0000000006));
+    helper.toArea(area, &triangle);
+    if (CHECK(area.size() == 1 && area[0].size() == 3)) {
+        CHECK(area[0][1].X == 1000000000);
+        CHECK(area[0][2].Y == 1000000001);
+    }
+
+    // The region under t = 4 - s, 0 <= s <= 4
+    TestRegion triangleRegion(Point(0, 0), Point(4, 0));
+    triangleRegion.addEvent(Point(0, 4), Point(4, 0));
+    Region *region = triangleRegion.create();
+    TrueFormula tt(NULL, NULL);
+    NegFormula notTT(&tt, NULL);
+    NegFormula notNotTT(&notTT, NULL);
+    AndFormula contradiction(&tt, &notTT);
+
+    helper.createArea(area, region, &notTT);
+    CHECK(area.empty());
+    helper.createArea(area, region, &contradiction);
+    CHECK(area.empty());
+    helper.createArea(area, region, &notNotTT);
+    CHECK(fabs(ClipperLib::Area(area[0])) == 8 * GeometryHelper::CLIPPER_SCALE * GeometryHelper::CLIPPER_SCALE);
+
+    // The area is closed, and points within AREA_PREC of its boundary are in it.
+    helper.createArea(area, region, &tt);
+    if (!CHECK(area.size() == 1))
+        return;
+    const double prec = GeometryHelper::AREA_PREC;
+    CHECK(helper.isAreaContainPt(area, Point(1, 1)));
+    CHECK(helper.isAreaContainPt(area, Point(0, 0)));
+    CHECK(helper.isAreaContainPt(area, Point(2, 2)));
+    CHECK(helper.isAreaContainPt(area, Point(2 + 0.7 * prec, 2 + 0.7 * prec)));
+    CHECK(!helper.isAreaContainPt(area, Point(2 + 1.5 * prec, 2 + 1.5 * prec)));
+    CHECK(helper.isAreaContainPt(area, Point(-0.9 * prec, 1)));
+    CHECK(!helper.isAreaContainPt(area, Point(-1.5 * prec, 1)));
+    CHECK(!helper.isAreaContainPt(area, Point(1, -1.5 * prec)));
+    CHECK(!helper.isAreaContainPt(area, Point(3, 3)));
+
+    // The s-intervals of segments through the area, including one along its lower boundary
+    CHECK(checkSegment(helper, area, Point(-1, 1), Point(5, 1), 0, 3));
+    CHECK(checkSegment(helper, area, Point(-1, 0), Point(5, 0), 0, 4));
+    CHECK(checkSegment(helper, area, Point(0, 4), Point(4, 0), 0, 4));
+    CHECK(checkSegment(helper, area, Point(-1, -1), Point(3, 3), 0, 2));
+    Point above1(-1, 4 + 2 * prec), above2(5, 4 + 2 * prec);
+    Segment above(above1, above2);
+    CHECK(helper.getIntersectionIntervals(area, &above) == NULL);
+
+    // Cropped at t = 2, downwards and upwards. The cut is part of both.
+    ClipperLib::Polygons lower(area), upper(area), uncropped(area);
+    helper.cropArea(lower, 2, DOWN);
+    CHECK(helper.isAreaContainPt(lower, Point(1, 1.5)));
+    CHECK(helper.isAreaContainPt(lower, Point(1, 2)));
+    CHECK(!helper.isAreaContainPt(lower, Point(1, 2.5)));
+    CHECK(checkSegment(helper, lower, Point(-1, 1), Point(5, 1), 0, 3));
+    CHECK(checkSegment(helper, lower, Point(-1, 2), Point(5, 2), 0, 2));
+    helper.cropArea(upper, 2, UP);
+    CHECK(!helper.isAreaContainPt(upper, Point(1, 1.5)));
+    CHECK(helper.isAreaContainPt(upper, Point(1, 2)));
+    CHECK(helper.isAreaContainPt(upper, Point(1, 2.5)));
+    CHECK(checkSegment(helper, upper, Point(-1, 3), Point(5, 3), 0, 1));
+
+    // Above the area or below it, cropping leaves it as it is.
+    helper.cropArea(uncropped, 5, DOWN);
+    helper.cropArea(uncropped, -1, UP);
+    CHECK(uncropped.size() == 1 && ClipperLib::Area(uncropped[0]) == ClipperLib::Area(area[0]));
+
+    // The areas of the two parts meet at the cut only, which is no s-interval, but both meet the whole area in theirs.
+    IntervalSet *iSet = helper.getIntersectionIntervals(lower, area);
+    CHECK(isInterval(iSet, 0, 4));
+    delete iSet;
+    iSet = helper.getIntersectionIntervals(upper, area);
+    CHECK(isInterval(iSet, 0, 2));
+    delete iSet;
+
+    // A region without area, the segment from (1, 1) to (3, 2), is widened to a sliver of width AREA_PREC around it.
+    TestRegion segmentRegion(Point(1, 1), Point(3, 2));
+    region = segmentRegion.create();
+    helper.createArea(area, region, &notTT);
+    CHECK(area.empty());
+    helper.createArea(area, region, &tt);
+    if (!CHECK(area.size() == 1))
+        return;
+    // The unit normal of the segment
+    const double nx = -1 / sqrt(5.0), ny = 2 / sqrt(5.0);
+    CHECK(helper.isAreaContainPt(area, Point(2, 1.5)));
+    CHECK(helper.isAreaContainPt(area, Point(1, 1)));
+    CHECK(helper.isAreaContainPt(area, Point(2 + prec * nx, 1.5 + prec * ny)));
+    CHECK(!helper.isAreaContainPt(area, Point(2 + 3 * prec * nx, 1.5 + 3 * prec * ny)));
+    CHECK(!helper.isAreaContainPt(area, Point(2 - 3 * prec * nx, 1.5 - 3 * prec * ny)));
+    CHECK(!helper.isAreaContainPt(area, Point(0.5, 0.75)));
+    CHECK(checkSegment(helper, area, Point(0, 0.5), Point(4, 2.5), 1, 3));
+
+    // Two slivers of the same line overlap where their segments do.
+    TestRegion nextRegion(Point(2, 1.5), Point(4, 2.5));
+    ClipperLib::Polygons next;
+    helper.createArea(next, nextRegion.create(), &tt);
+    iSet = helper.getIntersectionIntervals(area, next);
+    CHECK(isInterval(iSet, 2, 3));
+    delete iSet;
+}
+
+}
@@ -0,0 +1,52 @@
+/**
+ * @file PumpModel.cpp
+ * @brief The closed form of the probability curves of the pump models, and their STD.
+ */
+
+#include "PumpModel.h"
+
+using namespace model;
+
+namespace tests {
+
+double pumpProb(const GeneralDistribution *distribution, double c, double t) {
+    if (c < 5) {
+        if (t <= c)
+            return 1;
+        return distribution->cdf(t < 5 ? (t + c) / 2 : (5 + c) / 2);
+    }
+    return t <= (5 + c) / 2 ? 1 : distribution->cdf((5 + c) / 2);
+}
+
+PumpDiagram::PumpDiagram(const char *name, double maxTime) :
+    facade(QString(modelPath(name).c_str()), "reservoir", &logger), initialMarking(NULL), modelChecker(NULL), pIndex(-1)
+{
+    Model *pumpModel = facade.model;
+    if (pumpModel == NULL)
+        return;
+
+    InitializeModel(pumpModel);
+    pumpModel->MaxTime = maxTime;
+    initialMarking = createInitialMarking(pumpModel);
+    TimedDiagram::getInstance()->setModel(pumpModel);
+    TimedDiagram::getInstance()->generateDiagram(initialMarking);
+
+    for (int i = 0; i < pumpModel->N_places; i++) {
+        if (pumpModel->places[i].type == PT_FLUID)
+            pIndex = i;
+    }
+
+    modelChecker = new ModelChecker(pumpModel, TimedDiagram::getInstance(), &logger);
+    if (!modelChecker->setVariables()) {
+        delete modelChecker;
+        modelChecker = NULL;
+    }
+}
+
+PumpDiagram::~PumpDiagram() {
+    delete modelChecker;
+    if (initialMarking != NULL)
+        freeMarking(initialMarking);
+}
+
+}
@@ -0,0 +1,56 @@
+/**
+ * @file PumpModel.h
+ * @brief The pump models of the tests, whose probability curves have a closed form.
+ *
+ * In the pump models a pump fills the reservoir (bound 10) at rate 2 and a demand drains it at rate 1. The pump
+ * breaks at the general time s, the demand stops at time 5. For a constant c < 5 this gives
+ * P(x <= c) = 1 for t <= c, F((t + c)/2) for c < t < 5 and F((5 + c)/2) for t > 5; for 5 < c < 10 it gives
+ * 1 for t <= (5 + c)/2 and F((5 + c)/2) after it, with F the cdf of s.
+ */
+
+#ifndef PUMPMODEL_H
+#define PUMPMODEL_H
+
+#include "TestSuite.h"
+#include "Facade.h"
+
+namespace tests {
+
+/**
+ * @brief pumpProb The closed form of P(x <= c) at time t of a pump model.
+ * @param distribution The distribution of the time at which the pump breaks.
+ */
+double pumpProb(const model::GeneralDistribution *distribution, double c, double t);
+
+/**
+ * @brief The PumpDiagram class loads a pump model and builds its STD and a model checker on it, as the facade does.
+ */
+class PumpDiagram
+{
+public:
+    PumpDiagram(const char *name, double maxTime);
+    ~PumpDiagram();
+
+    /**
+     * @brief isValid Whether the model could be loaded and its distribution created.
+     */
+    bool isValid() const { return modelChecker != NULL; }
+
+    model::ModelChecker *getModelChecker() { return modelChecker; }
+    const model::GeneralDistribution *getDistribution() { return modelChecker->getDistribution(); }
+    int getPlaceIndex() const { return pIndex; }
+
+private:
+    TestLogger logger;
+    model::Facade facade;
+    model::Marking *initialMarking;
+    model::ModelChecker *modelChecker;
+    int pIndex; // the reservoir
+
+    PumpDiagram(const PumpDiagram &);
+    PumpDiagram &operator=(const PumpDiagram &);
+};
+
+}
+
+#endif // PUMPMODEL_H
@@ -0,0 +1,156 @@
+/**
+ * @file RandomTests.cpp
+ * @brief The random numbers of the simulation: the Philox4x32-10 generator against the known-answer vectors of
+ * Random123, the layout of the streams of RandomStream, the reproducibility of a simulation from its seed, and the
+ * Sobol sequence against scipy.stats.qmc.Sobol.
+ */
+
+#include "TestSuite.h"
+#include "RandomStream.h"
+#include "SobolSequence.h"
+#include "Facade.h"
+
+#include <fstream>
+#include <sstream>
+#include <vector>
+
+using namespace model;
+
+namespace tests {
+
+namespace {
+
+bool sameWords(const uint32_t *actual, const uint32_t *expected) {
+    for (int i = 0; i < 4; i++) {
+        if (actual[i] != expected[i])
+            return false;
+    }
+    return true;
+}
+
+/*
+ * The uniform of RandomStream::nextUniform made of two words.
+ */
+double uniform(uint32_t hi, uint32_t lo) {
+    uint64_t x = ((uint64_t)hi << 21) ^ (lo >> 11);
+    return (x + 0.5) * (1.0 / 9007199254740992.0);
+}
+
+std::string readFile(const char *fileName) {
+    std::ifstream file(fileName);
+    std::ostringstream contents;
+    contents << file.rdbuf();
+    return contents.str();
+}
+
+/*
+ * The interval file of a simulation of the exp{0.1} pump model with the given seed and number of threads.
+ */
+std::string simulate(uint64_t seed, int threads) {
+    TestLogger logger;
+    Facade facade(QString(modelPath("pump_exp.hpng").c_str()), "reservoir", &logger);
+    SimulationOptions options;
+    options.randomSeed = false;
+    options.seed = seed;
+    options.threads = threads;
+    facade.setSimulationOptions(options);
+    if (!facade.showDESProbFunc(4, 6, 1, 5000, 1, 10))
+        return "";
+    return readFile("./output/reservoir_des_3d_ci.dat");
+}
+
+}
+
+void testRandomStreams() {
+    // Known-answer vectors of Philox4x32-10 (Random123, kat_vectors)
+    uint32_t out[4];
+    {
+        uint32_t counter[4] = {0, 0, 0, 0}, key[2] = {0, 0};
+        const uint32_t expected[4] = {0x6627e8d5, 0xe169c58d, 0xbc57ac4c, 0x9b00dbd8};
+        Philox4x32::generate(counter, key, out);
+        CHECK(sameWords(out, expected));
+    }
+    {
+        uint32_t counter[4] = {0xffffffff, 0xffffffff, 0xffffffff, 0xffffffff}, key[2] = {0xffffffff, 0xffffffff};
+        const uint32_t expected[4] = {0x408f276d, 0x41c83b0e, 0xa20bc7c6, 0x6d5451fd};
+        Philox4x32::generate(counter, key, out);
+        CHECK(sameWords(out, expected));
+    }
+    {
+        uint32_t counter[4] = {0x243f6a88, 0x85a308d3, 0x13198a2e, 0x03707344}, key[2] = {0xa4093822, 0x299f31d0};
+        const uint32_t expected[4] = {0xd16cfe09, 0x94fdcceb, 0x5001e420, 0x24126ea1};
+        Philox4x32::generate(counter, key, out);
+        CHECK(sameWords(out, expected));
+    }
+
+    // The first block of seed 0, stream 0 is the first vector above.
+    RandomStream first(0, 0);
+    CHECK_CLOSE(first.nextUniform(), 0.39904647084896455, 0);
+    CHECK_CLOSE(first.nextUniform(), 0.7357127844834426, 0);
+
+    // The seed is the key, the stream the upper half of the counter and the position its lower half.
+    const uint64_t seed = 0x123456789abcdefULL, stream = 0xfedcba987ULL;
+    RandomStream random(seed, stream);
+    uint32_t key[2] = {(uint32_t)seed, (uint32_t)(seed >> 32)};
+    for (uint32_t position = 0; position < 3; position++) {
+        uint32_t counter[4] = {position, 0, (uint32_t)stream, (uint32_t)(stream >> 32)};
+        Philox4x32::generate(counter, key, out);
+        CHECK_CLOSE(random.nextUniform(), uniform(out[0], out[1]), 0);
+        CHECK_CLOSE(random.nextUniform(), uniform(out[2], out[3]), 0);
+    }
+
+    // A simulation only depends on its seed, not on the number of threads.
+    std::string single = simulate(33, 1);
+    CHECK(!single.empty());
+    CHECK(simulate(33, 3) == single);
+    CHECK(simulate(34, 1) != single);
+}
+
+void testSobolSequence() {
+    SobolSequence sobol;
+    CHECK(!sobol.setDimension(0));
+    CHECK(!sobol.setDimension(SobolSequence::MAX_DIMENSION + 1));
+    if (!CHECK(sobol.setDimension(SobolSequence::MAX_DIMENSION)))
+        return;
+
+    // The points k of scipy.stats.qmc.Sobol(21, scramble=False, bits=32), which are in Gray code order, i.e. the points
+    // k ^ (k >> 1) of the natural order. The high indices depend on all 32 direction numbers of every coordinate.
+    const uint32_t indices[] = {1, 2, 1000, 65535, 3000000001u};
+    const uint32_t expected[][SobolSequence::MAX_DIMENSION] = {
+        {2147483648u, 2147483648u, 2147483648u, 2147483648u, 2147483648u, 2147483648u, 2147483648u, 2147483648u, 2147483648u, 2147483648u, 2147483648u,
+         2147483648u, 2147483648u, 2147483648u, 2147483648u, 2147483648u, 2147483648u, 2147483648u, 2147483648u, 2147483648u, 2147483648u},
+        {3221225472u, 1073741824u, 1073741824u, 1073741824u, 3221225472u, 3221225472u, 1073741824u, 3221225472u, 3221225472u, 3221225472u, 3221225472u,
+         3221225472u, 1073741824u, 1073741824u, 3221225472u, 1073741824u, 3221225472u, 1073741824u, 3221225472u, 1073741824u, 1073741824u},
+        {943718400u, 415236096u, 2227175424u, 2906652672u, 1203765248u, 3896508416u, 197132288u, 3862953984u, 2151677952u, 297795584u, 364904448u,
+         1094713344u, 692060160u, 1648361472u, 616562688u, 1589641216u, 3091202048u, 1480589312u, 4257218560u, 3116367872u, 2243952640u},
+        {65536u, 4294901760u, 2421489664u, 3271884800u, 1085997056u, 2344288256u, 2221342720u, 3125346304u, 3844407296u, 703922176u, 739180544u,
+         308740096u, 4013359104u, 1409875968u, 1977548800u, 2058420224u, 687538176u, 800260096u, 566296576u, 1879244800u, 2432892928u},
+        {2156797399u, 2353488425u, 1806415863u, 3428090197u, 384687691u, 4205072825u, 1794970117u, 1348857399u, 358531815u, 302324287u, 761115227u,
+         2744170363u, 3906817801u, 509206005u, 3520162403u, 3267287463u, 2352774437u, 855509407u, 985010369u, 3338567993u, 4184869279u},
+    };
+    uint32_t x[SobolSequence::MAX_DIMENSION];
+    for (unsigned int i = 0; i < sizeof(indices) / sizeof(indices[0]); i++) {
+        sobol.point(indices[i] ^ (indices[i] >> 1), x);
+        bool same = true;
+        for (int j = 0; j < SobolSequence::MAX_DIMENSION; j++)
+            same = same && x[j] == expected[i][j];
+        CHECK(same);
+    }
+
+    // The first 2^10 points are a net: every coordinate has one point in each of the 2^10 cells of [0, 1).
+    const int cells = 1024;
+    std::vector<std::vector<int> > counts(SobolSequence::MAX_DIMENSION, std::vector<int>(cells, 0));
+    for (uint32_t index = 0; index < (uint32_t)cells; index++) {
+        sobol.point(index, x);
+        for (int j = 0; j < SobolSequence::MAX_DIMENSION; j++)
+            counts[j][x[j] >> 22]++;
+    }
+    bool stratified = true;
+    for (int j = 0; j < SobolSequence::MAX_DIMENSION; j++) {
+        for (int cell = 0; cell < cells; cell++)
+            stratified = stratified && counts[j][cell] == 1;
+    }
+    CHECK(stratified);
+}
+
+}
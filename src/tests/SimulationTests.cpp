@@ -0,0 +1,89 @@
+/**
+ * @file SimulationTests.cpp
+ * @brief The estimators of the simulation (Facade::showDESProbFunc) against the closed form of the pump models, see
+ * PumpModel.h.
+ */
+
+#include "PumpModel.h"
+
+#include <cmath>
+
+using namespace model;
+
+namespace tests {
+
+namespace {
+
+const double MAX_TIME = 10;
+
+/*
+ * Simulates P(x <= c) of a pump model at the times 0, 1, ..., MAX_TIME and reads the estimates.
+ */
+bool simulatePump(const char *name, const SimulationOptions &options, double c, int runs, std::vector<DESPoint> &points) {
+    TestLogger logger;
+    Facade facade(QString(modelPath(name).c_str()), "reservoir", &logger);
+    facade.setSimulationOptions(options);
+    if (!facade.showDESProbFunc(c, runs, 1, MAX_TIME))
+        return false;
+    return readDESIntervals("./output/reservoir_des_2d_ci.dat", points) && points.size() == MAX_TIME + 1;
+}
+
+}
+
+void testQuasiMonteCarlo() {
+    // 16 replicates of 2^10 points. In one dimension the points of a replicate are a net with one point in each of
+    // 2^10 cells of [0, 1), so the estimate of a probability F(x) of a replicate is within 2^-10 of it, and so is
+    // their mean.
+    SimulationOptions options;
+    options.randomSeed = false;
+    options.seed = 36;
+    options.quasiMonteCarlo = true;
+    options.replicates = 16;
+    const int runs = 16 * 1024;
+    const double c = 4;
+
+    std::vector<DESPoint> points;
+    if (!CHECK(simulatePump("pump_exp.hpng", options, c, runs, points)))
+        return;
+
+    TypedDistribution<ExpPolicy> distribution;
+    distribution.getPolicy().lambda = 0.1;
+    for (unsigned int i = 0; i < points.size(); i++) {
+        if (points[i].time == c)
+            continue;
+        CHECK(points[i].runs == runs);
+        CHECK_CLOSE(points[i].probability, pumpProb(&distribution, c, points[i].time), 1.0 / 1024);
+        CHECK(points[i].lower <= points[i].probability && points[i].probability <= points[i].upper);
+    }
+}
+
+void testSplitting() {
+    // The pump rarely breaks before 4.5: P(x <= 4) = 1 - exp(-0.002 * 4.5) after t = 5. Splitting estimates it from the
+    // runs that pass each of 4 levels; the estimate has to be within twice the half-width of its interval of it.
+    SimulationOptions options;
+    options.randomSeed = false;
+    options.seed = 37;
+    options.splittingLevels = 4;
+    options.splittingEffort = 2000;
+    const double c = 4;
+
+    std::vector<DESPoint> points;
+    if (!CHECK(simulatePump("pump_rare.hpng", options, c, 40000, points)))
+        return;
+
+    TypedDistribution<ExpPolicy> distribution;
+    distribution.getPolicy().lambda = 0.002;
+    for (unsigned int i = 0; i < points.size(); i++) {
+        if (points[i].time == c)
+            continue;
+        double exact = pumpProb(&distribution, c, points[i].time);
+        double halfWidth = (points[i].upper - points[i].lower) / 2;
+        CHECK(points[i].lower <= points[i].probability && points[i].probability <= points[i].upper);
+        CHECK_CLOSE(points[i].probability, exact, 2 * halfWidth + 1e-12);
+        // The rare points have a relative error of at most 20%.
+        if (points[i].time > 5)
+            CHECK(halfWidth < 0.2 * exact);
+    }
+}
+
+}
@@ -0,0 +1,68 @@
+/**
+ * @file TestSuite.cpp
+ * @brief The checks and the counters of the test runner.
+ */
+
+#include "TestSuite.h"
+
+#include <cmath>
+#include <cstdio>
+#include <fstream>
+#include <sstream>
+
+namespace tests {
+
+static int checks = 0;
+static int failures = 0;
+
+bool check(bool condition, const char *expression, const char *file, int line) {
+    checks++;
+    if (!condition) {
+        failures++;
+        fprintf(stderr, "%s:%d: check failed: %s\n", file, line, expression);
+    }
+    return condition;
+}
+
+bool checkClose(double actual, double expected, double tolerance, const char *expression, const char *file, int line) {
+    checks++;
+    // Written so that a NaN fails.
+    if (fabs(actual - expected) <= tolerance || actual == expected)
+        return true;
+    failures++;
+    fprintf(stderr, "%s:%d: check failed: %s is %.17g, expected %.17g within %g\n", file, line, expression, actual, expected, tolerance);
+    return false;
+}
+
+int getChecks() {
+    return checks;
+}
+
+int getFailures() {
+    return failures;
+}
+
+std::string modelPath(const char *name) {
+    return std::string(TEST_MODEL_DIR) + "/" + name;
+}
+
+bool readDESIntervals(const std::string &fileName, std::vector<DESPoint> &points) {
+    std::ifstream file(fileName.c_str());
+    if (!file.is_open())
+        return false;
+
+    points.clear();
+    std::string line;
+    while (std::getline(file, line)) {
+        if (line.empty() || line[0] == '#')
+            continue;
+        std::istringstream fields(line);
+        DESPoint point;
+        if (!(fields >> point.time >> point.constant >> point.probability >> point.lower >> point.upper >> point.runs))
+            return false;
+        points.push_back(point);
+    }
+    return true;
+}
+
+}
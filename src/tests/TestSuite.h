@@ -0,0 +1,89 @@
+/**
+ * @file TestSuite.h
+ * @brief A minimal test runner for the numerics of the model library. Every test function checks the behaviour of one
+ * part of the library against reference values and counts its failed checks; main runs them all.
+ */
+
+#ifndef TESTSUITE_H
+#define TESTSUITE_H
+
+#include "Logger.h"
+
+#include <string>
+#include <vector>
+
+namespace tests {
+
+/**
+ * @brief check Counts a check and reports it if it failed.
+ * @return The condition.
+ */
+bool check(bool condition, const char *expression, const char *file, int line);
+
+/**
+ * @brief checkClose Checks that |actual - expected| <= tolerance. NaN is never close.
+ * @return true if the check passed.
+ */
+bool checkClose(double actual, double expected, double tolerance, const char *expression, const char *file, int line);
+
+int getChecks();
+int getFailures();
+
+/**
+ * @brief modelPath The path of a model in the models directory of the tests.
+ */
+std::string modelPath(const char *name);
+
+/**
+ * @brief The DESPoint struct is a line of the confidence interval file of a simulation, see Facade::showDESProbFunc.
+ */
+struct DESPoint {
+    double time, constant;
+    double probability, lower, upper;
+    long long runs;
+};
+
+/**
+ * @brief readDESIntervals Reads the confidence interval file of a simulation.
+ * @return false if the file could not be read.
+ */
+bool readDESIntervals(const std::string &fileName, std::vector<DESPoint> &points);
+
+/**
+ * @brief The TestLogger class keeps the messages of the model library, so a test can check that an error was reported.
+ */
+class TestLogger : public model::Logger
+{
+public:
+    void addText(std::string) {}
+    void addSuccess(std::string) {}
+    void addWarning(std::string) {}
+    void addError(std::string str) { errors.push_back(str); }
+    void setText(std::string) {}
+    std::string getText() { return ""; }
+
+    std::vector<std::string> errors;
+};
+
+/*
+ * The tests, one function per part of the library.
+ */
+void testExactCurve();
+void testAdaptiveCurve();
+void testGammaCdf();
+void testQuantiles();
+void testCompiledExpression();
+void testDistributionKernels();
+void testDistributionQuantiles();
+void testRandomStreams();
+void testSobolSequence();
+void testQuasiMonteCarlo();
+void testSplitting();
+void testGeometry();
+
+}
+
+#define CHECK(condition) tests::check((condition), #condition, __FILE__, __LINE__)
+#define CHECK_CLOSE(actual, expected, tolerance) tests::checkClose((actual), (expected), (tolerance), #actual, __FILE__, __LINE__)
+
+#endif // TESTSUITE_H
@@ -0,0 +1,62 @@
+/**
+ * @file main.cpp
+ * @brief Runs the tests of the model library. The exit code is 0 if every check passed.
+ */
+
+#include "TestSuite.h"
+
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+#include <dirent.h>
+#include <unistd.h>
+#include <sys/stat.h>
+
+/*
+ * Removes the plots of the facade and the scratch directory.
+ */
+static void removeScratchDirectory(const char *directory)
+{
+    std::string output = std::string(directory) + "/output";
+    DIR *outputDirectory = opendir(output.c_str());
+    if (outputDirectory != NULL) {
+        struct dirent *entry;
+        while ((entry = readdir(outputDirectory)) != NULL) {
+            if (entry->d_name[0] != '.')
+                unlink((output + "/" + entry->d_name).c_str());
+        }
+        closedir(outputDirectory);
+    }
+    rmdir(output.c_str());
+    rmdir(directory);
+}
+
+int main(int, char **)
+{
+    // The facade writes its plots to ./output and shows them with gnuplot, so run in a scratch directory without a
+    // terminal for gnuplot.
+    char directory[] = "/tmp/fst_tests_XXXXXX";
+    if (mkdtemp(directory) == NULL || chdir(directory) != 0 || mkdir("output", 0755) != 0) {
+        fprintf(stderr, "Could not create a scratch directory for the tests.\n");
+        return 2;
+    }
+    setenv("GNUTERM", "dumb", 1);
+
+    tests::testExactCurve();
+    tests::testAdaptiveCurve();
+    tests::testGammaCdf();
+    tests::testQuantiles();
+    tests::testCompiledExpression();
+    tests::testDistributionKernels();
+    tests::testDistributionQuantiles();
+    tests::testRandomStreams();
+    tests::testSobolSequence();
+    tests::testQuasiMonteCarlo();
+    tests::testSplitting();
+    tests::testGeometry();
+
+    removeScratchDirectory(directory);
+
+    printf("%d checks, %d failed\n", tests::getChecks(), tests::getFailures());
+    return tests::getFailures() == 0 ? 0 : 1;
+}
@@ -0,0 +1,58 @@
+#-------------------------------------------------
+#
+# Tests of the numerics of the model against reference values.
+# Run them with "make check" after building the project.
+#
+#-------------------------------------------------
+
+! include( ../common.pri ) {
+    error( "Couldn't find the common.pri file!" )
+}
+
+QT       += core
+QT       -= gui
+
+CONFIG   += console
+CONFIG   -= app_bundle
+
+TEMPLATE = app
+
+INCLUDEPATH += ../model \
+               ../includes_64/opencv \
+               ../includes_64/opencv2 \
+               ../includes_64 \
+
+LIBS += -L../model -L../libs -lmodel -lmatheval -lopencv_core -lopencv_imgproc -lopencv_highgui
+
+#Make the tests run with the shared libraries of the model and some external packages.
+QMAKE_LFLAGS += -Wl,--rpath=\\\$\$ORIGIN/../model
+QMAKE_LFLAGS += -Wl,--rpath=\\\$\$ORIGIN/../libs_64
+QMAKE_LFLAGS_RPATH=
+
+DEFINES += TEST_MODEL_DIR=\\\"$$PWD/models\\\"
+
+TARGET = tests
+
+check.commands = ./$$TARGET
+check.depends = $$TARGET
+QMAKE_EXTRA_TARGETS += check
+
+SOURCES +=  main.cpp\
+            TestSuite.cpp\
+            PumpModel.cpp\
+            ExactCurveTests.cpp\
+            AdaptiveCurveTests.cpp\
+            CdfKernelsTests.cpp\
+            CompiledExpressionTests.cpp\
+            DistributionTests.cpp\
+            RandomTests.cpp\
+            SimulationTests.cpp\
+            GeometryTests.cpp\
+
+HEADERS +=  TestSuite.h\
+            PumpModel.h\
+
+OTHER_FILES +=  models/pump_exp.hpng\
+                models/pump_uni.hpng\
+                models/pump_dtrm.hpng\
+                models/pump_rare.hpng\